@@ -0,0 +1,102 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration and implementation of the Arena class
+*/
+
+
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+
+#include <cstddef> //for std::size_t
+#include <memory> //for std::unique_ptr
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents a growing array of many small records (e.g. the nodes
+and edges of a graph), addressed by their index.
+
+The records are allocated in blocks of BLOCK_SIZE, so appending a record
+is a store (and an allocation once per block), rather than an allocation per
+record as with a node-based container. Unlike std::vector, the blocks are
+never moved, so a reference to a record stays valid as records are added.
+
+Records are only appended; they're freed all at once when the arena is
+cleared or destroyed.
+*/
+template <typename T>
+class Arena
+{
+public:
+	//-- constructors/destructor --//
+
+	//Creates an empty arena.
+	Arena() :
+		m_size(0)
+	{
+	}
+
+	Arena(const Arena&) = delete;
+	Arena& operator= (const Arena&) = delete;
+
+
+	//-- operators --//
+
+	//Returns the record at 'index' (which must be less than size()).
+	T& operator[] (std::size_t index) {
+		return this->m_blocks[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)];
+	}
+
+	const T& operator[] (std::size_t index) const {
+		return this->m_blocks[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)];
+	}
+
+
+	//-- public methods --//
+
+	//Appends 'value', and returns its index.
+	std::size_t push(const T& value) {
+		if (this->m_size == this->m_blocks.size() * BLOCK_SIZE)
+			this->m_blocks.push_back(std::unique_ptr<T[]>(new T[BLOCK_SIZE]));
+
+		std::size_t index = this->m_size++;
+		(*this)[index] = value;
+		return index;
+	}
+
+	//Returns the number of records.
+	std::size_t size() const {
+		return this->m_size;
+	}
+
+	//Frees all the records.
+	void clear() {
+		this->m_blocks.clear();
+		this->m_size = 0;
+	}
+
+private:
+	//-- private data members --//
+
+	//The number of records in a block (a power of 2, so an index is split into
+	//a block and an offset with a shift and a mask)
+	static const std::size_t BLOCK_BITS = 12;
+	static const std::size_t BLOCK_SIZE = std::size_t(1) << BLOCK_BITS;
+
+	//The blocks
+	std::vector<std::unique_ptr<T[]>> m_blocks;
+
+	//The number of records
+	std::size_t m_size;
+
+}; //class Arena {
+
+} //namespace fraction {
+
+#endif
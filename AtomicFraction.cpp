@@ -0,0 +1,346 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the AtomicFraction and
+* AtomicWideFraction classes
+*/
+
+#include "AtomicFraction.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include "WideArithmetics.hpp"
+#include <climits> //for LLONG_MIN, LLONG_MAX
+#include <cstdint> //for std::uint64_t
+#include <thread> //for std::this_thread::yield
+
+
+namespace fraction {
+
+
+/***
+*Fraction AtomicFraction::fetchUpdate() - The CAS loop
+*
+*Purpose:
+*       Reads the current word, unpacks it, applies 'operation' on a copy of
+*       it, and tries to replace the current word with the packed result.
+*       If another thread changed the word in between, compare_exchange_weak()
+*       fails and stores the new word in 'expected', so we simply try again
+*       with it.
+*
+*       If 'operation' throws (e.g. NumericOverflowException()), the word was
+*       not changed, and the exception propagates.
+*
+*Entry:
+*       Operation operation - A function that accepts a Fraction& and updates it.
+*
+*Exit:
+*       Fraction - The value before the operation.
+*
+*Exceptions:
+*       Whatever 'operation' throws.
+*
+*******************************************************************************/
+template <typename Operation>
+Fraction AtomicFraction::fetchUpdate(Operation operation) {
+	std::uint64_t expected = this->m_value.load(std::memory_order_relaxed);
+
+	while (true) {
+		Fraction previous = this->unpack(expected);
+
+		Fraction updated = previous;
+		operation(updated);
+
+		if (this->m_value.compare_exchange_weak(expected, pack(updated),
+			std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+			return previous;
+		}
+	}
+}
+
+
+//A single strong CAS on the packed words.
+//Fractions are always reduced with a positive denominator, so equal values
+//have equal words.
+bool AtomicFraction::compareExchange(Fraction& expected, const Fraction& desired) {
+	std::uint64_t expected_word = pack(expected);
+
+	if (this->m_value.compare_exchange_strong(expected_word, pack(desired)))
+		return true;
+
+	expected = this->unpack(expected_word);
+	return false;
+}
+
+
+//value+=frac
+Fraction AtomicFraction::fetchAdd(const Fraction& frac) {
+	return this->fetchUpdate([&frac](Fraction& value) { value += frac; });
+}
+
+
+//value-=frac
+Fraction AtomicFraction::fetchSubtract(const Fraction& frac) {
+	return this->fetchUpdate([&frac](Fraction& value) { value -= frac; });
+}
+
+
+//value*=frac
+Fraction AtomicFraction::fetchMultiply(const Fraction& frac) {
+	return this->fetchUpdate([&frac](Fraction& value) { value *= frac; });
+}
+
+
+//value/=frac
+Fraction AtomicFraction::fetchDivide(const Fraction& frac) {
+	return this->fetchUpdate([&frac](Fraction& value) { value /= frac; });
+}
+
+
+//AtomicWideFraction
+
+
+//The number of times a thread waiting for the lock of an AtomicWideFraction
+//(without a 16 bytes CAS) spins before it starts yielding (the holder may have
+//been preempted).
+#ifndef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+static const unsigned SPIN_LIMIT = 256;
+#endif
+
+
+//Splits a word into a Value.
+static AtomicWideFraction::Value unpackWide(unsigned __int128 word) {
+	AtomicWideFraction::Value value;
+	value.numerator = (long long)(std::uint64_t)(word >> 64);
+	value.denominator = (long long)(std::uint64_t)word;
+	return value;
+}
+
+
+//Joins a Value into a word.
+static unsigned __int128 packWide(const AtomicWideFraction::Value& value) {
+	return ((unsigned __int128)(std::uint64_t)value.numerator << 64) |
+		(std::uint64_t)value.denominator;
+}
+
+
+AtomicWideFraction::AtomicWideFraction(long long numerator, long long denominator,
+	bool overflowProtection) :
+	m_value(0),
+	m_overflow_protection(overflowProtection),
+	m_locked(false)
+{
+	if (0 == denominator)
+		throw DivisionByZeroException();
+	this->m_value = this->normalize(numerator, denominator);
+}
+
+
+/***
+*unsigned __int128 AtomicWideFraction::compareAndSwap() - 16 bytes CAS
+*
+*Purpose:
+*       Atomically compares the word with 'expected', and if they are equal,
+*       replaces it with 'desired'.
+*
+*       With -mcx16 this is a single 'lock cmpxchg16b'.
+*       Else, it's done under the spin lock of the object, which a waiting
+*       thread spins on for SPIN_LIMIT attempts, and then yields the CPU
+*       between the attempts.
+*
+*       Note that an atomic load is a CAS of 0 with 0 - it returns the current
+*       word, and only "changes" it if it's 0 (which is never a valid value,
+*       since the denominator is never 0).
+*
+*Entry:
+*       unsigned __int128 expected - The expected word.
+*       unsigned __int128  desired - The new word.
+*
+*Exit:
+*       unsigned __int128 - The word before the operation (which is 'expected'
+*                           iff the swap succeeded).
+*
+*Exceptions:
+*
+*******************************************************************************/
+unsigned __int128 AtomicWideFraction::compareAndSwap(unsigned __int128 expected,
+	unsigned __int128 desired) const
+{
+	unsigned __int128* word = const_cast<unsigned __int128*>(&this->m_value);
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+	return __sync_val_compare_and_swap(word, expected, desired);
+#else
+	for (unsigned attempts = 0; this->m_locked.exchange(true, std::memory_order_acquire);) {
+		if (attempts < SPIN_LIMIT) {
+			++attempts;
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#endif
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	unsigned __int128 previous = *word;
+	if (previous == expected)
+		*word = desired;
+
+	this->m_locked.store(false, std::memory_order_release);
+	return previous;
+#endif
+}
+
+
+/***
+*unsigned __int128 AtomicWideFraction::normalize() - Normalizes a result
+*
+*Purpose:
+*       Reduces numerator/denominator, makes the denominator positive, and
+*       checks that both fit in 64 bits.
+*       If they don't and the overflow protection is on - throws
+*       NumericOverflowException(). Else, they are truncated to 64 bits, and
+*       only then the truncated parts are reduced and get their sign fixed
+*       (truncating can leave them with a common factor and a negative
+*       denominator).
+*
+*Entry:
+*       __int128   numerator - The (unreduced) numerator
+*       __int128 denominator - The (unreduced, non zero) denominator
+*
+*Exit:
+*       unsigned __int128 - The packed word.
+*
+*Exceptions:
+*       NumericOverflowException() - If the result doesn't fit in 64 bits, and
+*                                    the overflow protection is on.
+*
+*******************************************************************************/
+unsigned __int128 AtomicWideFraction::normalize(__int128 numerator, __int128 denominator) const {
+	__int128 gcd = WideArithmetics::gcd(numerator, denominator);
+	numerator /= gcd;
+	denominator /= gcd;
+
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	if (numerator < LLONG_MIN || numerator > LLONG_MAX || denominator > LLONG_MAX) {
+		if (this->m_overflow_protection)
+			throw NumericOverflowException();
+
+		numerator = (long long)numerator;
+		denominator = (long long)denominator;
+
+		gcd = WideArithmetics::gcd(numerator, denominator);
+		if (0 != gcd) {
+			numerator /= gcd;
+			denominator /= gcd;
+		}
+		if (denominator < 0) {
+			numerator = -numerator;
+			denominator = -denominator;
+		}
+	}
+
+	Value value;
+	value.numerator = (long long)numerator;
+	value.denominator = (long long)denominator;
+	return packWide(value);
+}
+
+
+//A CAS of 0 with 0 (see compareAndSwap()).
+AtomicWideFraction::Value AtomicWideFraction::load() const {
+	return unpackWide(this->compareAndSwap(0, 0));
+}
+
+
+//A CAS loop until the word we expected is the one we replaced.
+void AtomicWideFraction::store(long long numerator, long long denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	unsigned __int128 desired = this->normalize(numerator, denominator);
+	unsigned __int128 expected = this->compareAndSwap(0, 0);
+
+	while (true) {
+		unsigned __int128 previous = this->compareAndSwap(expected, desired);
+		if (previous == expected)
+			return;
+		expected = previous;
+	}
+}
+
+
+//A single CAS on the packed words.
+bool AtomicWideFraction::compareExchange(Value& expected, const Value& desired) {
+	unsigned __int128 expected_word = packWide(expected);
+	unsigned __int128 previous = this->compareAndSwap(expected_word, packWide(desired));
+
+	if (previous == expected_word)
+		return true;
+
+	expected = unpackWide(previous);
+	return false;
+}
+
+
+//The same CAS loop as AtomicFraction::fetchUpdate(), where 'operation' returns
+//the new packed word from the current value.
+template <typename Operation>
+AtomicWideFraction::Value AtomicWideFraction::fetchUpdate(Operation operation) {
+	unsigned __int128 expected = this->compareAndSwap(0, 0);
+
+	while (true) {
+		Value previous = unpackWide(expected);
+		unsigned __int128 previous_word = this->compareAndSwap(expected, operation(previous));
+
+		if (previous_word == expected)
+			return previous;
+		expected = previous_word;
+	}
+}
+
+
+//a/b + c/d = (ad + bc)/bd.
+//The operands are at most 64 bits, so 'ad + bc' and 'bd' fit in 128 bits.
+AtomicWideFraction::Value AtomicWideFraction::fetchAdd(long long numerator, long long denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	return this->fetchUpdate([this, numerator, denominator](const Value& value) {
+		return this->normalize((__int128)value.numerator * denominator + (__int128)numerator * value.denominator,
+			(__int128)value.denominator * denominator);
+	});
+}
+
+
+//a/b * c/d = ac/bd.
+AtomicWideFraction::Value AtomicWideFraction::fetchMultiply(long long numerator, long long denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	return this->fetchUpdate([this, numerator, denominator](const Value& value) {
+		return this->normalize((__int128)value.numerator * numerator,
+			(__int128)value.denominator * denominator);
+	});
+}
+
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+bool AtomicWideFraction::isLockFree() const {
+	return true;
+}
+#else
+bool AtomicWideFraction::isLockFree() const {
+	return false;
+}
+#endif
+
+
+} //namespace fraction {
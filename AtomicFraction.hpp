@@ -0,0 +1,239 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the AtomicFraction and
+* AtomicWideFraction classes
+*/
+
+
+#ifndef ATOMICFRACTION_HPP_
+#define ATOMICFRACTION_HPP_
+
+#include "Fraction.hpp"
+#include <atomic>
+#include <cstdint> //for std::uint64_t
+
+
+namespace fraction {
+
+
+/*
+This class represents a Fraction that can be shared between threads without a
+lock.
+
+The numerator and denominator are packed into a single 64-bit word, so every
+operation is a single atomic load, store or compare-and-swap of that word.
+The arithmetic operations are CAS loops: they read the current value, compute
+the new value with the Fraction operators, and try to replace the old value
+with it until no other thread changed it in between.
+
+The overflow protection is fixed at construction, and the arithmetic follows
+the rules of the compound assignment operators of Fraction (e.g. fetchAdd(x)
+behaves like 'value += x'): if the protection is on and the operation would
+overflow, NumericOverflowException() is thrown and the value is not changed.
+*/
+class AtomicFraction
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	Sets the value, and the overflow protection, to the ones of 'frac'.
+	*/
+	explicit AtomicFraction(const Fraction& frac = Fraction()) :
+		m_value(pack(frac)),
+		m_overflow_protection(frac.getOverflowProtection())
+	{
+	}
+
+	//Atomics can't be copied.
+	AtomicFraction(const AtomicFraction&) = delete;
+	AtomicFraction& operator= (const AtomicFraction&) = delete;
+
+
+	//-- public methods --//
+
+	//Returns the current value.
+	Fraction load(std::memory_order order = std::memory_order_seq_cst) const {
+		return this->unpack(this->m_value.load(order));
+	}
+
+	//Sets the value to 'frac' (its overflow protection is ignored).
+	void store(const Fraction& frac, std::memory_order order = std::memory_order_seq_cst) {
+		this->m_value.store(pack(frac), order);
+	}
+
+	//Sets the value to 'frac' and returns the previous value.
+	Fraction exchange(const Fraction& frac) {
+		return this->unpack(this->m_value.exchange(pack(frac)));
+	}
+
+	/*
+	If the value is equal to 'expected', sets it to 'desired' and returns 'true'.
+	Else, stores the current value in 'expected' and returns 'false'.
+	*/
+	bool compareExchange(Fraction& expected, const Fraction& desired);
+
+	// Arithmetic operations - each one returns the value before the operation.
+	Fraction fetchAdd(const Fraction& frac); //value+=frac
+	Fraction fetchSubtract(const Fraction& frac); //value-=frac
+	Fraction fetchMultiply(const Fraction& frac); //value*=frac
+	Fraction fetchDivide(const Fraction& frac); //value/=frac
+
+	//Returns 'true' if the operations don't use a lock.
+	bool isLockFree() const {
+		return this->m_value.is_lock_free();
+	}
+
+	//Getter for the numeric overflow
+	bool getOverflowProtection() const {
+		return this->m_overflow_protection;
+	}
+
+private:
+	//-- private data members --//
+
+	//The numerator in the high 32 bits, and the denominator in the low 32 bits
+	std::atomic<std::uint64_t> m_value;
+
+	//The overflow protection 'bool'
+	const bool m_overflow_protection;
+
+
+	//-- private methods --//
+
+	//Packs the numerator and denominator of 'frac' into one word.
+	static std::uint64_t pack(const Fraction& frac) {
+		return ((std::uint64_t)(std::uint32_t)frac.getNumerator() << 32) |
+			(std::uint32_t)frac.getDenominator();
+	}
+
+	//Unpacks a word into a Fraction with the overflow protection of this object.
+	//The word was packed from a Fraction, so it's not reduced again.
+	Fraction unpack(std::uint64_t word) const {
+		return Fraction((int)(std::uint32_t)(word >> 32), (int)(std::uint32_t)word,
+			this->m_overflow_protection, Fraction::Reduced());
+	}
+
+	//The CAS loop of the arithmetic operations.
+	template <typename Operation>
+	Fraction fetchUpdate(Operation operation);
+
+}; //class AtomicFraction {
+
+
+/*
+This class is the wide variant of AtomicFraction - a fraction with 64-bit
+numerator and denominator, packed into a 128-bit word.
+
+On x86-64 (when built with -mcx16), the word is updated with cmpxchg16b, so
+it's lock-free as well. There's no plain 16 bytes atomic load though, so
+load() is a cmpxchg16b too (of the word with itself) - loads take the cache
+line exclusively and serialize with each other and with the writes, like
+writes do, and store() is a CAS loop that starts with such a load. So an
+object that's read much more often than written scales worse than an
+AtomicFraction.
+
+On other targets it falls back to a spin lock of the object (loads included),
+so it's not lock-free, and isLockFree() returns 'false' - but objects don't
+contend with each other.
+
+The values are always reduced, with a positive denominator.
+The arithmetic is done in 128 bits, and if the reduced result doesn't fit in
+64 bits then, if the overflow protection is on, NumericOverflowException() is
+thrown (and the value is not changed), and else the result is truncated to 64
+bits, and the truncated parts are reduced and get their sign fixed.
+*/
+class AtomicWideFraction
+{
+public:
+	//-- public types --//
+
+	//A value of the wide fraction.
+	struct Value {
+		long long numerator;
+		long long denominator;
+	};
+
+
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	If the denominator is 0, it throws DivisionByZeroException().
+	*/
+	explicit AtomicWideFraction(long long numerator = 0, long long denominator = 1,
+		bool overflowProtection = false);
+
+	//Atomics can't be copied.
+	AtomicWideFraction(const AtomicWideFraction&) = delete;
+	AtomicWideFraction& operator= (const AtomicWideFraction&) = delete;
+
+
+	//-- public methods --//
+
+	//Returns the current value.
+	Value load() const;
+
+	//Sets the value (it's reduced first).
+	//If the denominator is 0, it throws DivisionByZeroException().
+	void store(long long numerator, long long denominator);
+
+	/*
+	If the value is equal to 'expected', sets it to 'desired' and returns 'true'.
+	Else, stores the current value in 'expected' and returns 'false'.
+	Both are expected to be reduced.
+	*/
+	bool compareExchange(Value& expected, const Value& desired);
+
+	// Arithmetic operations - each one returns the value before the operation.
+	Value fetchAdd(long long numerator, long long denominator); //value+=num/den
+	Value fetchMultiply(long long numerator, long long denominator); //value*=num/den
+
+	//Returns 'true' if the operations don't use a lock.
+	bool isLockFree() const;
+
+	//Getter for the numeric overflow
+	bool getOverflowProtection() const {
+		return this->m_overflow_protection;
+	}
+
+private:
+	//-- private data members --//
+
+	//The numerator in the high 64 bits, and the denominator in the low 64 bits.
+	//cmpxchg16b requires a 16 bytes alignment.
+	alignas(16) unsigned __int128 m_value;
+
+	//The overflow protection 'bool'
+	const bool m_overflow_protection;
+
+	//The lock of the word when there's no 16 bytes CAS. It's a member either
+	//way, so the layout doesn't depend on -mcx16.
+	mutable std::atomic<bool> m_locked;
+
+
+	//-- private methods --//
+
+	//Atomically compares the word with 'expected' and, if equal, replaces it
+	//with 'desired'. Returns the previous word.
+	unsigned __int128 compareAndSwap(unsigned __int128 expected, unsigned __int128 desired) const;
+
+	//Reduces numerator/denominator, fixes its sign, narrows it to 64 bits (see
+	//the class description) and packs it.
+	unsigned __int128 normalize(__int128 numerator, __int128 denominator) const;
+
+	//The CAS loop of the arithmetic operations.
+	template <typename Operation>
+	Value fetchUpdate(Operation operation);
+
+}; //class AtomicWideFraction {
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,68 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a contention benchmark of AtomicFraction against a
+* Fraction protected by a mutex.
+*
+* For 1, 2, 4, ... threads, every thread adds 1/2 to the same shared total a
+* fixed number of times, and the benchmark prints the time per addition of both
+* approaches (and the wide variant, AtomicWideFraction).
+*/
+
+#include "AtomicFraction.hpp"
+#include "Benchmark.hpp"
+#include "Fraction.hpp"
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+
+//The number of additions every thread does.
+static const int ADDITIONS = 200000;
+
+
+int main() {
+	unsigned max_threads = std::thread::hardware_concurrency();
+	if (max_threads < 8)
+		max_threads = 8;
+
+	const fraction::Fraction half(1, 2);
+
+	std::cout << "threads\tmutex ns/op\tatomic ns/op\twide atomic ns/op" << std::endl;
+
+	for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+		std::mutex lock;
+		fraction::Fraction locked_total;
+		double mutex_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			for (int i = 0; i < ADDITIONS; ++i) {
+				std::lock_guard<std::mutex> guard(lock);
+				locked_total += half;
+			}
+		});
+
+		fraction::AtomicFraction atomic_total;
+		double atomic_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			for (int i = 0; i < ADDITIONS; ++i)
+				atomic_total.fetchAdd(half);
+		});
+
+		fraction::AtomicWideFraction wide_total;
+		double wide_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			for (int i = 0; i < ADDITIONS; ++i)
+				wide_total.fetchAdd(1, 2);
+		});
+
+		//All the totals must be threads*ADDITIONS/2.
+		if (!(locked_total == atomic_total.load()) ||
+			wide_total.load().numerator != locked_total.getNumerator())
+		{
+			std::cout << "totals differ!" << std::endl;
+			return 1;
+		}
+
+		std::cout << threads << "\t" << mutex_ns << "\t\t" << atomic_ns << "\t\t"
+			<< wide_ns << std::endl;
+	}
+}
@@ -0,0 +1,53 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the timing functions of the benchmarks
+*/
+
+
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstddef> //for std::size_t
+#include <thread>
+#include <vector>
+
+
+/*
+The *Benchmark.cpp programs time their work with these functions, so they all
+report the same unit: nanoseconds per item (a value, a row, an addition...),
+lower is better. A throughput is the size of an item divided by it (bytes per
+nanosecond are GB/s).
+*/
+namespace Benchmark {
+
+	//Calls work() once, and returns the time it took in nanoseconds divided by
+	//'items' (the number of items it processed).
+	template <typename Work>
+	double measure(std::size_t items, Work work) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		work();
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / (double)items;
+	}
+
+	//Calls work() on 'threads' threads at once, and returns the time until all of
+	//them ended in nanoseconds divided by 'items' (the number of items all of
+	//them processed together).
+	template <typename Work>
+	double measureThreads(unsigned threads, std::size_t items, Work work) {
+		return measure(items, [threads, &work]() {
+			std::vector<std::thread> workers;
+			for (unsigned i = 0; i < threads; ++i)
+				workers.push_back(std::thread(work));
+			for (std::size_t i = 0; i < workers.size(); ++i)
+				workers[i].join();
+		});
+	}
+
+}
+
+#endif
@@ -0,0 +1,234 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the BinarySplitting class
+*/
+
+
+#include "BinarySplitting.hpp"
+#include "DivisionByZeroException.hpp"
+#include "Parallel.hpp"
+#include <algorithm> //for std::min, std::max
+#include <vector>
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//The minimal number of terms in a chunk that's evaluated by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 12;
+
+//Ranges of up to this number of terms are combined from left to right - the
+//numbers are small there, so it's the same as splitting them further, without
+//the recursion.
+static const std::size_t LEAF_TERMS = 8;
+
+//A combined node whose numerator or denominator grew past this number of bits
+//is reduced right away - while its gcd still runs mostly on 64-bit divisions
+//(see WideArithmetics::gcd()), and before combining it overflows.
+static const int REDUCE_THRESHOLD = 64;
+
+
+//Combines the terms with add().
+WideFraction BinarySplitting::sum(std::size_t begin, std::size_t end, const TermGenerator& term) const {
+	Partial zero = { 0, 1 };
+	return this->evaluate(begin, end, term, add, zero);
+}
+
+
+//Combines the terms with multiply().
+WideFraction BinarySplitting::product(std::size_t begin, std::size_t end, const TermGenerator& term) const {
+	Partial one = { 1, 1 };
+	return this->evaluate(begin, end, term, multiply, one);
+}
+
+
+/***
+*WideFraction BinarySplitting::evaluate() - Evaluates the tree of a range
+*
+*Purpose:
+*       Splits the range into chunks (a few per thread, as long as the chunks
+*       aren't too small), evaluates the subtree of every chunk with split()
+*       on the threads, and then combines the values of the chunks in a
+*       balanced tree of their own - so the whole computation has the same
+*       shape as a single tree.
+*
+*       Finally, the root is reduced.
+*
+*Entry:
+*       std::size_t               begin - The first index.
+*       std::size_t                 end - The end of the indices.
+*       const TermGenerator&       term - The generator of the terms.
+*       Combine                 combine - add() or multiply().
+*       const Partial&         identity - The value of an empty range.
+*
+*Exit:
+*       WideFraction - The reduced value of the range.
+*
+*Exceptions:
+*       NumericOverflowException() - If the value doesn't fit in 128 bits.
+*       DivisionByZeroException() - If a term has a denominator of 0.
+*
+*******************************************************************************/
+WideFraction BinarySplitting::evaluate(std::size_t begin, std::size_t end, const TermGenerator& term,
+	Combine combine, const Partial& identity) const
+{
+	if (begin >= end)
+		return reduce(identity);
+
+	std::size_t count = end - begin;
+	unsigned thread_count = Parallel::threadCount(this->m_threads);
+	std::size_t chunks = (1 == thread_count) ? 1 : std::max<std::size_t>(1,
+		std::min<std::size_t>(thread_count * 4, count / MIN_CHUNK_SIZE));
+
+	std::vector<Partial> values(chunks);
+	Parallel::forEach(chunks, this->m_threads, [&](std::size_t chunk) {
+		values[chunk] = split(begin + count * chunk / chunks, begin + count * (chunk + 1) / chunks, term, combine);
+	});
+
+	//Combines adjacent pairs, level after level.
+	for (std::size_t width = 1; width < chunks; width *= 2) {
+		for (std::size_t i = 0; i + width < chunks; i += 2 * width)
+			values[i] = combine(values[i], values[i + width]);
+	}
+
+	return reduce(values[0]);
+}
+
+
+//Splits the range at its middle, down to ranges of LEAF_TERMS terms.
+BinarySplitting::Partial BinarySplitting::split(std::size_t begin, std::size_t end, const TermGenerator& term,
+	Combine combine)
+{
+	if (end - begin <= LEAF_TERMS) {
+		Partial result = leaf(term, begin);
+		for (std::size_t k = begin + 1; k < end; ++k)
+			result = combine(result, leaf(term, k));
+		return result;
+	}
+
+	std::size_t middle = begin + (end - begin) / 2;
+	return combine(split(begin, middle, term, combine), split(middle, end, term, combine));
+}
+
+
+//Note that negating in 128 bits can't overflow, even for LLONG_MIN.
+BinarySplitting::Partial BinarySplitting::leaf(const TermGenerator& term, std::size_t k) {
+	SeriesTerm value = term(k);
+	if (0 == value.denominator)
+		throw DivisionByZeroException();
+
+	Partial result = { value.numerator, value.denominator };
+	if (result.denominator < 0) {
+		result.numerator = -result.numerator;
+		result.denominator = -result.denominator;
+	}
+	return result;
+}
+
+
+/***
+*Partial BinarySplitting::add() - Adds the values of two nodes
+*
+*Purpose:
+*       Computes a/b + c/d as (a*d + c*b) / (b*d), without any gcd (the sum is
+*       reduced by limit() only if it grew past REDUCE_THRESHOLD bits).
+*
+*       If that would overflow 128 bits, then with g = gcd(b,d) the sum is
+*
+*           a * (d/g) + c * (b/g)
+*           ---------------------
+*                (b/g) * d
+*
+*       which is reduced by a single gcd - the unreduced numbers might be
+*       much larger than the actual values. If even that would overflow, both
+*       values are reduced and added with WideFraction's operator+, and if
+*       that overflows too, we let NumericOverflowException() propagate.
+*
+*Entry:
+*       const Partial& lhs - a/b
+*       const Partial& rhs - c/d
+*
+*Exit:
+*       Partial - The sum.
+*
+*Exceptions:
+*       NumericOverflowException() - If the reduced sum doesn't fit in 128 bits.
+*
+*******************************************************************************/
+BinarySplitting::Partial BinarySplitting::add(const Partial& lhs, const Partial& rhs) {
+	int128 left, right;
+	Partial result;
+
+	if (!__builtin_mul_overflow(lhs.numerator, rhs.denominator, &left) &&
+		!__builtin_mul_overflow(rhs.numerator, lhs.denominator, &right) &&
+		!__builtin_add_overflow(left, right, &result.numerator) &&
+		!__builtin_mul_overflow(lhs.denominator, rhs.denominator, &result.denominator))
+	{
+		return limit(result);
+	}
+
+	int128 gcd = WideArithmetics::gcd(lhs.denominator, rhs.denominator);
+	int128 lhs_denominator = lhs.denominator / gcd;
+
+	WideFraction sum;
+	if (!__builtin_mul_overflow(lhs.numerator, rhs.denominator / gcd, &left) &&
+		!__builtin_mul_overflow(rhs.numerator, lhs_denominator, &right) &&
+		!__builtin_add_overflow(left, right, &result.numerator) &&
+		!__builtin_mul_overflow(lhs_denominator, rhs.denominator, &result.denominator))
+	{
+		sum = reduce(result);
+	}
+	else {
+		sum = reduce(lhs) + reduce(rhs);
+	}
+
+	result.numerator = sum.numerator;
+	result.denominator = sum.denominator;
+	return result;
+}
+
+
+//(a*c) / (b*d) without any gcd (and through limit()), and with WideFraction's
+//operator* (which cross-reduces) if that would overflow - like add().
+BinarySplitting::Partial BinarySplitting::multiply(const Partial& lhs, const Partial& rhs) {
+	Partial result;
+
+	if (!__builtin_mul_overflow(lhs.numerator, rhs.numerator, &result.numerator) &&
+		!__builtin_mul_overflow(lhs.denominator, rhs.denominator, &result.denominator))
+	{
+		return limit(result);
+	}
+
+	WideFraction product = reduce(lhs) * reduce(rhs);
+	result.numerator = product.numerator;
+	result.denominator = product.denominator;
+	return result;
+}
+
+
+//Reduces 'partial' if it grew past REDUCE_THRESHOLD bits.
+BinarySplitting::Partial BinarySplitting::limit(const Partial& partial) {
+	if (WideArithmetics::bitLength(partial.numerator) <= REDUCE_THRESHOLD &&
+		WideArithmetics::bitLength(partial.denominator) <= REDUCE_THRESHOLD)
+	{
+		return partial;
+	}
+
+	WideFraction value = reduce(partial);
+	Partial result = { value.numerator, value.denominator };
+	return result;
+}
+
+
+//The denominator is already positive.
+WideFraction BinarySplitting::reduce(const Partial& partial) {
+	return WideFraction::reduced(partial.numerator, partial.denominator);
+}
+
+} //namespace fraction {
@@ -0,0 +1,141 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the BinarySplitting class
+*/
+
+
+#ifndef BINARYSPLITTING_HPP_
+#define BINARYSPLITTING_HPP_
+
+#include "WideArithmetics.hpp"
+#include "WideFraction.hpp"
+#include <cstddef> //for std::size_t
+#include <functional>
+
+
+namespace fraction {
+
+
+/*
+A term of a series - numerator/denominator, with 64-bit integers (so terms
+such as 1/(k*(k+1)) don't overflow for large k). It needn't be reduced, and
+its denominator may be negative, but not 0.
+*/
+struct SeriesTerm {
+	long long numerator;
+	long long denominator;
+};
+
+
+/*
+This class computes exact sums and products of long series of rational terms -
+e.g. the sum of 1/(k*(k+1)) or the product of (k*k-1)/(k*k) over a range of
+k's - given a generator of the terms.
+
+Adding the terms one after the other (e.g. with Fraction::operator+=) reduces
+every partial sum, which costs a gcd (and overflow checks) per term. Here the
+terms are combined in a balanced binary tree instead: the two halves of a
+range are evaluated recursively and then combined with plain 128-bit
+multiplications and additions, without reducing them. A node is reduced only
+once its numerator or denominator grows past 64 bits (or combining it would
+overflow 128 bits), and the root is reduced once at the end - so with small
+denominators (e.g. amounts in cents) most of the tree costs no gcd at all.
+
+The range is split into a few chunks per thread, whose subtrees are evaluated
+in parallel on 'threads' threads, and then combined in a balanced tree as
+well.
+
+The result is returned as a reduced WideFraction. If it doesn't fit in 128
+bits (or a reduced node on the way doesn't), the methods throw
+NumericOverflowException(). If a term has a denominator of 0, they throw
+DivisionByZeroException(). The exceptions of the generator propagate as they
+are.
+*/
+class BinarySplitting
+{
+public:
+	//-- types --//
+
+	//Returns the term of a given index. It's called from several threads at
+	//once, so it must be thread safe.
+	typedef std::function<SeriesTerm(std::size_t)> TermGenerator;
+
+
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+	'threads' is the number of threads used (0 means the number of hardware
+	threads).
+	*/
+	explicit BinarySplitting(unsigned threads = 0) :
+		m_threads(threads)
+	{
+	}
+
+
+	//-- public methods --//
+
+	//Returns the sum of term(k) for every k in [begin, end) (0 if the range is
+	//empty).
+	WideFraction sum(std::size_t begin, std::size_t end, const TermGenerator& term) const;
+
+	//Returns the product of term(k) for every k in [begin, end) (1 if the
+	//range is empty).
+	WideFraction product(std::size_t begin, std::size_t end, const TermGenerator& term) const;
+
+private:
+	//-- types --//
+
+	//The value of a node of the tree: a fraction that's not necessarily
+	//reduced, with a positive denominator.
+	struct Partial {
+		WideArithmetics::int128 numerator;
+		WideArithmetics::int128 denominator;
+	};
+
+	//Combines the values of two adjacent nodes.
+	typedef Partial (*Combine)(const Partial& lhs, const Partial& rhs);
+
+
+	//-- private data members --//
+
+	//The number of threads (0 means the number of hardware threads)
+	unsigned m_threads;
+
+
+	//-- private methods --//
+
+	/*
+	Evaluates the tree of [begin, end) with 'combine' on parallel chunks, and
+	returns the reduced root. 'identity' is the value of an empty range.
+	*/
+	WideFraction evaluate(std::size_t begin, std::size_t end, const TermGenerator& term, Combine combine,
+		const Partial& identity) const;
+
+	//Returns the value of the subtree of the (non-empty) range [begin, end).
+	static Partial split(std::size_t begin, std::size_t end, const TermGenerator& term, Combine combine);
+
+	//Returns the term of index 'k', with a positive denominator.
+	static Partial leaf(const TermGenerator& term, std::size_t k);
+
+	//lhs+rhs, reduced only if it's large.
+	static Partial add(const Partial& lhs, const Partial& rhs);
+
+	//lhs*rhs, reduced only if it's large.
+	static Partial multiply(const Partial& lhs, const Partial& rhs);
+
+	//Returns 'partial', reduced if it grew past REDUCE_THRESHOLD bits.
+	static Partial limit(const Partial& partial);
+
+	//Returns the reduced value of 'partial'.
+	static WideFraction reduce(const Partial& partial);
+
+}; //class BinarySplitting {
+
+} //namespace fraction {
+
+#endif
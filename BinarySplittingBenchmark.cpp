@@ -0,0 +1,119 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of BinarySplitting against term-by-term
+* evaluation.
+*
+* It sums payments in cents, 1/(k*(k+1)) and multiplies (k*k-1)/(k*k) over a
+* long range of k's (whose exact results are small) with BinarySplitting,
+* and term by term with WideFraction's operators (which reduce every partial
+* result, like Fraction::operator+= - but the terms don't fit in a Fraction)
+* and with a FractionAccumulator, and prints the time per term of each.
+*/
+
+#include "Benchmark.hpp"
+#include "BinarySplitting.hpp"
+#include "FractionAccumulator.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+
+
+//The number of terms.
+static const std::size_t TERMS = 1 << 22;
+
+
+//1/(k*(k+1)), for k from 1
+static fraction::SeriesTerm telescopingTerm(std::size_t index) {
+	long long k = (long long)index + 1;
+	fraction::SeriesTerm term = { 1, k * (k + 1) };
+	return term;
+}
+
+
+//(k mod 1000 - 500)/100 - a payment in cents
+static fraction::SeriesTerm centsTerm(std::size_t index) {
+	fraction::SeriesTerm term = { (long long)(index % 1000) - 500, 100 };
+	return term;
+}
+
+
+//(k*k-1)/(k*k), for k from 2
+static fraction::SeriesTerm productTerm(std::size_t index) {
+	long long k = (long long)index + 2;
+	fraction::SeriesTerm term = { k * k - 1, k * k };
+	return term;
+}
+
+
+//Returns 'term' as a WideFraction.
+static fraction::WideFraction toWide(const fraction::SeriesTerm& term) {
+	return fraction::WideFraction::reduced(term.numerator, term.denominator);
+}
+
+
+int main() {
+	fraction::WideFraction splitting_sum, splitting_product, sequential_sum, sequential_product, accumulated_sum;
+	fraction::WideFraction splitting_cents, sequential_cents;
+
+	double splitting_cents_time = Benchmark::measure(TERMS, [&]() {
+		splitting_cents = fraction::BinarySplitting(1).sum(0, TERMS, centsTerm);
+	});
+	double sequential_cents_time = Benchmark::measure(TERMS, [&]() {
+		sequential_cents = fraction::WideFraction::reduced(0, 1);
+		for (std::size_t i = 0; i < TERMS; ++i)
+			sequential_cents = sequential_cents + toWide(centsTerm(i));
+	});
+
+	double splitting_sum_time = Benchmark::measure(TERMS, [&]() {
+		splitting_sum = fraction::BinarySplitting(1).sum(0, TERMS, telescopingTerm);
+	});
+	double parallel_sum_time = Benchmark::measure(TERMS, [&]() {
+		splitting_sum = fraction::BinarySplitting().sum(0, TERMS, telescopingTerm);
+	});
+	double sequential_sum_time = Benchmark::measure(TERMS, [&]() {
+		sequential_sum = fraction::WideFraction::reduced(0, 1);
+		for (std::size_t i = 0; i < TERMS; ++i)
+			sequential_sum = sequential_sum + toWide(telescopingTerm(i));
+	});
+	double accumulated_sum_time = Benchmark::measure(TERMS, [&]() {
+		fraction::FractionAccumulator accumulator;
+		for (std::size_t i = 0; i < TERMS; ++i) {
+			fraction::SeriesTerm term = telescopingTerm(i);
+			accumulator.merge(term.numerator, term.denominator, 1);
+		}
+		accumulator.reduce();
+		accumulated_sum.numerator = accumulator.getNumerator();
+		accumulated_sum.denominator = accumulator.getDenominator();
+	});
+
+	double splitting_product_time = Benchmark::measure(TERMS, [&]() {
+		splitting_product = fraction::BinarySplitting(1).product(0, TERMS, productTerm);
+	});
+	double sequential_product_time = Benchmark::measure(TERMS, [&]() {
+		sequential_product = fraction::WideFraction::reduced(1, 1);
+		for (std::size_t i = 0; i < TERMS; ++i)
+			sequential_product = sequential_product * toWide(productTerm(i));
+	});
+
+	if (!(splitting_cents == sequential_cents) || !(splitting_sum == sequential_sum) || !(splitting_sum == accumulated_sum) ||
+		!(splitting_product == sequential_product))
+	{
+		std::cout << "results differ!" << std::endl;
+		return 1;
+	}
+
+	std::cout << "sum of cents = " << splitting_cents.toString() << std::endl;
+	std::cout << "\tbinary splitting " << splitting_cents_time << " ns/term, term by term "
+		<< sequential_cents_time << " ns/term" << std::endl;
+	std::cout << "sum of 1/(k(k+1)) = " << splitting_sum.toString() << std::endl;
+	std::cout << "\tbinary splitting " << splitting_sum_time << " ns/term (" << parallel_sum_time
+		<< " on all threads), term by term " << sequential_sum_time << " ns/term, accumulator "
+		<< accumulated_sum_time << " ns/term" << std::endl;
+	std::cout << "product of (k^2-1)/k^2 = " << splitting_product.toString() << std::endl;
+	std::cout << "\tbinary splitting " << splitting_product_time << " ns/term, term by term "
+		<< sequential_product_time << " ns/term" << std::endl;
+
+	return 0;
+}
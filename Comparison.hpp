@@ -0,0 +1,30 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the Comparison enum, which the filtering kernels select
+* by
+*/
+
+
+#ifndef COMPARISON_HPP_
+#define COMPARISON_HPP_
+
+
+namespace fraction {
+
+
+//The comparison filter() (and FixedDenominatorArray::compare()) selects by.
+enum class Comparison {
+	Less,
+	LessEqual,
+	Greater,
+	GreaterEqual,
+	Equal,
+	NotEqual
+};
+
+} //namespace fraction {
+
+#endif
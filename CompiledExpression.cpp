@@ -0,0 +1,885 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the CompiledExpression class
+*/
+
+#include "CompiledExpression.hpp"
+#include "DivisionByZeroException.hpp"
+#include "FractionLoader.hpp" //for parseFraction()
+#include "NumericOverflowException.hpp"
+#include "Parallel.hpp"
+#include <algorithm> //for std::min, std::max
+#include <cctype> //for std::isalpha(), std::isalnum(), std::isdigit(), std::isspace()
+#include <climits> //for INT_MIN, INT_MAX
+#include <stdexcept> //for std::invalid_argument
+
+
+namespace fraction {
+
+
+//The number of rows run() executes every instruction on at once.
+static const std::size_t BLOCK_SIZE = 256;
+
+//The minimal number of rows in a chunk of the batch evaluate().
+static const std::size_t MIN_CHUNK_SIZE = 1 << 14;
+
+//The number of registers an instruction can address.
+static const std::size_t MAX_REGISTERS = 1 << 16;
+
+//The deepest nesting of parentheses and unary operators (which bounds the
+//recursion of the parser).
+static const std::size_t MAX_NESTING = 1024;
+
+//The deepest syntax tree (which bounds the recursion of the code generator -
+//a chain of N additions is N deep).
+static const std::size_t MAX_TREE_DEPTH = 1 << 14;
+
+
+/* The operations on single values */
+
+
+//Returns the greatest common divisor of |num1| and |num2|, where |num2| is at
+//most 2^31 (so after the first remainder, the divisions are 32-bit ones).
+static long long gcd(long long num1, long long num2) {
+	unsigned long long first = (num1 < 0) ? 0ull - (unsigned long long)num1 : (unsigned long long)num1;
+	unsigned second = (unsigned)((num2 < 0) ? 0ull - (unsigned long long)num2 : (unsigned long long)num2);
+
+	if (0 == second)
+		return (long long)first;
+
+	unsigned remainder = (unsigned)(first % second);
+	while (0 != remainder) {
+		unsigned next = second % remainder;
+		second = remainder;
+		remainder = next;
+	}
+
+	return second;
+}
+
+
+//Stores numerator/denominator (co-prime, with a denominator that's not 0) in
+//'resultNumerator' and 'resultDenominator', with a positive denominator (and
+//the denominator 1 for a zero).
+//If it doesn't fit in a Fraction, it throws NumericOverflowException().
+static inline void store(long long numerator, long long denominator, int& resultNumerator,
+	int& resultDenominator)
+{
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	if (numerator < INT_MIN || numerator > INT_MAX || denominator > INT_MAX)
+		throw NumericOverflowException();
+
+	resultNumerator = (int)numerator;
+	resultDenominator = (0 == numerator) ? 1 : (int)denominator;
+}
+
+
+/***
+*void addValues() - Stores a/b + c/d
+*
+*Purpose:
+*       Equal denominators (which include two integers) are added directly,
+*       and reduced with a single gcd (none for integers).
+*       Else, it's the addition of Fraction::operator+=: with g1 = gcd(b,d)
+*       and t = a*(d/g1) + c*(b/g1), the sum is (t/g2) / ((b/g1)*(d/g2)),
+*       where g2 = gcd(t,g1).
+*
+*       Every intermediate is less than 2^63 in magnitude.
+*
+*Entry:
+*       long long a, b, c, d - The operands (reduced, with positive
+*                              denominators; |c| may be 2^31, for a
+*                              subtraction).
+*       int&       numerator - Would hold the numerator of the sum.
+*       int&     denominator - Would hold the denominator of the sum.
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If the sum doesn't fit in a Fraction.
+*
+*******************************************************************************/
+static inline void addValues(long long a, long long b, long long c, long long d, int& numerator,
+	int& denominator)
+{
+	if (b == d) {
+		long long sum = a + c;
+		if (1 == b)
+			store(sum, 1, numerator, denominator);
+		else {
+			long long divisor = gcd(sum, b);
+			store(sum / divisor, b / divisor, numerator, denominator);
+		}
+		return;
+	}
+
+	long long gcd1 = gcd(b, d);
+	if (1 == gcd1) {
+		store(a*d + c*b, b*d, numerator, denominator);
+		return;
+	}
+
+	long long b_gcd = b / gcd1;
+	long long t = a*(d / gcd1) + c*b_gcd;
+	long long gcd2 = gcd(t, gcd1);
+	store(t / gcd2, b_gcd * (d / gcd2), numerator, denominator);
+}
+
+
+//The product of two integers needs no gcd. Else, the common factors of each
+//numerator with the other denominator are cancelled first (as
+//Fraction::operator*= does), so the product is already reduced.
+//'d' may be negative (for a division).
+static inline void multiplyValues(long long a, long long b, long long c, long long d, int& numerator,
+	int& denominator)
+{
+	if (1 == b && 1 == d) {
+		store(a*c, 1, numerator, denominator);
+		return;
+	}
+
+	long long gcd1 = gcd(a, d);
+	long long gcd2 = gcd(c, b);
+	store((a / gcd1) * (c / gcd2), (b / gcd2) * (d / gcd1), numerator, denominator);
+}
+
+
+//Returns 'true' if any of the 'count' denominators is 0. The loop has no
+//branches, so the compiler can vectorize it.
+static bool hasZeroDenominator(const int* denominators, std::size_t count) {
+	bool zero = false;
+	for (std::size_t i = 0; i < count; ++i)
+		zero |= (0 == denominators[i]);
+	return zero;
+}
+
+
+//An operand of an instruction in run(): its values in the current block.
+//A constant has the same value for every row, so its stride is 0.
+struct BlockOperand {
+	const int* numerators;
+	const int* denominators;
+	std::size_t stride;
+};
+
+
+//Calls operation(a, b, c, d, numerator, denominator) on every row of the
+//block, where a/b is the value of 'left' and c/d is the value of 'right'.
+template <typename Operation>
+static void applyBinary(const BlockOperand& left, const BlockOperand& right, int* numerators,
+	int* denominators, std::size_t count, Operation operation)
+{
+	for (std::size_t i = 0; i < count; ++i) {
+		operation(left.numerators[i * left.stride], left.denominators[i * left.stride],
+			right.numerators[i * right.stride], right.denominators[i * right.stride],
+			numerators[i], denominators[i]);
+	}
+}
+
+
+/* The syntax tree */
+
+
+//A constant, a variable or an operation on the nodes 'left' and 'right'
+//(which are indices of nodes - only 'left' for a negation). 'depth' is the
+//height of the subtree (1 for a leaf).
+struct CompiledExpression::Node {
+
+	enum class Kind {
+		Constant,
+		Variable,
+		Operation
+	};
+
+	Kind kind;
+	OpCode op;
+	Fraction value;
+	std::size_t variable;
+	std::size_t left;
+	std::size_t right;
+	std::size_t depth;
+};
+
+
+/*
+A recursive descent parser of the grammar
+
+	expression := term (('+' | '-') term)*
+	term       := unary (('*' | '/') unary)*
+	unary      := ('+' | '-') unary | primary
+	primary    := literal | variable | '(' expression ')'
+
+which builds the syntax tree bottom up, and folds every operation whose
+operands are constants (and the trivial ones - see operation()) as it's built.
+*/
+class CompiledExpression::Parser
+{
+public:
+	Parser(const std::string& formula, std::vector<std::string>& variables, std::vector<Node>& nodes) :
+		m_formula(formula),
+		m_position(0),
+		m_depth(0),
+		m_variables(variables),
+		m_nodes(nodes)
+	{
+	}
+
+	//Parses the whole formula, and returns the index of the root of the tree.
+	std::size_t parse() {
+		std::size_t root = this->expression();
+
+		this->skipSpaces();
+		if (this->m_position < this->m_formula.size())
+			this->error("unexpected '" + std::string(1, this->m_formula[this->m_position]) + "'");
+
+		return root;
+	}
+
+private:
+	const std::string& m_formula;
+	std::size_t m_position;
+	std::size_t m_depth;
+	std::vector<std::string>& m_variables;
+	std::vector<Node>& m_nodes;
+
+
+	//Throws std::invalid_argument with 'message' and the current column.
+	void error(const std::string& message) const {
+		throw std::invalid_argument("CompiledExpression: " + message + " at column " +
+			std::to_string(this->m_position + 1));
+	}
+
+	void skipSpaces() {
+		while (this->m_position < this->m_formula.size() &&
+			std::isspace((unsigned char)this->m_formula[this->m_position]))
+		{
+			++this->m_position;
+		}
+	}
+
+	//Skips the spaces, and consumes 'symbol' if it's the next character.
+	bool accept(char symbol) {
+		this->skipSpaces();
+		if (this->m_position < this->m_formula.size() && symbol == this->m_formula[this->m_position]) {
+			++this->m_position;
+			return true;
+		}
+		return false;
+	}
+
+	std::size_t expression() {
+		if (++this->m_depth > MAX_NESTING)
+			this->error("the formula is nested too deeply");
+
+		std::size_t result = this->term();
+		while (true) {
+			if (this->accept('+'))
+				result = this->operation(OpCode::Add, result, this->term());
+			else if (this->accept('-'))
+				result = this->operation(OpCode::Subtract, result, this->term());
+			else
+				break;
+		}
+
+		--this->m_depth;
+		return result;
+	}
+
+	std::size_t term() {
+		std::size_t result = this->unary();
+		while (true) {
+			if (this->accept('*'))
+				result = this->operation(OpCode::Multiply, result, this->unary());
+			else if (this->accept('/'))
+				result = this->operation(OpCode::Divide, result, this->unary());
+			else
+				break;
+		}
+		return result;
+	}
+
+	std::size_t unary() {
+		if (this->accept('+'))
+			return this->nested([this]() { return this->unary(); });
+		if (this->accept('-'))
+			return this->operation(OpCode::Negate, this->nested([this]() { return this->unary(); }), 0);
+		return this->primary();
+	}
+
+	//Calls parse() one level deeper (for chains of unary operators).
+	template <typename Parse>
+	std::size_t nested(Parse parse) {
+		if (++this->m_depth > MAX_NESTING)
+			this->error("the formula is nested too deeply");
+		std::size_t result = parse();
+		--this->m_depth;
+		return result;
+	}
+
+	std::size_t primary() {
+		this->skipSpaces();
+		if (this->m_position == this->m_formula.size())
+			this->error("unexpected end of the formula");
+
+		char next = this->m_formula[this->m_position];
+
+		if (this->accept('(')) {
+			std::size_t result = this->expression();
+			if (!this->accept(')'))
+				this->error("expected ')'");
+			return result;
+		}
+
+		if (std::isdigit((unsigned char)next) || '.' == next)
+			return this->literal();
+
+		if (std::isalpha((unsigned char)next) || '_' == next)
+			return this->variable();
+
+		this->error("unexpected '" + std::string(1, next) + "'");
+		return 0;
+	}
+
+	//Returns 'true' if the character at 'position' is a digit.
+	bool isDigit(std::size_t position) const {
+		return position < this->m_formula.size() && std::isdigit((unsigned char)this->m_formula[position]);
+	}
+
+	//An integer or a decimal, with an optional repeating part in parentheses
+	//right after the fractional digits (e.g. "0.1(6)").
+	std::size_t literal() {
+		std::size_t begin = this->m_position;
+
+		while (this->isDigit(this->m_position))
+			++this->m_position;
+
+		if (this->m_position < this->m_formula.size() && '.' == this->m_formula[this->m_position]) {
+			++this->m_position;
+			while (this->isDigit(this->m_position))
+				++this->m_position;
+
+			//A '(' is the repeating part only if it holds digits alone.
+			std::size_t end = this->m_position + 1;
+			while (this->isDigit(end))
+				++end;
+			if (this->m_position < this->m_formula.size() && '(' == this->m_formula[this->m_position] &&
+				end > this->m_position + 1 && end < this->m_formula.size() && ')' == this->m_formula[end])
+			{
+				this->m_position = end + 1;
+			}
+		}
+
+		int numerator, denominator;
+		const char* text = this->m_formula.data();
+		ParseStatus status = parseFraction(text + begin, text + this->m_position, numerator, denominator);
+
+		if (ParseStatus::Overflow == status)
+			throw NumericOverflowException();
+		if (ParseStatus::Ok != status) {
+			this->m_position = begin;
+			this->error("malformed number");
+		}
+
+		return this->constant(Fraction(numerator, denominator, true));
+	}
+
+	std::size_t variable() {
+		std::size_t begin = this->m_position;
+		while (this->m_position < this->m_formula.size() &&
+			(std::isalnum((unsigned char)this->m_formula[this->m_position]) || '_' == this->m_formula[this->m_position]))
+		{
+			++this->m_position;
+		}
+
+		std::string name = this->m_formula.substr(begin, this->m_position - begin);
+		std::size_t index = 0;
+		while (index < this->m_variables.size() && this->m_variables[index] != name)
+			++index;
+		if (index == this->m_variables.size())
+			this->m_variables.push_back(name);
+
+		Node node = Node();
+		node.kind = Node::Kind::Variable;
+		node.variable = index;
+		node.depth = 1;
+		return this->add(node);
+	}
+
+	std::size_t constant(const Fraction& value) {
+		Node node = Node();
+		node.kind = Node::Kind::Constant;
+		node.value = value;
+		node.depth = 1;
+		return this->add(node);
+	}
+
+	std::size_t add(const Node& node) {
+		this->m_nodes.push_back(node);
+		return this->m_nodes.size() - 1;
+	}
+
+	//Returns 'true' if the node at 'index' is the constant 'number'.
+	bool isConstant(std::size_t index, int number) const {
+		const Node& node = this->m_nodes[index];
+		return Node::Kind::Constant == node.kind && node.value == number;
+	}
+
+	/***
+	*std::size_t operation() - Adds the node 'left op right', folded if possible
+	*
+	*Purpose:
+	*       If the operands are constants, the result is computed now (with
+	*       the overflow protection on), and is a constant.
+	*       x+0, 0+x, x-0, x*1, 1*x, x/1 and -(-x) are x, 0-x is -x, and a
+	*       multiplication by -1 is a negation.
+	*
+	*Entry:
+	*       OpCode        op - The operation.
+	*       std::size_t left - The left (or only) operand.
+	*       std::size_t right - The right operand (unused for a negation).
+	*
+	*Exit:
+	*       std::size_t - The index of the resulting node.
+	*
+	*Exceptions:
+	*       NumericOverflowException() - If a folded result doesn't fit in a
+	*                                    Fraction.
+	*       DivisionByZeroException()  - If a constant is divided by 0.
+	*
+	*******************************************************************************/
+	std::size_t operation(OpCode op, std::size_t left, std::size_t right) {
+		const Node& left_node = this->m_nodes[left];
+
+		if (OpCode::Negate == op) {
+			if (Node::Kind::Constant == left_node.kind)
+				return this->constant(-left_node.value);
+			if (Node::Kind::Operation == left_node.kind && OpCode::Negate == left_node.op)
+				return left_node.left;
+		}
+		else {
+			const Node& right_node = this->m_nodes[right];
+
+			if (Node::Kind::Constant == left_node.kind && Node::Kind::Constant == right_node.kind) {
+				Fraction value = left_node.value;
+				switch (op) {
+				case OpCode::Add:      value += right_node.value; break;
+				case OpCode::Subtract: value -= right_node.value; break;
+				case OpCode::Multiply: value *= right_node.value; break;
+				default:               value /= right_node.value; break;
+				}
+				return this->constant(value);
+			}
+
+			switch (op) {
+			case OpCode::Add:
+				if (this->isConstant(right, 0))
+					return left;
+				if (this->isConstant(left, 0))
+					return right;
+				break;
+			case OpCode::Subtract:
+				if (this->isConstant(right, 0))
+					return left;
+				if (this->isConstant(left, 0))
+					return this->operation(OpCode::Negate, right, 0);
+				break;
+			case OpCode::Multiply:
+				if (this->isConstant(right, 1))
+					return left;
+				if (this->isConstant(left, 1))
+					return right;
+				if (this->isConstant(right, -1))
+					return this->operation(OpCode::Negate, left, 0);
+				if (this->isConstant(left, -1))
+					return this->operation(OpCode::Negate, right, 0);
+				break;
+			default:
+				if (this->isConstant(right, 1))
+					return left;
+				break;
+			}
+		}
+
+		Node node = Node();
+		node.kind = Node::Kind::Operation;
+		node.op = op;
+		node.left = left;
+		node.right = right;
+		node.depth = 1 + std::max(left_node.depth, (OpCode::Negate == op) ? 0 : this->m_nodes[right].depth);
+		if (node.depth > MAX_TREE_DEPTH)
+			this->error("the formula is too long");
+		return this->add(node);
+	}
+
+}; //class CompiledExpression::Parser {
+
+
+/* CompiledExpression */
+
+
+/***
+*CompiledExpression::CompiledExpression() - Compiles a formula
+*
+*Purpose:
+*       Parses the formula into a (folded) syntax tree, collects its
+*       constants, and emits its instructions in post order.
+*
+*       The registers are numbered: the variables, then the constants, and
+*       then the temporaries. A temporary is freed once the instruction that
+*       reads it is emitted, so the number of temporaries is about the depth
+*       of the tree rather than its size.
+*
+*Entry:
+*       const std::string& formula - The formula.
+*
+*Exit:
+*
+*Exceptions:
+*       std::invalid_argument      - If the formula is malformed, or needs
+*                                    more registers than an instruction can
+*                                    address.
+*       NumericOverflowException() - If a literal or a folded constant
+*                                    doesn't fit in a Fraction.
+*       DivisionByZeroException()  - If a constant is divided by 0.
+*
+*******************************************************************************/
+CompiledExpression::CompiledExpression(const std::string& formula) :
+	m_temporaries(0),
+	m_result(0)
+{
+	std::vector<Node> nodes;
+	Parser parser(formula, this->m_variables, nodes);
+	std::size_t root = parser.parse();
+
+	this->collectConstants(nodes, root);
+
+	std::vector<std::uint16_t> free_temporaries;
+	this->m_result = this->emit(nodes, root, free_temporaries);
+}
+
+
+//Returns the index of 'name' in the variables.
+std::size_t CompiledExpression::variableIndex(const std::string& name) const {
+	for (std::size_t i = 0; i < this->m_variables.size(); ++i) {
+		if (this->m_variables[i] == name)
+			return i;
+	}
+
+	throw std::invalid_argument("CompiledExpression::variableIndex(): no variable '" + name + "'");
+}
+
+
+//Evaluates a single row, whose columns are the values themselves.
+Fraction CompiledExpression::evaluate(const std::vector<Fraction>& values) const {
+	std::size_t variables = this->m_variables.size();
+	if (values.size() != variables) {
+		throw std::invalid_argument("CompiledExpression::evaluate(): expected " + std::to_string(variables) +
+			" values");
+	}
+
+	std::vector<int> numerators(variables), denominators(variables);
+	std::vector<const int*> numerator_columns(variables), denominator_columns(variables);
+	for (std::size_t i = 0; i < variables; ++i) {
+		numerators[i] = values[i].getNumerator();
+		denominators[i] = values[i].getDenominator();
+		numerator_columns[i] = &numerators[i];
+		denominator_columns[i] = &denominators[i];
+	}
+
+	int numerator, denominator;
+	this->run(numerator_columns.data(), denominator_columns.data(), 1, &numerator, &denominator);
+	return Fraction(numerator, denominator);
+}
+
+
+/***
+*void CompiledExpression::evaluate() - Evaluates the formula over columns
+*
+*Purpose:
+*       Splits the rows into chunks (about 4 per thread, of at least
+*       MIN_CHUNK_SIZE rows), and runs the bytecode over every chunk.
+*
+*       'result' is resized before the pointers to the columns are taken, so
+*       they stay valid if it's one of the columns (which then has the same
+*       size, and isn't reallocated). Every block of rows is read entirely
+*       before its results are stored, so evaluating in place is safe.
+*
+*Entry:
+*       const std::vector<const FractionColumns*>& columns - A column per
+*                                                             variable.
+*       FractionColumns&                             result - Would hold the
+*                                                             results.
+*       unsigned                                    threads - The number of
+*                                                             threads.
+*
+*Exit:
+*
+*Exceptions:
+*       std::invalid_argument      - If the number of columns is not the
+*                                    number of variables, or their sizes
+*                                    differ.
+*       NumericOverflowException() - If a value doesn't fit in a Fraction.
+*       DivisionByZeroException()  - If a value is divided by 0, or a
+*                                    column has the denominator 0.
+*
+*******************************************************************************/
+void CompiledExpression::evaluate(const std::vector<const FractionColumns*>& columns, FractionColumns& result,
+	unsigned threads) const
+{
+	std::size_t variables = this->m_variables.size();
+	if (columns.size() != variables) {
+		throw std::invalid_argument("CompiledExpression::evaluate(): expected " + std::to_string(variables) +
+			" columns");
+	}
+
+	std::size_t count = (0 == variables) ? 1 : columns[0]->size();
+	for (std::size_t i = 1; i < variables; ++i) {
+		if (columns[i]->size() != count)
+			throw std::invalid_argument("CompiledExpression::evaluate(): the columns have different sizes");
+	}
+
+	result.resize(count);
+
+	std::vector<const int*> numerators(variables), denominators(variables);
+	for (std::size_t i = 0; i < variables; ++i) {
+		numerators[i] = columns[i]->numerators();
+		denominators[i] = columns[i]->denominators();
+	}
+
+	std::size_t chunks = std::max<std::size_t>(1,
+		std::min<std::size_t>(Parallel::threadCount(threads) * 4, count / MIN_CHUNK_SIZE));
+	std::size_t chunk_size = (count + chunks - 1) / chunks;
+
+	Parallel::forEach(chunks, threads, [&](std::size_t chunk) {
+		std::size_t begin = chunk * chunk_size;
+		std::size_t end = std::min(count, begin + chunk_size);
+		if (begin >= end)
+			return;
+
+		std::vector<const int*> chunk_numerators(variables), chunk_denominators(variables);
+		for (std::size_t i = 0; i < variables; ++i) {
+			chunk_numerators[i] = numerators[i] + begin;
+			chunk_denominators[i] = denominators[i] + begin;
+		}
+
+		this->run(chunk_numerators.data(), chunk_denominators.data(), end - begin,
+			result.numerators() + begin, result.denominators() + begin);
+	});
+}
+
+
+//Adds every constant leaf that isn't among the constants yet.
+void CompiledExpression::collectConstants(const std::vector<Node>& nodes, std::size_t index) {
+	const Node& node = nodes[index];
+
+	if (Node::Kind::Operation == node.kind) {
+		this->collectConstants(nodes, node.left);
+		if (OpCode::Negate != node.op)
+			this->collectConstants(nodes, node.right);
+		return;
+	}
+
+	if (Node::Kind::Constant != node.kind)
+		return;
+
+	for (std::size_t i = 0; i < this->m_constant_numerators.size(); ++i) {
+		if (this->m_constant_numerators[i] == node.value.getNumerator() &&
+			this->m_constant_denominators[i] == node.value.getDenominator())
+		{
+			return;
+		}
+	}
+
+	this->m_constant_numerators.push_back(node.value.getNumerator());
+	this->m_constant_denominators.push_back(node.value.getDenominator());
+}
+
+
+/***
+*std::uint16_t CompiledExpression::emit() - Emits the code of a subtree
+*
+*Purpose:
+*       A variable or a constant is already in a register. For an operation,
+*       the operands are emitted first, their temporaries are freed, and the
+*       result goes to a free temporary (possibly one of the operands' - an
+*       instruction reads the operands of a row before it writes its result).
+*
+*Entry:
+*       const std::vector<Node>&           nodes - The syntax tree.
+*       std::size_t                        index - The root of the subtree.
+*       std::vector<std::uint16_t>& freeTemporaries - The free temporaries.
+*
+*Exit:
+*       std::uint16_t - The register of the value of the subtree.
+*
+*Exceptions:
+*       std::invalid_argument - If there are too many registers.
+*
+*******************************************************************************/
+std::uint16_t CompiledExpression::emit(const std::vector<Node>& nodes, std::size_t index,
+	std::vector<std::uint16_t>& freeTemporaries)
+{
+	const Node& node = nodes[index];
+	std::size_t first_constant = this->m_variables.size();
+	std::size_t first_temporary = first_constant + this->m_constant_numerators.size();
+
+	if (Node::Kind::Variable == node.kind)
+		return (std::uint16_t)node.variable;
+
+	if (Node::Kind::Constant == node.kind) {
+		std::size_t i = 0;
+		while (this->m_constant_numerators[i] != node.value.getNumerator() ||
+			this->m_constant_denominators[i] != node.value.getDenominator())
+		{
+			++i;
+		}
+		return (std::uint16_t)(first_constant + i);
+	}
+
+	Instruction instruction;
+	instruction.op = node.op;
+	instruction.left = this->emit(nodes, node.left, freeTemporaries);
+	instruction.right = (OpCode::Negate == node.op) ? instruction.left :
+		this->emit(nodes, node.right, freeTemporaries);
+
+	if (instruction.left >= first_temporary)
+		freeTemporaries.push_back(instruction.left);
+	if (instruction.right >= first_temporary && instruction.right != instruction.left)
+		freeTemporaries.push_back(instruction.right);
+
+	if (!freeTemporaries.empty()) {
+		instruction.destination = freeTemporaries.back();
+		freeTemporaries.pop_back();
+	}
+	else {
+		if (first_temporary + this->m_temporaries >= MAX_REGISTERS)
+			throw std::invalid_argument("CompiledExpression: the formula needs too many registers");
+		instruction.destination = (std::uint16_t)(first_temporary + this->m_temporaries);
+		++this->m_temporaries;
+	}
+
+	this->m_instructions.push_back(instruction);
+	return instruction.destination;
+}
+
+
+/***
+*void CompiledExpression::run() - Runs the bytecode over rows
+*
+*Purpose:
+*       Sets up the register file of a block - the variables point into the
+*       columns, the constants to their single value (with a stride of 0),
+*       and the temporaries to BLOCK_SIZE rows of scratch space each - and
+*       runs every instruction over the whole block before the next one.
+*
+*       The operations expect non-zero denominators (a gcd with 0 is 0, and
+*       would be divided by), so the denominators of the variables are
+*       checked once per block. The results of the operations never have
+*       the denominator 0.
+*
+*Entry:
+*       const int* const*      numerators - The numerators of every variable.
+*       const int* const*    denominators - The denominators of every variable.
+*       std::size_t                 count - The number of rows.
+*       int*             resultNumerators - Would hold the numerators.
+*       int*           resultDenominators - Would hold the denominators.
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If a value doesn't fit in a Fraction.
+*       DivisionByZeroException()  - If a value is divided by 0, or a
+*                                    variable has the denominator 0.
+*
+*******************************************************************************/
+void CompiledExpression::run(const int* const* numerators, const int* const* denominators, std::size_t count,
+	int* resultNumerators, int* resultDenominators) const
+{
+	std::size_t variables = this->m_variables.size();
+	std::size_t constants = this->m_constant_numerators.size();
+	std::size_t first_temporary = variables + constants;
+
+	std::vector<int> scratch(2 * BLOCK_SIZE * this->m_temporaries);
+	std::vector<BlockOperand> registers(first_temporary + this->m_temporaries);
+
+	for (std::size_t i = 0; i < constants; ++i) {
+		BlockOperand constant = { &this->m_constant_numerators[i], &this->m_constant_denominators[i], 0 };
+		registers[variables + i] = constant;
+	}
+	for (std::size_t i = 0; i < this->m_temporaries; ++i) {
+		BlockOperand temporary = { &scratch[2 * i * BLOCK_SIZE], &scratch[(2 * i + 1) * BLOCK_SIZE], 1 };
+		registers[first_temporary + i] = temporary;
+	}
+
+	for (std::size_t block = 0; block < count; block += BLOCK_SIZE) {
+		std::size_t block_size = std::min(BLOCK_SIZE, count - block);
+
+		for (std::size_t i = 0; i < variables; ++i) {
+			if (hasZeroDenominator(denominators[i] + block, block_size))
+				throw DivisionByZeroException();
+
+			BlockOperand variable = { numerators[i] + block, denominators[i] + block, 1 };
+			registers[i] = variable;
+		}
+
+		for (std::size_t i = 0; i < this->m_instructions.size(); ++i) {
+			const Instruction& instruction = this->m_instructions[i];
+			const BlockOperand& left = registers[instruction.left];
+			const BlockOperand& right = registers[instruction.right];
+
+			std::size_t temporary = instruction.destination - first_temporary;
+			int* result_numerators = &scratch[2 * temporary * BLOCK_SIZE];
+			int* result_denominators = &scratch[(2 * temporary + 1) * BLOCK_SIZE];
+
+			switch (instruction.op) {
+			case OpCode::Add:
+				applyBinary(left, right, result_numerators, result_denominators, block_size,
+					[](long long a, long long b, long long c, long long d, int& n, int& m) {
+						addValues(a, b, c, d, n, m);
+					});
+				break;
+			case OpCode::Subtract:
+				applyBinary(left, right, result_numerators, result_denominators, block_size,
+					[](long long a, long long b, long long c, long long d, int& n, int& m) {
+						addValues(a, b, -c, d, n, m);
+					});
+				break;
+			case OpCode::Multiply:
+				applyBinary(left, right, result_numerators, result_denominators, block_size,
+					[](long long a, long long b, long long c, long long d, int& n, int& m) {
+						multiplyValues(a, b, c, d, n, m);
+					});
+				break;
+			case OpCode::Divide:
+				applyBinary(left, right, result_numerators, result_denominators, block_size,
+					[](long long a, long long b, long long c, long long d, int& n, int& m) {
+						if (0 == c)
+							throw DivisionByZeroException();
+						multiplyValues(a, b, d, c, n, m);
+					});
+				break;
+			case OpCode::Negate:
+				for (std::size_t row = 0; row < block_size; ++row) {
+					store(-(long long)left.numerators[row * left.stride], left.denominators[row * left.stride],
+						result_numerators[row], result_denominators[row]);
+				}
+				break;
+			}
+		}
+
+		const BlockOperand& value = registers[this->m_result];
+		for (std::size_t row = 0; row < block_size; ++row) {
+			resultNumerators[block + row] = value.numerators[row * value.stride];
+			resultDenominators[block + row] = value.denominators[row * value.stride];
+		}
+	}
+}
+
+} //namespace fraction {
@@ -0,0 +1,190 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the CompiledExpression class
+*/
+
+
+#ifndef COMPILEDEXPRESSION_HPP_
+#define COMPILEDEXPRESSION_HPP_
+
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint16_t, std::uint8_t
+#include <string>
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents a rational formula - e.g. "(x + 1/3) * y / (z - 2)" -
+compiled once into a compact bytecode, and then evaluated over many bindings
+of its variables.
+
+The formula has the operators + - * / (and unary + and -), parentheses,
+variables (a letter or '_', followed by letters, digits and '_'s) and
+literals: integers and decimals in the format parseDecimal() accepts (e.g.
+"0.25" or "0.(3)"). A fraction literal is written as a division ("1/3"), and
+is folded into a constant.
+
+Compiling:
+- Every subexpression with no variables is computed (and reduced) at compile
+  time, as are additions of 0 and multiplications and divisions by 1.
+- The rest is compiled into three-address instructions over one register
+  file, which holds the variables (in the order they first appear in the
+  formula), then the constants, and then the temporaries - so an instruction
+  reads its operands directly, with no loads.
+
+Evaluating:
+The batch evaluate() runs the bytecode over whole columns - instruction by
+instruction over blocks of rows, so the dispatch of an instruction is paid
+once per block rather than once per row, and the inner loops are plain loops
+over 'int' columns. Every operation is done in 'long long's with the cross
+reduction of Fraction's operators (and with no gcd at all when both operands
+are integers), with a single overflow check on its result.
+
+The results are exact: if an intermediate or final value doesn't fit in a
+Fraction, NumericOverflowException() is thrown (with or without the overflow
+protection - there is none to turn off), and a division by 0 throws
+DivisionByZeroException(), as does a value with the denominator 0 (which an
+unprotected Fraction may hold).
+*/
+class CompiledExpression
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	Compiles 'formula'.
+	If it's not a valid formula, it throws std::invalid_argument with the
+	position of the error. If a literal or a folded constant doesn't fit in a
+	Fraction, it throws NumericOverflowException(), and if a constant is
+	divided by 0, it throws DivisionByZeroException().
+	*/
+	explicit CompiledExpression(const std::string& formula);
+
+
+	//-- public methods --//
+
+	//Returns the names of the variables, in the order evaluate() expects them.
+	const std::vector<std::string>& getVariables() const {
+		return this->m_variables;
+	}
+
+	//Returns the index of the variable 'name' in getVariables().
+	//If there is no such variable, it throws std::invalid_argument.
+	std::size_t variableIndex(const std::string& name) const;
+
+	//Returns 'true' if the formula has no variables (it was folded entirely).
+	bool isConstant() const {
+		return this->m_variables.empty();
+	}
+
+	//Returns the number of instructions (0 if the formula is a single variable
+	//or constant).
+	std::size_t getInstructionCount() const {
+		return this->m_instructions.size();
+	}
+
+	/*
+	Evaluates the formula with the variables set to 'values' (in the order of
+	getVariables()).
+	If the number of values is not the number of variables, it throws
+	std::invalid_argument.
+	*/
+	Fraction evaluate(const std::vector<Fraction>& values) const;
+
+	/*
+	Sets result[i] to the formula evaluated with every variable set to the i-th
+	value of its column. 'columns' holds a column per variable (in the order of
+	getVariables()), and all of them must have the same size, or
+	std::invalid_argument is thrown.
+
+	'result' is resized to the size of the columns, and may be one of them. For
+	a formula with no variables, it's left with a single value.
+	The rows are evaluated in parallel chunks on 'threads' threads (0 means the
+	number of hardware threads). If an evaluation throws, the content of
+	'result' is undefined.
+	*/
+	void evaluate(const std::vector<const FractionColumns*>& columns, FractionColumns& result,
+		unsigned threads = 0) const;
+
+private:
+	//-- private types --//
+
+	//The operation of an instruction.
+	enum class OpCode : std::uint8_t {
+		Add,       //destination = left + right
+		Subtract,  //destination = left - right
+		Multiply,  //destination = left * right
+		Divide,    //destination = left / right
+		Negate     //destination = -left
+	};
+
+	//An instruction: registers are indices into the register file.
+	struct Instruction {
+		OpCode op;
+		std::uint16_t destination;
+		std::uint16_t left;
+		std::uint16_t right;
+	};
+
+	//A node of the syntax tree of the formula (see the .cpp file).
+	struct Node;
+
+	//Parses the formula into a syntax tree, folding the constants.
+	class Parser;
+
+
+	//-- private data members --//
+
+	//The names of the variables (the first registers)
+	std::vector<std::string> m_variables;
+
+	//The constants, reduced (the registers that follow the variables)
+	std::vector<int> m_constant_numerators;
+	std::vector<int> m_constant_denominators;
+
+	//The instructions
+	std::vector<Instruction> m_instructions;
+
+	//The number of temporaries (the registers that follow the constants)
+	std::size_t m_temporaries;
+
+	//The register that holds the value of the formula
+	std::uint16_t m_result;
+
+
+	//-- private methods --//
+
+	//Adds the constants of the subtree at 'index' to the constants (once each).
+	void collectConstants(const std::vector<Node>& nodes, std::size_t index);
+
+	/*
+	Emits the instructions that compute the subtree at 'index', and returns the
+	register of its value. 'freeTemporaries' holds the temporaries that are
+	not in use (temporaries are reused once their value was read).
+	*/
+	std::uint16_t emit(const std::vector<Node>& nodes, std::size_t index,
+		std::vector<std::uint16_t>& freeTemporaries);
+
+	/*
+	Evaluates the rows [0, count) of the variables whose columns are given in
+	'numerators' and 'denominators', in blocks, and stores the results in
+	'resultNumerators' and 'resultDenominators'.
+	*/
+	void run(const int* const* numerators, const int* const* denominators, std::size_t count,
+		int* resultNumerators, int* resultDenominators) const;
+
+}; //class CompiledExpression {
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,73 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of CompiledExpression.
+*
+* It evaluates "(x + 1/3) * y / (z - 2)" over the same random columns with the
+* compiled bytecode (on a single thread) and with the same formula written by
+* hand with Fraction's operators, and prints the time per row of each.
+*/
+
+#include "Benchmark.hpp"
+#include "CompiledExpression.hpp"
+#include "DivisionByZeroException.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of rows.
+static const std::size_t ROWS = 1 << 21;
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> numerator_distribution(-1000, 1000);
+	std::uniform_int_distribution<int> denominator_distribution(1, 100);
+
+	fraction::FractionColumns x, y, z;
+	for (std::size_t i = 0; i < ROWS; ++i) {
+		x.pushBack(fraction::Fraction(numerator_distribution(generator), denominator_distribution(generator)));
+		y.pushBack(fraction::Fraction(numerator_distribution(generator), denominator_distribution(generator)));
+		z.pushBack(fraction::Fraction(2 * numerator_distribution(generator) + 1, 3)); //never 2
+	}
+
+	fraction::CompiledExpression expression("(x + 1/3) * y / (z - 2)");
+	fraction::FractionColumns compiled_result;
+	std::vector<fraction::Fraction> manual_result(ROWS);
+
+	double compiled = Benchmark::measure(ROWS, [&]() {
+		expression.evaluate({ &x, &y, &z }, compiled_result, 1);
+	});
+
+	double manual = Benchmark::measure(ROWS, [&]() {
+		const fraction::Fraction third(1, 3);
+		for (std::size_t i = 0; i < ROWS; ++i)
+			manual_result[i] = (x.at(i, true) + third) * y.at(i, true) / (z.at(i, true) - 2);
+	});
+
+	for (std::size_t i = 0; i < ROWS; ++i) {
+		if (!(compiled_result.at(i) == manual_result[i])) {
+			std::cout << "results differ!" << std::endl;
+			return 1;
+		}
+	}
+
+	//A zero denominator in a column must throw, as it does in Fraction.
+	y.denominators()[ROWS / 2] = 0;
+	try {
+		expression.evaluate({ &x, &y, &z }, compiled_result, 1);
+		std::cout << "a zero denominator wasn't detected!" << std::endl;
+		return 1;
+	}
+	catch (const DivisionByZeroException&) {
+	}
+	y.denominators()[ROWS / 2] = 1;
+
+	std::cout << "compiled:    " << compiled << " ns/row (" << expression.getInstructionCount()
+		<< " instructions)" << std::endl;
+	std::cout << "hand-written: " << manual << " ns/row" << std::endl;
+}
@@ -0,0 +1,774 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the ContinuedFraction class
+*/
+
+
+#include "ContinuedFraction.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include <algorithm> //for std::max
+#include <climits> //for LLONG_MIN, LLONG_MAX
+#include <cmath> //for std::sqrt, std::fabs, std::isinf
+#include <limits> //for std::numeric_limits
+#include <stdexcept> //for std::invalid_argument
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//The coefficients of Gosper's algorithm are divided by their gcd once one of
+//them grows past this number of bits.
+static const int REDUCE_THRESHOLD = 64;
+
+
+//Returns floor(numerator/denominator) (the denominator isn't 0).
+static int128 floorDivide(int128 numerator, int128 denominator) {
+	int128 quotient = numerator / denominator;
+	if ((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0)))
+		--quotient;
+	return quotient;
+}
+
+
+//Returns 'value' as a term, or throws NumericOverflowException() if it
+//doesn't fit in a 'long long'.
+static long long toTerm(int128 value) {
+	if (value < LLONG_MIN || value > LLONG_MAX)
+		throw NumericOverflowException();
+	return (long long)value;
+}
+
+
+/*
+The source of the terms of a number. next() is called only until it returns
+'false'.
+*/
+class ContinuedFraction::Source
+{
+public:
+	virtual ~Source() { }
+
+	//Stores the next term in 'term' and returns 'true', or returns 'false' if
+	//there are no more terms.
+	virtual bool next(long long& term) = 0;
+};
+
+
+namespace {
+
+//The terms of numerator/denominator, with Euclid's algorithm.
+class RationalSource : public ContinuedFraction::Source
+{
+public:
+	//The denominator is positive.
+	RationalSource(int128 numerator, int128 denominator) :
+		m_numerator(numerator),
+		m_denominator(denominator)
+	{
+	}
+
+	virtual bool next(long long& term) {
+		if (0 == this->m_denominator)
+			return false;
+
+		int128 quotient = floorDivide(this->m_numerator, this->m_denominator);
+		term = toTerm(quotient);
+
+		int128 remainder = this->m_numerator - quotient * this->m_denominator;
+		this->m_numerator = this->m_denominator;
+		this->m_denominator = remainder;
+		return true;
+	}
+
+private:
+	int128 m_numerator;
+	int128 m_denominator;
+};
+
+
+//The terms of a TermGenerator.
+class GeneratorSource : public ContinuedFraction::Source
+{
+public:
+	explicit GeneratorSource(const ContinuedFraction::TermGenerator& generator) :
+		m_generator(generator)
+	{
+	}
+
+	virtual bool next(long long& term) {
+		return this->m_generator(term);
+	}
+
+private:
+	ContinuedFraction::TermGenerator m_generator;
+};
+
+
+/*
+The terms of the square root of a (non-square) number n, with the usual
+recurrence: the remainder after every term is (sqrt(n) + m) / d, whose term is
+(floor(sqrt(n)) + m) / d.
+*/
+class SquareRootSource : public ContinuedFraction::Source
+{
+public:
+	SquareRootSource(long long number, long long root) :
+		m_number(number),
+		m_root(root),
+		m_m(0),
+		m_d(1),
+		m_term(root)
+	{
+	}
+
+	virtual bool next(long long& term) {
+		term = (long long)this->m_term;
+
+		this->m_m = this->m_d * this->m_term - this->m_m;
+		this->m_d = (this->m_number - this->m_m * this->m_m) / this->m_d;
+		this->m_term = (this->m_root + this->m_m) / this->m_d;
+		return true;
+	}
+
+private:
+	int128 m_number;
+	int128 m_root;
+	int128 m_m;
+	int128 m_d;
+	int128 m_term;
+};
+
+
+//The terms of e: 2, and then 1, 2k, 1 for k = 1, 2, ...
+class ESource : public ContinuedFraction::Source
+{
+public:
+	ESource() :
+		m_index(0)
+	{
+	}
+
+	virtual bool next(long long& term) {
+		if (0 == this->m_index)
+			term = 2;
+		else if (2 == this->m_index % 3)
+			term = 2 * (long long)((this->m_index + 1) / 3);
+		else
+			term = 1;
+
+		++this->m_index;
+		return true;
+	}
+
+private:
+	std::size_t m_index;
+};
+
+
+//Returns numerator/denominator as a double (which is enough to choose the
+//operand to read), with an infinite value for a denominator of 0.
+static double ratio(int128 numerator, int128 denominator) {
+	if (0 == denominator)
+		return std::numeric_limits<double>::infinity();
+	return (double)numerator / (double)denominator;
+}
+
+
+//Returns how far apart two ratios are (infinitely, if one is infinite).
+static double spread(double ratio1, double ratio2) {
+	if (std::isinf(ratio1) || std::isinf(ratio2))
+		return std::numeric_limits<double>::infinity();
+	return std::fabs(ratio1 - ratio2);
+}
+
+
+/*
+The terms of (a*x*y + b*x + c*y + d) / (e*x*y + f*x + g*y + h), with Gosper's
+algorithm (see next()).
+*/
+class GosperSource : public ContinuedFraction::Source
+{
+public:
+	GosperSource(const ContinuedFraction& x, const ContinuedFraction& y, const int (&coefficients)[8]) :
+		m_x(x),
+		m_y(y),
+		m_x_index(0),
+		m_y_index(0),
+		m_x_done(false),
+		m_y_done(false),
+		m_started(false)
+	{
+		for (int i = 0; i < 8; ++i)
+			this->m_coefficients[i] = coefficients[i];
+	}
+
+	virtual bool next(long long& term);
+
+private:
+	//The operands
+	ContinuedFraction m_x;
+	ContinuedFraction m_y;
+
+	//The indices of the next terms of the operands
+	std::size_t m_x_index;
+	std::size_t m_y_index;
+
+	//Whether all the terms of the operands were read
+	bool m_x_done;
+	bool m_y_done;
+
+	//Whether a term was produced
+	bool m_started;
+
+	//a, b, c, d (the numerator) and e, f, g, h (the denominator)
+	int128 m_coefficients[8];
+
+
+	//Feeds the next term of x (or its end) into the coefficients.
+	void ingestX();
+
+	//Feeds the next term of y (or its end) into the coefficients.
+	void ingestY();
+
+	//Divides the coefficients by their gcd if they grew large.
+	void limit();
+};
+
+
+/***
+*bool GosperSource::next() - Produces the next term of the result
+*
+*Purpose:
+*       With x and y past their first terms, both are in [1, inf] - so while
+*       the denominators at the four corners x, y in {0, inf} (e, f, g and h)
+*       have the same sign, the result is between the four ratios a/e, b/f,
+*       c/g and d/h. If their floors are the same, that's the next term r, and
+*       the function is replaced by 1/(itself - r):
+*
+*           e*x*y + f*x + g*y + h
+*           ----------------------------------------------------
+*           (a-r*e)*x*y + (b-r*f)*x + (c-r*g)*y + (d-r*h)
+*
+*       Otherwise, the next term of one of the operands is read - of the one
+*       whose corners are further apart - and fed into the coefficients. Once
+*       an operand ended, its terms in the coefficients are gone, and only the
+*       ratios of the remaining corners are considered.
+*
+*       If the remaining denominators are all 0 the result is infinite: that's
+*       the end of the expansion (or a division by 0, if it's the first term).
+*
+*Entry:
+*       long long& term - Would hold the next term.
+*
+*Exit:
+*       bool - 'false' if there are no more terms.
+*
+*Exceptions:
+*       DivisionByZeroException() - If the result is infinite.
+*       NumericOverflowException() - If a term or a coefficient doesn't fit.
+*
+*******************************************************************************/
+bool GosperSource::next(long long& term) {
+	int128* k = this->m_coefficients;
+
+	if (0 == this->m_x_index)
+		this->ingestX();
+	if (0 == this->m_y_index)
+		this->ingestY();
+
+	while (true) {
+
+		//The corners that still matter, as indices of their numerators (their
+		//denominators are 4 further).
+		int corners[4];
+		int count = 0;
+		for (int i = 0; i < 4; ++i) {
+			bool with_x = (i < 2);
+			bool with_y = (0 == i % 2);
+			if ((!with_x || !this->m_x_done) && (!with_y || !this->m_y_done))
+				corners[count++] = i;
+		}
+
+		bool infinite = true, determined = true;
+		for (int i = 0; i < count; ++i) {
+			int128 denominator = k[corners[i] + 4];
+			if (0 != denominator)
+				infinite = false;
+			if (0 == denominator || ((denominator < 0) != (k[corners[0] + 4] < 0)))
+				determined = false;
+		}
+
+		if (infinite) {
+			if (!this->m_started)
+				throw DivisionByZeroException();
+			return false;
+		}
+
+		if (determined) {
+			//floor(n/d) = r iff n - r*d is between 0 and d (without d), which
+			//saves the 128-bit divisions of the other corners.
+			int128 floor = floorDivide(k[corners[0]], k[corners[0] + 4]);
+			for (int i = 1; i < count && determined; ++i) {
+				int128 denominator = k[corners[i] + 4], product, remainder;
+				determined = !__builtin_mul_overflow(floor, denominator, &product) &&
+					!__builtin_sub_overflow(k[corners[i]], product, &remainder) &&
+					((denominator > 0) ? (remainder >= 0 && remainder < denominator) :
+						(remainder <= 0 && remainder > denominator));
+			}
+
+			if (determined) {
+				term = toTerm(floor);
+				for (int i = 0; i < 4; ++i) {
+					int128 remainder = WideArithmetics::add(k[i],
+						WideArithmetics::multiply(-floor, k[i + 4]));
+					k[i] = k[i + 4];
+					k[i + 4] = remainder;
+				}
+				this->m_started = true;
+				return true;
+			}
+		}
+
+		if (this->m_x_done)
+			this->ingestY();
+		else if (this->m_y_done)
+			this->ingestX();
+		else {
+			//How much the result changes with x, and with y.
+			double ratios[4];
+			for (int i = 0; i < 4; ++i)
+				ratios[i] = ratio(k[i], k[i + 4]);
+
+			double x_spread = std::max(spread(ratios[0], ratios[2]), spread(ratios[1], ratios[3]));
+			double y_spread = std::max(spread(ratios[0], ratios[1]), spread(ratios[2], ratios[3]));
+
+			if (x_spread > y_spread || (!(y_spread > x_spread) && this->m_x_index <= this->m_y_index))
+				this->ingestX();
+			else
+				this->ingestY();
+		}
+	}
+}
+
+
+//x = p + 1/x' turns (a, b, c, d) into (a*p + c, b*p + d, a, b) (and the same
+//for the denominator), and the end of x (x' = inf) into (0, 0, a, b).
+void GosperSource::ingestX() {
+	int128* k = this->m_coefficients;
+	long long p;
+
+	if (this->m_x_done || !this->m_x.term(this->m_x_index, p)) {
+		for (int i = 0; i < 8; i += 4) {
+			k[i + 2] = k[i];
+			k[i + 3] = k[i + 1];
+			k[i] = k[i + 1] = 0;
+		}
+		this->m_x_done = true;
+		return;
+	}
+
+	++this->m_x_index;
+	for (int i = 0; i < 8; i += 4) {
+		int128 a = WideArithmetics::add(WideArithmetics::multiply(k[i], p), k[i + 2]);
+		int128 b = WideArithmetics::add(WideArithmetics::multiply(k[i + 1], p), k[i + 3]);
+		k[i + 2] = k[i];
+		k[i + 3] = k[i + 1];
+		k[i] = a;
+		k[i + 1] = b;
+	}
+	this->limit();
+}
+
+
+//y = q + 1/y' turns (a, b, c, d) into (a*q + b, a, c*q + d, c) (and the same
+//for the denominator), and the end of y (y' = inf) into (0, a, 0, c).
+void GosperSource::ingestY() {
+	int128* k = this->m_coefficients;
+	long long q;
+
+	if (this->m_y_done || !this->m_y.term(this->m_y_index, q)) {
+		for (int i = 0; i < 8; i += 4) {
+			k[i + 1] = k[i];
+			k[i + 3] = k[i + 2];
+			k[i] = k[i + 2] = 0;
+		}
+		this->m_y_done = true;
+		return;
+	}
+
+	++this->m_y_index;
+	for (int i = 0; i < 8; i += 4) {
+		int128 a = WideArithmetics::add(WideArithmetics::multiply(k[i], q), k[i + 1]);
+		int128 c = WideArithmetics::add(WideArithmetics::multiply(k[i + 2], q), k[i + 3]);
+		k[i + 1] = k[i];
+		k[i + 3] = k[i + 2];
+		k[i] = a;
+		k[i + 2] = c;
+	}
+	this->limit();
+}
+
+
+//The function is the same after dividing all the coefficients by their gcd.
+void GosperSource::limit() {
+	int128* k = this->m_coefficients;
+
+	bool large = false;
+	for (int i = 0; i < 8; ++i)
+		large = large || (WideArithmetics::bitLength(k[i]) > REDUCE_THRESHOLD);
+	if (!large)
+		return;
+
+	int128 gcd = 0;
+	for (int i = 0; i < 8; ++i)
+		gcd = WideArithmetics::gcd(gcd, k[i]);
+	if (gcd > 1) {
+		for (int i = 0; i < 8; ++i)
+			k[i] /= gcd;
+	}
+}
+
+} //namespace {
+
+
+//The expansion of 0 is [0].
+ContinuedFraction::ContinuedFraction() :
+	m_state(new State())
+{
+	this->m_state->terms.push_back(0);
+}
+
+
+//A Fraction is reduced, with a positive denominator.
+ContinuedFraction::ContinuedFraction(const Fraction& frac) :
+	m_state(new State())
+{
+	this->m_state->source.reset(new RationalSource(frac.getNumerator(), frac.getDenominator()));
+}
+
+
+//The sign is moved to the numerator (in 128 bits, so it can't overflow).
+ContinuedFraction::ContinuedFraction(long long numerator, long long denominator) :
+	m_state(new State())
+{
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	int128 wide_numerator = numerator, wide_denominator = denominator;
+	if (wide_denominator < 0) {
+		wide_numerator = -wide_numerator;
+		wide_denominator = -wide_denominator;
+	}
+	this->m_state->source.reset(new RationalSource(wide_numerator, wide_denominator));
+}
+
+
+//The generator is copied into the state.
+ContinuedFraction::ContinuedFraction(const TermGenerator& generator) :
+	m_state(new State())
+{
+	this->m_state->source.reset(new GeneratorSource(generator));
+}
+
+
+//Takes the ownership of 'source'.
+ContinuedFraction::ContinuedFraction(Source* source) :
+	m_state(new State())
+{
+	this->m_state->source.reset(source);
+}
+
+
+//The root is computed in floating point and then corrected.
+ContinuedFraction ContinuedFraction::squareRoot(long long number) {
+	if (number < 0)
+		throw std::invalid_argument("ContinuedFraction::squareRoot(): The number is negative");
+
+	int128 root = (int128)std::sqrt((long double)number);
+	while (root * root > number)
+		--root;
+	while ((root + 1) * (root + 1) <= number)
+		++root;
+
+	if (root * root == number)
+		return ContinuedFraction((long long)root, 1);
+	return ContinuedFraction(new SquareRootSource(number, (long long)root));
+}
+
+
+//The terms follow a simple pattern.
+ContinuedFraction ContinuedFraction::e() {
+	return ContinuedFraction(new ESource());
+}
+
+
+/***
+*bool ContinuedFraction::fetch() - Reads the terms up to a given index
+*
+*Purpose:
+*       Reads terms from the source (and memoizes them) until the term of
+*       index 'index' is memoized, or the source ends - in which case it's
+*       dropped.
+*
+*Entry:
+*       std::size_t index - The index of the term.
+*
+*Exit:
+*       bool - 'true' if the term of index 'index' exists.
+*
+*Exceptions:
+*       std::invalid_argument - If a term after the first isn't positive.
+*       The exceptions of the source propagate as they are.
+*
+*******************************************************************************/
+bool ContinuedFraction::fetch(std::size_t index) const {
+	State& state = *this->m_state;
+
+	while (state.terms.size() <= index && state.source) {
+		long long value;
+		if (!state.source->next(value)) {
+			state.source.reset();
+			break;
+		}
+
+		if (!state.terms.empty() && value <= 0)
+			throw std::invalid_argument("ContinuedFraction::term(): A term after the first isn't positive");
+		state.terms.push_back(value);
+	}
+
+	return index < state.terms.size();
+}
+
+
+//Reads the terms up to 'index' if they weren't read yet.
+bool ContinuedFraction::term(std::size_t index, long long& value) const {
+	if (!this->fetch(index))
+		return false;
+
+	value = this->m_state->terms[index];
+	return true;
+}
+
+
+//Stops at the end of the expansion.
+std::vector<long long> ContinuedFraction::terms(std::size_t count) const {
+	std::vector<long long> result;
+	long long value;
+
+	for (std::size_t i = 0; i < count && this->term(i, value); ++i)
+		result.push_back(value);
+
+	return result;
+}
+
+
+//The convergents follow h(n) = a(n)*h(n-1) + h(n-2) (and the same for the
+//denominators k(n)), and are reduced.
+WideFraction ContinuedFraction::convergent(std::size_t index) const {
+	int128 h = 1, previous_h = 0;
+	int128 k = 0, previous_k = 1;
+	long long value;
+
+	for (std::size_t i = 0; i <= index && this->term(i, value); ++i) {
+		int128 next_h = WideArithmetics::add(WideArithmetics::multiply(value, h), previous_h);
+		int128 next_k = WideArithmetics::add(WideArithmetics::multiply(value, k), previous_k);
+		previous_h = h;
+		previous_k = k;
+		h = next_h;
+		k = next_k;
+	}
+
+	WideFraction result = { h, k };
+	return result;
+}
+
+
+/***
+*Fraction ContinuedFraction::approximate() - Returns the best approximation with
+*                                            a bounded denominator
+*
+*Purpose:
+*       Computes the convergents h(n)/k(n) until the next denominator exceeds
+*       the bound (or the expansion ends, and the last convergent is the exact
+*       value). The best approximation is then either the last convergent
+*       p/q = h(n)/k(n), or the semiconvergent
+*
+*           t*h(n) + h(n-1)
+*           ---------------    with the largest t for which the denominator
+*           t*k(n) + k(n-1)    is within the bound
+*
+*       (if t >= 1), which lies on the other side of the number. Whichever is
+*       on the same side of their midpoint as the number is the closer one (and
+*       if the number is the midpoint, the convergent, whose denominator is
+*       smaller). Comparing the number with the midpoint reads its terms only
+*       until they differ from the midpoint's.
+*
+*Entry:
+*       int maxDenominator - The bound of the denominator.
+*
+*Exit:
+*       Fraction - The best approximation.
+*
+*Exceptions:
+*       std::invalid_argument - If 'maxDenominator' isn't positive.
+*       NumericOverflowException() - If the approximation doesn't fit in a
+*                                    Fraction.
+*
+*******************************************************************************/
+Fraction ContinuedFraction::approximate(int maxDenominator) const {
+	if (maxDenominator < 1)
+		throw std::invalid_argument("ContinuedFraction::approximate(): The maximal denominator isn't positive");
+
+	int128 h = 1, previous_h = 0;
+	int128 k = 0, previous_k = 1;
+	long long value;
+
+	for (std::size_t i = 0; this->term(i, value); ++i) {
+		int128 next_k = WideArithmetics::add(WideArithmetics::multiply(value, k), previous_k);
+
+		//k(0) = 1, so the bound is exceeded only after the first term.
+		if (next_k > maxDenominator) {
+			int128 t = (maxDenominator - previous_k) / k;
+			if (t < 1)
+				break;
+
+			int128 semi_h = WideArithmetics::add(WideArithmetics::multiply(t, h), previous_h);
+			int128 semi_k = t * k + previous_k;
+
+			//The midpoint (h/k + semi_h/semi_k) / 2
+			int128 middle_numerator = WideArithmetics::add(WideArithmetics::multiply(h, semi_k),
+				WideArithmetics::multiply(semi_h, k));
+			int128 middle_denominator = WideArithmetics::multiply(2 * k, semi_k);
+
+			int side = this->compare(middle_numerator, middle_denominator);
+			int semi_side = (semi_h * k > h * semi_k) ? 1 : -1;
+			if (side == semi_side) {
+				h = semi_h;
+				k = semi_k;
+			}
+			break;
+		}
+
+		int128 next_h = WideArithmetics::add(WideArithmetics::multiply(value, h), previous_h);
+		previous_h = h;
+		previous_k = k;
+		h = next_h;
+		k = next_k;
+	}
+
+	if (!WideArithmetics::fitsInt(h))
+		throw NumericOverflowException();
+	return Fraction((int)h, (int)k);
+}
+
+
+/***
+*int ContinuedFraction::compare() - Compares the number with a fraction
+*
+*Purpose:
+*       Compares the terms of the number with the terms of the fraction (which
+*       are computed with Euclid's algorithm) until they differ. A larger term
+*       at an even index means a larger number, and at an odd index a smaller
+*       one - and an expansion that ended is like a term of inf at that index.
+*
+*Entry:
+*       int128   numerator - The numerator of the fraction.
+*       int128 denominator - The (positive) denominator of the fraction.
+*
+*Exit:
+*       int - The sign of the number minus the fraction.
+*
+*Exceptions:
+*
+*******************************************************************************/
+int ContinuedFraction::compare(int128 numerator, int128 denominator) const {
+	RationalSource other(numerator, denominator);
+	long long value, other_value;
+
+	for (std::size_t i = 0; ; ++i) {
+		bool has_value = this->term(i, value);
+		bool has_other = other.next(other_value);
+
+		int sign;
+		if (!has_value && !has_other)
+			return 0;
+		else if (!has_value)
+			sign = 1;
+		else if (!has_other)
+			sign = -1;
+		else if (value != other_value)
+			sign = (value > other_value) ? 1 : -1;
+		else
+			continue;
+
+		return (0 == i % 2) ? sign : -sign;
+	}
+}
+
+
+//The terms are separated by ", ", and the first by "; ".
+std::string ContinuedFraction::toString(std::size_t count) const {
+	std::string result = "[";
+	long long value;
+
+	for (std::size_t i = 0; i < count && this->term(i, value); ++i) {
+		if (i > 0)
+			result += (1 == i) ? "; " : ", ";
+		result += std::to_string(value);
+	}
+
+	if (this->fetch(count))
+		result += (count > 1) ? ", ..." : (1 == count) ? "; ..." : "...";
+	return result + "]";
+}
+
+
+//Creates a GosperSource over the operands.
+ContinuedFraction ContinuedFraction::combine(const ContinuedFraction& x, const ContinuedFraction& y,
+	const int (&coefficients)[8])
+{
+	return ContinuedFraction(new GosperSource(x, y, coefficients));
+}
+
+
+//x + y = (x + y) / 1
+ContinuedFraction operator+ (const ContinuedFraction& lhs, const ContinuedFraction& rhs) {
+	static const int coefficients[8] = { 0, 1, 1, 0, 0, 0, 0, 1 };
+	return ContinuedFraction::combine(lhs, rhs, coefficients);
+}
+
+
+//x - y = (x - y) / 1
+ContinuedFraction operator- (const ContinuedFraction& lhs, const ContinuedFraction& rhs) {
+	static const int coefficients[8] = { 0, 1, -1, 0, 0, 0, 0, 1 };
+	return ContinuedFraction::combine(lhs, rhs, coefficients);
+}
+
+
+//x * y = x*y / 1
+ContinuedFraction operator* (const ContinuedFraction& lhs, const ContinuedFraction& rhs) {
+	static const int coefficients[8] = { 1, 0, 0, 0, 0, 0, 0, 1 };
+	return ContinuedFraction::combine(lhs, rhs, coefficients);
+}
+
+
+//x / y = x / y
+ContinuedFraction operator/ (const ContinuedFraction& lhs, const ContinuedFraction& rhs) {
+	static const int coefficients[8] = { 0, 1, 0, 0, 0, 0, 1, 0 };
+	return ContinuedFraction::combine(lhs, rhs, coefficients);
+}
+
+
+//-x = 0 - x
+ContinuedFraction operator- (const ContinuedFraction& frac) {
+	return ContinuedFraction() - frac;
+}
+
+} //namespace fraction {
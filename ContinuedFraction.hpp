@@ -0,0 +1,193 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the ContinuedFraction class
+*/
+
+
+#ifndef CONTINUEDFRACTION_HPP_
+#define CONTINUEDFRACTION_HPP_
+
+#include "Fraction.hpp"
+#include "WideFraction.hpp"
+#include <cstddef> //for std::size_t
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents a real number as a (simple) continued fraction
+
+    a0 + 1/(a1 + 1/(a2 + ...))  =  [a0; a1, a2, ...]
+
+whose terms are produced on demand - so a number may have infinitely many of
+them (e.g. squareRoot(2) = [1; 2, 2, 2, ...]), and a computation costs only as
+many terms as are actually read.
+
+The arithmetic operators don't compute anything: they return a number whose
+terms are produced with Gosper's algorithm - the result is kept as a
+bihomographic function of the operands
+
+    a*x*y + b*x + c*y + d
+    ---------------------
+    e*x*y + f*x + g*y + h
+
+and a term of the operands is fed into its coefficients only when the next
+term of the result can't be determined from the ones read so far. So when only
+the first few terms (or a bounded-denominator approximation, see approximate())
+of a result are needed, its exact value - whose numerator and denominator may be
+huge - is never computed.
+
+The terms are memoized, and copies of a number share them, so a number can be
+an operand of several others (or read again) without computing its terms
+twice. For the same reason, a number (and the numbers computed from it) mustn't
+be used from several threads at once.
+
+The terms after the first are positive. A finite expansion ends with a term
+that's at least 2 (unless it's the only one), so every rational number has a
+single expansion.
+
+The terms and the coefficients are bounded: if a term doesn't fit in a
+'long long', or the coefficients of Gosper's algorithm outgrow 128 bits, the
+methods that read the terms throw NumericOverflowException(). The coefficients
+grow about as fast as the denominators of the convergents of the result, so a
+result can be read as long as its convergents fit in about 120 bits (e.g. some
+70 terms of squareRoot(2) * squareRoot(3)) - far more than approximate() needs
+for an 'int' denominator. In particular,
+when the result is rational but the operands aren't (e.g.
+squareRoot(2) * squareRoot(2)), its last term can never be determined from
+finitely many terms of the operands, so reading it eventually throws. A
+division by 0 throws DivisionByZeroException() when the first term is read.
+*/
+class ContinuedFraction
+{
+public:
+	//-- types --//
+
+	//Stores the next term in 'term' and returns 'true', or returns 'false' if
+	//there are no more terms.
+	typedef std::function<bool(long long& term)> TermGenerator;
+
+	//Produces the terms of a number, one after the other (the sources are
+	//defined in ContinuedFraction.cpp).
+	class Source;
+
+
+	//-- constructors/destructor --//
+
+	//Creates 0.
+	ContinuedFraction();
+
+	//Creates the (finite) expansion of 'frac'.
+	ContinuedFraction(const Fraction& frac);
+
+	/*
+	Creates the (finite) expansion of numerator/denominator.
+	If the denominator is 0, it throws DivisionByZeroException().
+	*/
+	ContinuedFraction(long long numerator, long long denominator);
+
+	/*
+	Creates a number whose terms are produced by 'generator' (which is called
+	only when a term that wasn't produced yet is read).
+	If it produces a term after the first that isn't positive, reading that
+	term throws std::invalid_argument.
+	*/
+	explicit ContinuedFraction(const TermGenerator& generator);
+
+	/*
+	Returns the square root of 'number' (whose expansion is periodic, or a
+	single term if it's a perfect square).
+	If 'number' is negative, it throws std::invalid_argument.
+	*/
+	static ContinuedFraction squareRoot(long long number);
+
+	//Returns e = [2; 1, 2, 1, 1, 4, 1, 1, 6, ...].
+	static ContinuedFraction e();
+
+
+	//-- public methods --//
+
+	//Stores the term of index 'index' in 'value' and returns 'true', or
+	//returns 'false' if the expansion has fewer terms.
+	bool term(std::size_t index, long long& value) const;
+
+	//Returns the first 'count' terms (or all of them, if there are fewer).
+	std::vector<long long> terms(std::size_t count) const;
+
+	//Returns the convergent [a0; a1, ..., a_index] (or the exact value, if the
+	//expansion has fewer terms).
+	WideFraction convergent(std::size_t index) const;
+
+	/*
+	Returns the closest fraction to the number whose denominator is at most
+	'maxDenominator' (the one with the smaller denominator, if two are as
+	close) - a convergent or a semiconvergent of the expansion, which is found
+	by reading the terms only until their denominators exceed the bound.
+	If 'maxDenominator' isn't positive, it throws std::invalid_argument. If
+	the fraction doesn't fit in a Fraction, it throws
+	NumericOverflowException().
+	*/
+	Fraction approximate(int maxDenominator) const;
+
+	//Returns the first 'count' terms as "[a0; a1, a2, ...]" (with a trailing
+	//"..." if there are more).
+	std::string toString(std::size_t count) const;
+
+
+	//-- friend functions --//
+
+	friend ContinuedFraction operator+ (const ContinuedFraction& lhs, const ContinuedFraction& rhs); //lhs+rhs
+	friend ContinuedFraction operator- (const ContinuedFraction& lhs, const ContinuedFraction& rhs); //lhs-rhs
+	friend ContinuedFraction operator* (const ContinuedFraction& lhs, const ContinuedFraction& rhs); //lhs*rhs
+	friend ContinuedFraction operator/ (const ContinuedFraction& lhs, const ContinuedFraction& rhs); //lhs/rhs
+	friend ContinuedFraction operator- (const ContinuedFraction& frac); //-frac
+
+private:
+	//-- types --//
+
+	//The memoized terms, and the source of the rest.
+	struct State {
+		std::vector<long long> terms;
+		std::unique_ptr<Source> source;
+	};
+
+
+	//-- private data members --//
+
+	//The state, which is shared by the copies of the number
+	std::shared_ptr<State> m_state;
+
+
+	//-- private methods --//
+
+	//Creates a number whose terms are produced by 'source' (which it owns).
+	explicit ContinuedFraction(Source* source);
+
+	//Reads terms from the source until the term of index 'index' is
+	//memoized, and returns 'false' if the expansion ended before it.
+	bool fetch(std::size_t index) const;
+
+	/*
+	Returns the bihomographic function of 'x' and 'y' with the coefficients
+	(a, b, c, d, e, f, g, h) (see above), computed with Gosper's algorithm.
+	*/
+	static ContinuedFraction combine(const ContinuedFraction& x, const ContinuedFraction& y,
+		const int (&coefficients)[8]);
+
+	//Returns the sign of the number minus numerator/denominator (whose
+	//denominator is positive).
+	int compare(WideArithmetics::int128 numerator, WideArithmetics::int128 denominator) const;
+
+}; //class ContinuedFraction {
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,91 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of ContinuedFraction's lazy arithmetic.
+*
+* It approximates (x*y + z) / w, over random fractions with large numerators
+* and denominators, by the closest fraction with a denominator of at most a
+* million - with ContinuedFraction's operators and approximate(), and with
+* Fraction's operators with the overflow protection (which compute the exact
+* value first, and so overflow on most of the formulas). It prints the time per formula of each, and how
+* many formulas overflowed a Fraction. It also prints the time of reading the
+* first terms of a formula over irrational numbers.
+*/
+
+#include "Benchmark.hpp"
+#include "ContinuedFraction.hpp"
+#include "NumericException.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of formulas.
+static const std::size_t FORMULAS = 1 << 14;
+
+//The bound of the denominators of the approximations.
+static const int MAX_DENOMINATOR = 1000000;
+
+//The number of terms read of the irrational formula.
+static const std::size_t TERMS = 40;
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> distribution(100000000, 1000000000);
+
+	std::vector<fraction::Fraction> operands;
+	for (std::size_t i = 0; i < 4 * FORMULAS; ++i)
+		operands.push_back(fraction::Fraction(distribution(generator), distribution(generator), true));
+
+	std::vector<fraction::Fraction> lazy_results(FORMULAS);
+	double lazy_time = Benchmark::measure(FORMULAS, [&]() {
+		for (std::size_t i = 0; i < FORMULAS; ++i) {
+			fraction::ContinuedFraction x(operands[4 * i]), y(operands[4 * i + 1]);
+			fraction::ContinuedFraction z(operands[4 * i + 2]), w(operands[4 * i + 3]);
+			lazy_results[i] = ((x * y + z) / w).approximate(MAX_DENOMINATOR);
+		}
+	});
+
+	std::size_t overflows = 0;
+	std::vector<fraction::Fraction> exact_results(FORMULAS);
+	double exact_time = Benchmark::measure(FORMULAS, [&]() {
+		for (std::size_t i = 0; i < FORMULAS; ++i) {
+			try {
+				exact_results[i] = (operands[4 * i] * operands[4 * i + 1] + operands[4 * i + 2]) / operands[4 * i + 3];
+			}
+			catch (NumericException&) {
+				++overflows;
+			}
+		}
+	});
+
+	//Where the exact value fits in a Fraction, it must approximate to the same
+	//fraction.
+	for (std::size_t i = 0; i < FORMULAS; ++i) {
+		if (exact_results[i].getDenominator() > 1 &&
+			!(fraction::ContinuedFraction(exact_results[i]).approximate(MAX_DENOMINATOR) == lazy_results[i]))
+		{
+			std::cout << "approximations differ!" << std::endl;
+			return 1;
+		}
+	}
+
+	fraction::ContinuedFraction irrational = (fraction::ContinuedFraction::squareRoot(2) +
+		fraction::ContinuedFraction::e()) / fraction::ContinuedFraction::squareRoot(3);
+	std::string terms;
+	double irrational_time = Benchmark::measure(TERMS, [&]() {
+		terms = irrational.toString(TERMS);
+	});
+
+	std::cout << "(x*y + z) / w to a denominator <= " << MAX_DENOMINATOR << ":" << std::endl;
+	std::cout << "\tContinuedFraction " << lazy_time << " ns/formula, Fraction " << exact_time << " ns/formula ("
+		<< overflows << " of " << FORMULAS << " overflowed)" << std::endl;
+	std::cout << "(sqrt(2) + e) / sqrt(3) = " << irrational.toString(10) << std::endl;
+	std::cout << "\t" << irrational_time << " ns/term" << std::endl;
+
+	return 0;
+}
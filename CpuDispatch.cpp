@@ -0,0 +1,69 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the CPU feature detection
+*/
+
+#include "CpuDispatch.hpp"
+#include <cstdlib> //for std::getenv()
+#include <cstring> //for std::strcmp()
+
+
+namespace fraction {
+
+
+//The names of the levels, in the order of SimdLevel.
+static const char* const LEVEL_NAMES[SIMD_LEVELS] = { "generic", "sse4.2", "avx2", "avx512" };
+
+
+//__builtin_cpu_supports() also checks that the OS saves the vector registers
+//of the level (so AVX isn't reported on an OS that doesn't support it).
+SimdLevel detectSimdLevel() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+		return SimdLevel::Avx512;
+	if (__builtin_cpu_supports("avx2"))
+		return SimdLevel::Avx2;
+	if (__builtin_cpu_supports("sse4.2"))
+		return SimdLevel::Sse42;
+#endif
+
+	return SimdLevel::Generic;
+}
+
+
+//Applies FRACTION_SIMD_LEVEL to the detected level.
+static SimdLevel selectSimdLevel() {
+	SimdLevel detected = detectSimdLevel();
+
+	const char* requested = std::getenv("FRACTION_SIMD_LEVEL");
+	if (nullptr == requested)
+		return detected;
+
+	for (std::size_t i = 0; i < SIMD_LEVELS; ++i) {
+		if (0 == std::strcmp(requested, LEVEL_NAMES[i]))
+			return ((SimdLevel)i < detected) ? (SimdLevel)i : detected;
+	}
+
+	return detected;
+}
+
+
+//The initialization of a local static is thread safe, so the level is
+//selected exactly once.
+SimdLevel simdLevel() {
+	static const SimdLevel level = selectSimdLevel();
+	return level;
+}
+
+
+//Indexes the names by the level.
+const char* simdLevelName(SimdLevel level) {
+	return LEVEL_NAMES[(std::size_t)level];
+}
+
+} //namespace fraction {
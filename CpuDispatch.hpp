@@ -0,0 +1,57 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the CPU feature detection that
+* selects the SIMD level of the kernels
+*/
+
+
+#ifndef CPUDISPATCH_HPP_
+#define CPUDISPATCH_HPP_
+
+#include <cstddef> //for std::size_t
+
+
+namespace fraction {
+
+
+/*
+The instruction set levels the kernels are compiled for (see SimdKernels.hpp),
+from the oldest to the newest. Every level includes the ones before it.
+*/
+enum class SimdLevel {
+	Generic, //The baseline of the target (SSE2 on x86-64)
+	Sse42,   //SSE4.2 (64-bit comparisons, 32x32->64 bit multiplications)
+	Avx2,    //AVX2 (256-bit vectors)
+	Avx512   //AVX-512 F and BW (512-bit vectors)
+};
+
+//The number of levels.
+static const std::size_t SIMD_LEVELS = 4;
+
+
+/*
+Returns the highest level the CPU (and the OS) supports.
+On targets other than x86, it's always Generic.
+*/
+SimdLevel detectSimdLevel();
+
+/*
+Returns the level the kernels run at: the detected level, unless the
+environment variable FRACTION_SIMD_LEVEL is set to a lower one ("generic",
+"sse4.2", "avx2" or "avx512") - to test or benchmark a level on a newer
+machine. A level the CPU doesn't support is lowered to the detected one
+(running its instructions would crash), and an unknown name is ignored.
+
+It's computed once, on the first call.
+*/
+SimdLevel simdLevel();
+
+//Returns the name of 'level', as FRACTION_SIMD_LEVEL spells it.
+const char* simdLevelName(SimdLevel level);
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,615 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the conversions between fractions and decimal
+* strings.
+*/
+
+
+#include "DecimalConversion.hpp"
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include "Parallel.hpp"
+#include "WideArithmetics.hpp"
+#include <algorithm> //for std::min, std::max
+#include <climits> //for INT_MAX
+#include <cstdint> //for std::uint64_t
+#include <stdexcept> //for std::invalid_argument
+#include <vector>
+
+
+namespace fraction {
+
+
+//The maximal number of digits parseDecimal() handles (10^38 < 2^127).
+static const int MAX_DECIMAL_DIGITS = 38;
+
+//The number of digits computed by a single division.
+static const int DIGITS_PER_BLOCK = 9;
+
+//The minimal number of fractions in a chunk that's formatted by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 14;
+
+static const std::uint64_t POWERS_OF_10[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+	100000000ULL, 1000000000ULL
+};
+
+
+//Returns 10^exponent (exponent <= MAX_DECIMAL_DIGITS).
+static unsigned __int128 wideTenPower(int exponent) {
+	unsigned __int128 result = 1;
+	for (int i = 0; i < exponent; ++i)
+		result *= 10;
+	return result;
+}
+
+
+//Appends the decimal digits of 'value'.
+static void appendUnsigned(std::string& output, std::uint64_t value) {
+	char digits[20];
+	int length = 0;
+	do {
+		digits[length++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (0 != value);
+
+	while (length > 0)
+		output.push_back(digits[--length]);
+}
+
+
+/***
+*std::uint64_t appendDigits() - Appends fractional digits of a fraction
+*
+*Purpose:
+*       Appends the first 'count' fractional digits of remainder/denominator,
+*       and returns the remainder after the last of them.
+*
+*       The digits are computed DIGITS_PER_BLOCK at a time: the remainder is
+*       multiplied by 10^DIGITS_PER_BLOCK, and a single division gives all the
+*       digits of the block (as the quotient) and the next remainder. Since
+*       both the remainder and the denominator are less than 2^32, this fits
+*       in 64 bits.
+*
+*Entry:
+*       std::string&        output - The string we append the digits to.
+*       std::uint64_t    remainder - The numerator (less than the denominator).
+*       std::uint64_t  denominator - The denominator (less than 2^32).
+*       std::size_t          count - The number of digits.
+*
+*Exit:
+*       std::uint64_t - The remainder after the last digit.
+*
+*Exceptions:
+*
+*******************************************************************************/
+static std::uint64_t appendDigits(std::string& output, std::uint64_t remainder,
+	std::uint64_t denominator, std::size_t count)
+{
+	while (count > 0) {
+		int block = (int)std::min<std::size_t>(count, DIGITS_PER_BLOCK);
+		std::uint64_t scaled = remainder * POWERS_OF_10[block];
+		std::uint64_t digits = scaled / denominator;
+		remainder = scaled % denominator;
+
+		char buffer[DIGITS_PER_BLOCK];
+		for (int i = block - 1; i >= 0; --i) {
+			buffer[i] = (char)('0' + digits % 10);
+			digits /= 10;
+		}
+		output.append(buffer, block);
+		count -= block;
+	}
+
+	return remainder;
+}
+
+
+/***
+*ParseStatus parseDecimal() - Parses a decimal
+*
+*Purpose:
+*       Reads the digits of the integer and fractional parts into a single
+*       integer 'value', so the decimal is value / 10^k (k is the number of
+*       fractional digits).
+*       Zeros in the fractional part are only counted until a non-zero digit
+*       follows them, so trailing zeros don't add digits.
+*
+*       If there's a repeating part R of m digits, the decimal is
+*       (value * (10^m - 1) + R) / (10^k * (10^m - 1)).
+*
+*       Finally the fraction is reduced, and checked to fit in an 'int'.
+*
+*Entry:
+*       const char*      begin - The beginning of the text.
+*       const char*        end - The end of the text.
+*       int&         numerator - Would hold the reduced numerator.
+*       int&       denominator - Would hold the reduced, positive, denominator.
+*
+*Exit:
+*       ParseStatus - The result of the parsing. 'numerator' and 'denominator'
+*                     are changed only if it's Ok.
+*
+*Exceptions:
+*
+*******************************************************************************/
+ParseStatus parseDecimal(const char* begin, const char* end, int& numerator, int& denominator) {
+	const char* current = begin;
+	bool negative = false;
+	if (current != end && ('+' == *current || '-' == *current)) {
+		negative = ('-' == *current);
+		++current;
+	}
+
+	unsigned __int128 value = 0;
+	int significant_digits = 0, fractional_digits = 0, repeating_digits = 0;
+	bool any_digit = false, too_long = false;
+
+	for (; current != end && *current >= '0' && *current <= '9'; ++current) {
+		any_digit = true;
+		if (0 == value && '0' == *current)
+			continue;
+		if (++significant_digits > MAX_DECIMAL_DIGITS)
+			too_long = true;
+		else
+			value = value * 10 + (*current - '0');
+	}
+
+	//The zeros read since the last non-zero fractional digit.
+	int pending_zeros = 0;
+	unsigned __int128 repeating = 0;
+
+	if (current != end && '.' == *current) {
+		++current;
+
+		for (; current != end && *current >= '0' && *current <= '9'; ++current) {
+			any_digit = true;
+			if ('0' == *current) {
+				++pending_zeros;
+				continue;
+			}
+
+			fractional_digits += pending_zeros + 1;
+			significant_digits += (0 == value) ? 1 : pending_zeros + 1;
+			if (fractional_digits > MAX_DECIMAL_DIGITS || significant_digits > MAX_DECIMAL_DIGITS)
+				too_long = true;
+			else
+				value = value * wideTenPower(pending_zeros + 1) + (*current - '0');
+			pending_zeros = 0;
+		}
+
+		if (current != end && '(' == *current) {
+			++current;
+			for (; current != end && *current >= '0' && *current <= '9'; ++current) {
+				if (++repeating_digits <= MAX_DECIMAL_DIGITS)
+					repeating = repeating * 10 + (*current - '0');
+			}
+
+			if (current == end || ')' != *current || 0 == repeating_digits)
+				return ParseStatus::Malformed;
+			++current;
+			any_digit = true;
+
+			//The zeros before the repeating part are digits of the decimal.
+			fractional_digits += pending_zeros;
+			if (0 != value)
+				significant_digits += pending_zeros;
+			if (!too_long && fractional_digits <= MAX_DECIMAL_DIGITS && significant_digits <= MAX_DECIMAL_DIGITS)
+				value *= wideTenPower(pending_zeros);
+		}
+	}
+
+	if (current != end || !any_digit)
+		return ParseStatus::Malformed;
+
+	if (too_long || fractional_digits + repeating_digits > MAX_DECIMAL_DIGITS ||
+		significant_digits + repeating_digits > MAX_DECIMAL_DIGITS)
+	{
+		return ParseStatus::Overflow;
+	}
+
+	unsigned __int128 wide_numerator = value;
+	unsigned __int128 wide_denominator = wideTenPower(fractional_digits);
+	if (repeating_digits > 0) {
+		unsigned __int128 nines = wideTenPower(repeating_digits) - 1;
+		wide_numerator = wide_numerator * nines + repeating;
+		wide_denominator *= nines;
+	}
+
+	unsigned __int128 divisor = (unsigned __int128)WideArithmetics::gcd(
+		(WideArithmetics::int128)wide_numerator, (WideArithmetics::int128)wide_denominator);
+	wide_numerator /= divisor;
+	wide_denominator /= divisor;
+
+	//-INT_MIN doesn't fit in an 'int', but INT_MIN does.
+	if (wide_denominator > INT_MAX || wide_numerator > (unsigned __int128)INT_MAX + (negative ? 1 : 0))
+		return ParseStatus::Overflow;
+
+	numerator = negative ? (int)(-(long long)wide_numerator) : (int)wide_numerator;
+	denominator = (int)wide_denominator;
+	return ParseStatus::Ok;
+}
+
+
+//The lines are read into a string that's reused, and parsed with
+//parseDecimal().
+std::istream& readDecimal(std::istream& is, Fraction& frac) {
+	std::string input;
+
+	while (std::getline(is, input)) {
+		int numerator, denominator;
+		ParseStatus status = parseDecimal(input.data(), input.data() + input.size(), numerator, denominator);
+
+		if (ParseStatus::Ok == status) {
+			frac = Fraction(numerator, denominator, frac.getOverflowProtection());
+			break;
+		}
+		if (ParseStatus::Overflow == status && frac.getOverflowProtection())
+			throw NumericOverflowException();
+	}
+
+	return is;
+}
+
+
+/***
+*void appendDecimal() - Appends a fraction as a rounded decimal
+*
+*Purpose:
+*       The implementation of toDecimal() and toDecimals().
+*
+*       Appends the integer part and 'precision' fractional digits (computed
+*       in blocks by appendDigits()) of |numerator|/denominator, and then
+*       decides by the remainder and the rounding mode whether to round the
+*       magnitude up. Rounding up adds 1 to the last digit, and carries through
+*       the 9s before it (adding a leading 1 if all the digits are 9s).
+*
+*       The sign is appended first, and is removed if all the digits are 0.
+*
+*Entry:
+*       std::string&       output - The string we append the decimal to.
+*       long long       numerator - The numerator.
+*       long long     denominator - The denominator.
+*       int             precision - The number of fractional digits.
+*       RoundingMode         mode - How the digits past the precision are rounded.
+*
+*Exit:
+*
+*Exceptions:
+*       DivisionByZeroException() - If the denominator is 0.
+*
+*******************************************************************************/
+static void appendDecimal(std::string& output, long long numerator, long long denominator,
+	int precision, RoundingMode mode)
+{
+	if (0 == denominator)
+		throw DivisionByZeroException();
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	bool negative = numerator < 0;
+	std::uint64_t magnitude = negative ? (std::uint64_t)(-numerator) : (std::uint64_t)numerator;
+	std::uint64_t divisor = (std::uint64_t)denominator;
+
+	std::size_t start = output.size();
+	if (negative)
+		output.push_back('-');
+	std::size_t digits_start = output.size();
+
+	appendUnsigned(output, magnitude / divisor);
+	std::uint64_t remainder = magnitude % divisor;
+	if (precision > 0) {
+		output.push_back('.');
+		remainder = appendDigits(output, remainder, divisor, (std::size_t)precision);
+	}
+
+	bool last_digit_odd = (output[output.size() - 1] - '0') % 2 != 0;
+	bool round_up = false;
+	switch (mode) {
+	case RoundingMode::HalfEven:
+		round_up = 2 * remainder > divisor || (2 * remainder == divisor && last_digit_odd);
+		break;
+	case RoundingMode::HalfUp:
+		round_up = 2 * remainder >= divisor;
+		break;
+	case RoundingMode::HalfDown:
+		round_up = 2 * remainder > divisor;
+		break;
+	case RoundingMode::Up:
+		round_up = 0 != remainder;
+		break;
+	case RoundingMode::Down:
+		round_up = false;
+		break;
+	case RoundingMode::Ceiling:
+		round_up = 0 != remainder && !negative;
+		break;
+	case RoundingMode::Floor:
+		round_up = 0 != remainder && negative;
+		break;
+	}
+
+	if (round_up) {
+		std::size_t index = output.size();
+		while (index > digits_start) {
+			--index;
+			if ('.' == output[index])
+				continue;
+			if ('9' != output[index]) {
+				++output[index];
+				break;
+			}
+			output[index] = '0';
+			if (index == digits_start)
+				output.insert(output.begin() + digits_start, '1');
+		}
+	}
+
+	if (negative && output.find_first_not_of("0.", digits_start) == std::string::npos)
+		output.erase(start, 1);
+}
+
+
+//Appends the decimal to an empty string.
+std::string toDecimal(const Fraction& frac, int precision, RoundingMode mode) {
+	std::string result;
+	appendDecimal(result, frac.getNumerator(), frac.getDenominator(), std::max(precision, 0), mode);
+	return result;
+}
+
+
+/***
+*std::string toDecimals() - Formats columns of fractions as decimals
+*
+*Purpose:
+*       Splits the columns into chunks (a few per thread, as long as the chunks
+*       aren't too small), formats every chunk into its own string on the
+*       threads, and concatenates the strings in order.
+*
+*Entry:
+*       const FractionColumns&  columns - The fractions.
+*       int                   precision - The number of fractional digits.
+*       RoundingMode               mode - How the digits past the precision
+*                                         are rounded.
+*       unsigned                threads - The number of threads (0 means the
+*                                         number of hardware threads).
+*
+*Exit:
+*       std::string - The decimals, each one followed by a '\n'.
+*
+*Exceptions:
+*       DivisionByZeroException() - If a denominator is 0.
+*
+*******************************************************************************/
+std::string toDecimals(const FractionColumns& columns, int precision, RoundingMode mode,
+	unsigned threads)
+{
+	precision = std::max(precision, 0);
+	const int* numerators = columns.numerators();
+	const int* denominators = columns.denominators();
+	std::size_t count = columns.size();
+
+	std::size_t chunks = std::max<std::size_t>(1,
+		std::min<std::size_t>(Parallel::threadCount(threads) * 4, count / MIN_CHUNK_SIZE));
+	std::vector<std::string> formatted(chunks);
+
+	Parallel::forEach(chunks, threads, [&](std::size_t chunk) {
+		std::size_t begin = count * chunk / chunks;
+		std::size_t end = count * (chunk + 1) / chunks;
+
+		std::string& output = formatted[chunk];
+		output.reserve((end - begin) * (precision + 8));
+		for (std::size_t i = begin; i < end; ++i) {
+			appendDecimal(output, numerators[i], denominators[i], precision, mode);
+			output.push_back('\n');
+		}
+	});
+
+	if (1 == chunks)
+		return formatted[0];
+
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < chunks; ++i)
+		total += formatted[i].size();
+
+	std::string result;
+	result.reserve(total);
+	for (std::size_t i = 0; i < chunks; ++i)
+		result += formatted[i];
+	return result;
+}
+
+
+//Returns (base^exponent) % modulus, for modulus < 2^32.
+static std::uint64_t powerModulo(std::uint64_t base, std::uint64_t exponent, std::uint64_t modulus) {
+	std::uint64_t result = 1 % modulus;
+	base %= modulus;
+	while (0 != exponent) {
+		if (exponent & 1)
+			result = result * base % modulus;
+		base = base * base % modulus;
+		exponent >>= 1;
+	}
+	return result;
+}
+
+
+//Returns the greatest common divisor of 'num1' and 'num2'.
+static std::uint64_t gcd(std::uint64_t num1, std::uint64_t num2) {
+	while (0 != num2) {
+		std::uint64_t remainder = num1 % num2;
+		num1 = num2;
+		num2 = remainder;
+	}
+	return num1;
+}
+
+
+/***
+*std::uint64_t orderOfTen() - Returns the multiplicative order of 10
+*
+*Purpose:
+*       Returns the smallest k > 0 such that 10^k = 1 (mod modulus), which is
+*       the period of the decimal expansion of 1/modulus.
+*
+*       The order divides the Carmichael function of the modulus, which is
+*       computed from the factors of the modulus: the lcm of
+*       p^(e-1) * (p-1) over its prime powers p^e. Then, for every prime
+*       factor q of the result, q is divided out as long as 10 to the power of
+*       the quotient is still 1.
+*       Both factorizations are trial divisions up to the square root (less
+*       than 2^16), so this takes microseconds, whatever the period is.
+*
+*Entry:
+*       std::uint64_t modulus - The modulus (greater than 1, co-prime to 10,
+*                               less than 2^32).
+*
+*Exit:
+*       std::uint64_t - The order of 10 modulo 'modulus'.
+*
+*Exceptions:
+*
+*******************************************************************************/
+static std::uint64_t orderOfTen(std::uint64_t modulus) {
+	std::uint64_t carmichael = 1;
+	std::uint64_t rest = modulus;
+	for (std::uint64_t p = 3; p * p <= rest; p += 2) {
+		if (0 != rest % p)
+			continue;
+
+		std::uint64_t lambda = p - 1;
+		rest /= p;
+		while (0 == rest % p) {
+			lambda *= p;
+			rest /= p;
+		}
+		carmichael = carmichael / gcd(carmichael, lambda) * lambda;
+	}
+	if (rest > 1)
+		carmichael = carmichael / gcd(carmichael, rest - 1) * (rest - 1);
+
+	std::uint64_t order = carmichael;
+	rest = carmichael;
+	for (std::uint64_t q = 2; q * q <= rest; ++q) {
+		if (0 != rest % q)
+			continue;
+
+		while (0 == rest % q)
+			rest /= q;
+		while (0 == order % q && 1 == powerModulo(10, order / q, modulus))
+			order /= q;
+	}
+	if (rest > 1 && 0 == order % rest && 1 == powerModulo(10, order / rest, modulus))
+		order /= rest;
+
+	return order;
+}
+
+
+/***
+*void decimalPeriod() - Computes the lengths of the decimal expansion
+*
+*Purpose:
+*       If the denominator is 2^a * 5^b * m (m co-prime to 10), the digits
+*       before the repeating part are max(a, b), and the period is the order of
+*       10 modulo m (0 if m is 1).
+*
+*Entry:
+*       const Fraction&            frac - The fraction.
+*       int&            preperiodLength - Would hold the number of digits
+*                                         before the repeating part.
+*       int&               periodLength - Would hold the length of the
+*                                         repeating part.
+*
+*Exit:
+*
+*Exceptions:
+*       DivisionByZeroException() - If the denominator is 0 (the loops over
+*                                   the factors of 2 and 5 would never end).
+*       std::invalid_argument - If the denominator is negative.
+*
+*******************************************************************************/
+void decimalPeriod(const Fraction& frac, int& preperiodLength, int& periodLength) {
+	if (0 == frac.getDenominator())
+		throw DivisionByZeroException();
+	if (frac.getDenominator() < 0)
+		throw std::invalid_argument("decimalPeriod(): The denominator is negative");
+
+	std::uint64_t rest = (std::uint64_t)frac.getDenominator();
+
+	int twos = 0, fives = 0;
+	while (0 == rest % 2) {
+		rest /= 2;
+		++twos;
+	}
+	while (0 == rest % 5) {
+		rest /= 5;
+		++fives;
+	}
+
+	preperiodLength = std::max(twos, fives);
+	periodLength = (1 == rest) ? 0 : (int)orderOfTen(rest);
+}
+
+
+/***
+*bool toRepeatingDecimal() - Formats a fraction as an exact decimal
+*
+*Purpose:
+*       Computes the lengths with decimalPeriod(), and then appends exactly
+*       that many digits (in blocks) before and inside the parentheses.
+*
+*Entry:
+*       const Fraction&     frac - The fraction.
+*       std::string&      result - Would hold the decimal.
+*       std::size_t    maxDigits - The maximal number of fractional digits.
+*
+*Exit:
+*       bool - 'false' if the decimal has more than 'maxDigits' fractional
+*              digits.
+*
+*Exceptions:
+*       Those of decimalPeriod(), if the denominator isn't positive.
+*
+*******************************************************************************/
+bool toRepeatingDecimal(const Fraction& frac, std::string& result, std::size_t maxDigits) {
+	int preperiod_length, period_length;
+	decimalPeriod(frac, preperiod_length, period_length);
+	if ((std::size_t)preperiod_length + (std::size_t)period_length > maxDigits)
+		return false;
+
+	//decimalPeriod() checked that the denominator is positive.
+	long long numerator = frac.getNumerator();
+	long long denominator = frac.getDenominator();
+
+	std::uint64_t magnitude = (std::uint64_t)(numerator < 0 ? -numerator : numerator);
+	std::uint64_t divisor = (std::uint64_t)denominator;
+
+	std::string output;
+	if (numerator < 0)
+		output.push_back('-');
+	appendUnsigned(output, magnitude / divisor);
+
+	std::uint64_t remainder = magnitude % divisor;
+	if (preperiod_length + period_length > 0) {
+		output.push_back('.');
+		remainder = appendDigits(output, remainder, divisor, (std::size_t)preperiod_length);
+		if (period_length > 0) {
+			output.push_back('(');
+			appendDigits(output, remainder, divisor, (std::size_t)period_length);
+			output.push_back(')');
+		}
+	}
+
+	result.swap(output);
+	return true;
+}
+
+} //namespace fraction {
@@ -0,0 +1,117 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the conversions between fractions
+* and decimal strings
+*/
+
+
+#ifndef DECIMALCONVERSION_HPP_
+#define DECIMALCONVERSION_HPP_
+
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include "ParseStatus.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <string>
+
+
+namespace fraction {
+
+
+//How toDecimal() rounds the digits past the precision.
+enum class RoundingMode {
+	HalfEven,  //To the nearest, ties to an even last digit (the default)
+	HalfUp,    //To the nearest, ties away from zero
+	HalfDown,  //To the nearest, ties toward zero
+	Up,        //Away from zero
+	Down,      //Toward zero (truncation)
+	Ceiling,   //Toward positive infinity
+	Floor      //Toward negative infinity
+};
+
+
+/*
+Parses the decimal in [begin, end) exactly into a reduced fraction (with a
+positive denominator), without allocating anything.
+
+The format is an optional sign, the integer part, and optionally a '.'
+followed by the fractional digits, whose repeating part (if any) is written
+in parentheses at the end - e.g. "0.125", "-.5", "1.(3)" (= 4/3) and
+"0.1(6)" (= 1/6). There must be at least one digit, and no white spaces.
+
+The fraction is computed in 128 bits, so the significant digits (without
+leading zeros, and without trailing zeros of a non-repeating decimal) are
+limited to 38 - a longer decimal is reported as an Overflow, as is one whose
+reduced fraction doesn't fit in an 'int'.
+
+parseFraction() (and so FractionLoader) falls back to this function for text
+that contains a '.', so decimal columns are loaded with FractionLoader.
+*/
+ParseStatus parseDecimal(const char* begin, const char* end, int& numerator, int& denominator);
+
+/*
+Reads a decimal (in the format of parseDecimal(), which includes integers)
+from 'is' into 'frac', the way operator>> reads a fraction: line by line,
+skipping the lines that can't be parsed. If a decimal doesn't fit in a
+Fraction, it throws NumericOverflowException() if 'frac' has the overflow
+protection, and skips the line otherwise.
+If the stream ends first, 'frac' is left unchanged (and the stream fails).
+*/
+std::istream& readDecimal(std::istream& is, Fraction& frac);
+
+
+/*
+Returns 'frac' as a decimal with exactly 'precision' (at least 0) fractional
+digits, rounded by 'mode' - e.g. 1/8 with precision 2 is "0.12" (HalfEven) or
+"0.13" (HalfUp).
+A result whose digits are all 0 has no sign.
+*/
+std::string toDecimal(const Fraction& frac, int precision, RoundingMode mode = RoundingMode::HalfEven);
+
+
+/*
+The batch version of toDecimal(): returns the decimals of all the fractions
+in 'columns', each one followed by a '\n'.
+The columns are formatted in parallel chunks on 'threads' threads (0 means
+the number of hardware threads).
+*/
+std::string toDecimals(const FractionColumns& columns, int precision,
+	RoundingMode mode = RoundingMode::HalfEven, unsigned threads = 0);
+
+
+/*
+Computes the lengths of the decimal expansion of 'frac': the number of
+fractional digits before the repeating part, and the length of the repeating
+part (0 if the expansion terminates).
+If the denominator of 'frac' is 0 it throws DivisionByZeroException(), and if
+it's negative it throws std::invalid_argument (only an overflow without the
+protection can leave such a Fraction).
+
+The lengths are computed from the factors of the denominator (the exponents
+of 2 and 5, and the multiplicative order of 10 modulo the rest), not by long
+division - so this is fast even when the period is billions of digits long.
+*/
+void decimalPeriod(const Fraction& frac, int& preperiodLength, int& periodLength);
+
+
+//The default bound on the fractional digits of toRepeatingDecimal().
+static const std::size_t DEFAULT_MAX_REPEATING_DIGITS = 4096;
+
+/*
+Stores the exact decimal of 'frac' in 'result', with the repeating part in
+parentheses (the format parseDecimal() accepts) - e.g. "1.(3)" for 4/3.
+
+Returns 'false' (and leaves 'result' unchanged) if the digits before the
+repeating part and the repeating part together are more than 'maxDigits'.
+It throws like decimalPeriod() if the denominator isn't positive.
+*/
+bool toRepeatingDecimal(const Fraction& frac, std::string& result,
+	std::size_t maxDigits = DEFAULT_MAX_REPEATING_DIGITS);
+
+} //namespace fraction {
+
+#endif
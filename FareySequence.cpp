@@ -0,0 +1,379 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the FareySequence class, and of
+* the Stern-Brocot helpers
+*/
+
+#include "FareySequence.hpp"
+#include "NumericOverflowException.hpp"
+#include <climits> //for INT_MIN, INT_MAX
+#include <utility> //for std::swap
+#include <algorithm> //for std::min
+
+
+namespace fraction {
+
+
+//Returns floor(num/den), for a positive 'den'.
+static long long floorDivide(long long num, long long den) {
+	long long quotient = num / den;
+	if ((num % den != 0) && (num < 0))
+		--quotient;
+	return quotient;
+}
+
+
+//Returns num modulo 'modulus' in [0, modulus), for a positive 'modulus'.
+static long long floorModulo(long long num, long long modulus) {
+	return num - floorDivide(num, modulus) * modulus;
+}
+
+
+//Returns the inverse of 'num' modulo 'modulus' in [0, modulus), where 'num'
+//and 'modulus' are co-prime.
+//Extended Euclidean algorithm. Modulo 1, every number is 0.
+static long long modularInverse(long long num, long long modulus) {
+	long long old_r = floorModulo(num, modulus), r = modulus;
+	long long old_s = 1, s = 0;
+
+	while (0 != r) {
+		long long quotient = old_r / r;
+
+		long long tmp = old_r - quotient * r;
+		old_r = r;
+		r = tmp;
+
+		tmp = old_s - quotient * s;
+		old_s = s;
+		s = tmp;
+	}
+
+	return floorModulo(old_s, modulus);
+}
+
+
+FareySequence::FareySequence(int order, const Fraction& lower, const Fraction& upper,
+	bool includeUpper) :
+	m_order(order),
+	m_upper(upper),
+	m_include_upper(includeUpper),
+	m_prev_numerator(0),
+	m_prev_denominator(1),
+	m_numerator(0),
+	m_denominator(1),
+	m_done(order < 1)
+{
+	if (!this->m_done)
+		this->seek(lower);
+}
+
+
+/***
+*void FareySequence::seek() - Finds the first term, and its predecessor
+*
+*Purpose:
+*       Let lower = p/q.
+*
+*       1) If q <= n, then p/q is itself a term of F_n, and its predecessor a/b
+*          is the one with b*p - a*q = 1 and the largest b <= n.
+*          So b is the inverse of p modulo q, shifted by multiples of q to be
+*          as close to n as possible, and a = (b*p - 1)/q.
+*
+*       2) If q > n, then we descend the Stern-Brocot tree towards p/q, keeping
+*          the left and right ends L < p/q < R of the current node, until the
+*          denominator of their mediant exceeds n - at this point L and R are
+*          consecutive terms of F_n, and R is the first term.
+*          Moving several times in the same direction is done in one step
+*          (the number of steps is computed with a division), so the descent
+*          takes as many steps as there are terms in the continued fraction of
+*          p/q, and not as many as their sum.
+*
+*Entry:
+*       const Fraction& lower - The lower bound of the sequence.
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+void FareySequence::seek(const Fraction& lower) {
+	long long p = lower.getNumerator();
+	long long q = lower.getDenominator();
+	long long n = this->m_order;
+
+	if (q <= n) {
+		long long b = modularInverse(p, q);
+		b += q * ((n - b) / q);
+
+		this->m_prev_numerator = (b * p - 1) / q;
+		this->m_prev_denominator = b;
+		this->m_numerator = p;
+		this->m_denominator = q;
+		return;
+	}
+
+	//L = a/b, R = c/d
+	long long a = floorDivide(p, q), b = 1;
+	long long c = a + 1, d = 1;
+
+	while (b + d <= n) {
+
+		//s = q*(p/q - a/b) > 0, t = q*(c/d - p/q) > 0, both scaled by the
+		//denominators of the ends.
+		long long s = p * b - a * q;
+		long long t = c * q - p * d;
+
+		//The mediant is (a+c)/(b+d). Its denominator is at most n < q, so it
+		//can't be p/q itself.
+		if ((a + c) * q > p * (b + d)) {
+
+			//p/q is left of the mediant - move R towards L by the largest k
+			//such that (c+k*a)/(d+k*b) is still right of p/q.
+			long long k = std::min((t - 1) / s, (n - d) / b);
+			c += k * a;
+			d += k * b;
+		}
+		else {
+
+			//p/q is right of the mediant - move L towards R.
+			long long k = std::min((s - 1) / t, (n - b) / d);
+			a += k * c;
+			b += k * d;
+		}
+	}
+
+	this->m_prev_numerator = a;
+	this->m_prev_denominator = b;
+	this->m_numerator = c;
+	this->m_denominator = d;
+}
+
+
+//Compares the current term with the upper bound by cross-multiplication.
+//Both denominators are positive, and the products are computed in 128 bits,
+//so they can't overflow.
+bool FareySequence::pastUpper() const {
+	__int128 lhs = (__int128)this->m_numerator * this->m_upper.getDenominator();
+	__int128 rhs = (__int128)this->m_upper.getNumerator() * this->m_denominator;
+
+	return (lhs > rhs) || (lhs == rhs && !this->m_include_upper);
+}
+
+
+/***
+*bool FareySequence::next() - Returns the next term of the sequence
+*
+*Purpose:
+*       Returns the current term, and advances to the next one with the
+*       recurrence:
+*
+*       if a/b, c/d are consecutive terms of F_n, then the term after c/d is
+*       (k*c - a)/(k*d - b) where k = (n+b)/d.
+*
+*       The terms are already reduced, so nothing else is computed.
+*
+*Entry:
+*       int&   numerator - Would hold the numerator of the term.
+*       int& denominator - Would hold the denominator of the term.
+*
+*Exit:
+*       bool - 'true' if a term was returned, 'false' if the sequence ended.
+*
+*Exceptions:
+*       NumericOverflowException() - If the term doesn't fit in an 'int'.
+*
+*******************************************************************************/
+bool FareySequence::next(int& numerator, int& denominator) {
+	if (this->m_done || this->pastUpper()) {
+		this->m_done = true;
+		return false;
+	}
+
+	if (this->m_numerator < INT_MIN || this->m_numerator > INT_MAX)
+		throw NumericOverflowException();
+
+	numerator = (int)this->m_numerator;
+	denominator = (int)this->m_denominator;
+
+	long long k = (this->m_order + this->m_prev_denominator) / this->m_denominator;
+	long long next_numerator = k * this->m_numerator - this->m_prev_numerator;
+	long long next_denominator = k * this->m_denominator - this->m_prev_denominator;
+
+	this->m_prev_numerator = this->m_numerator;
+	this->m_prev_denominator = this->m_denominator;
+	this->m_numerator = next_numerator;
+	this->m_denominator = next_denominator;
+
+	return true;
+}
+
+
+//Calls next() on the numerator and denominator of a term, and stores them in
+//'frac'.
+bool FareySequence::next(Fraction& frac) {
+	int numerator, denominator;
+	if (!this->next(numerator, denominator))
+		return false;
+
+	frac = Fraction(numerator, denominator, frac.getOverflowProtection());
+	return true;
+}
+
+
+/***
+*std::vector<FareySequence> FareySequence::split() - Splits the sequence
+*
+*Purpose:
+*       Splits the remaining terms into consecutive sub-sequences
+*       [b0, b1), [b1, b2), ..., [b(k-1), upper], where b0 is the current term.
+*
+*       The terms of a Farey sequence are (asymptotically) uniformly
+*       distributed, so we choose the boundaries from a much coarser Farey
+*       sequence F_m in the same range: we double 'm' until F_m has a few
+*       terms for every part (or until m reaches the order), and take evenly
+*       spaced terms of it as boundaries.
+*       Each boundary has a denominator of at most the order, so it's a term
+*       itself, and no sub-sequence is empty.
+*
+*Entry:
+*       std::size_t parts - The requested number of sub-sequences.
+*
+*Exit:
+*       std::vector<FareySequence> - At most 'parts' sub-sequences, empty if
+*                                    there are no remaining terms.
+*
+*Exceptions:
+*       NumericOverflowException() - If the current term doesn't fit in a
+*                                    Fraction.
+*
+*******************************************************************************/
+std::vector<FareySequence> FareySequence::split(std::size_t parts) const {
+	std::vector<FareySequence> result;
+
+	if (this->m_done || this->pastUpper() || 0 == parts)
+		return result;
+
+	if (this->m_numerator < INT_MIN || this->m_numerator > INT_MAX)
+		throw NumericOverflowException();
+
+	Fraction start((int)this->m_numerator, (int)this->m_denominator);
+
+	//The terms of F_m strictly between the current term and the upper bound.
+	std::vector<Fraction> coarse;
+	for (int m = 1; ; m = (m > this->m_order / 2) ? this->m_order : m * 2) {
+		coarse.clear();
+
+		FareySequence sequence(m, start, this->m_upper, false);
+		Fraction term;
+		while (sequence.next(term)) {
+			if (start < term)
+				coarse.push_back(term);
+		}
+
+		if (coarse.size() >= 8 * parts || m == this->m_order)
+			break;
+	}
+
+	std::size_t boundaries = std::min(parts - 1, coarse.size());
+
+	Fraction lower = start;
+	for (std::size_t i = 1; i <= boundaries; ++i) {
+		const Fraction& boundary = coarse[(i * coarse.size()) / (boundaries + 1)];
+		result.push_back(FareySequence(this->m_order, lower, boundary, false));
+		lower = boundary;
+	}
+	result.push_back(FareySequence(this->m_order, lower, this->m_upper, this->m_include_upper));
+
+	return result;
+}
+
+
+//Stern-Brocot helpers
+
+
+/***
+*void simplestPositive() - The simplest fraction in a positive interval
+*
+*Purpose:
+*       Finds the simplest fraction in [ln/ld, un/ud], where 0 < ln/ld <= un/ud.
+*
+*       Let f = floor(ln/ld).
+*       1) If f+1 (or f itself, if the lower bound is an integer) is in the
+*          interval, then the simplest fraction is that integer.
+*       2) Else f < lower <= upper < f+1, and every fraction in the interval is
+*          f + 1/x where x is in [1/(upper-f), 1/(lower-f)] - so the simplest
+*          fraction is f + 1/(the simplest fraction in that interval).
+*
+*       This is exactly the descent in the Stern-Brocot tree - every recursion
+*       takes all the steps in the same direction at once, and handles one
+*       term of the continued fractions of the bounds.
+*
+*Entry:
+*       long long ln, ld - The lower bound
+*       long long un, ud - The upper bound
+*       long long&   num - Would hold the numerator of the simplest fraction
+*       long long&   den - Would hold the denominator of the simplest fraction
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+static void simplestPositive(long long ln, long long ld, long long un, long long ud,
+	long long& num, long long& den)
+{
+	long long f = ln / ld;
+
+	if (f * ld == ln) {
+		num = f;
+		den = 1;
+		return;
+	}
+
+	if ((f + 1) * ud <= un) {
+		num = f + 1;
+		den = 1;
+		return;
+	}
+
+	long long inner_num, inner_den;
+	simplestPositive(ud, un - f * ud, ld, ln - f * ld, inner_num, inner_den);
+
+	// f + 1/(inner_num/inner_den) = (f*inner_num + inner_den)/inner_num
+	num = f * inner_num + inner_den;
+	den = inner_num;
+}
+
+
+//If the interval contains 0, then 0 is the simplest fraction.
+//If it's negative, then the simplest fraction is the negation of the simplest
+//fraction in the negated interval.
+Fraction simplestBetween(const Fraction& lower, const Fraction& upper) {
+	long long ln = lower.getNumerator(), ld = lower.getDenominator();
+	long long un = upper.getNumerator(), ud = upper.getDenominator();
+
+	if (ln * ud > un * ld) {
+		std::swap(ln, un);
+		std::swap(ld, ud);
+	}
+
+	if (ln <= 0 && un >= 0)
+		return Fraction(0);
+
+	long long num, den;
+	if (ln > 0) {
+		simplestPositive(ln, ld, un, ud, num, den);
+	}
+	else {
+		simplestPositive(-un, ud, -ln, ld, num, den);
+		num = -num;
+	}
+
+	return Fraction((int)num, (int)den);
+}
+
+
+} //namespace fraction {
@@ -0,0 +1,130 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the FareySequence class, and of
+* Stern-Brocot helpers
+*/
+
+
+#ifndef FAREYSEQUENCE_HPP_
+#define FAREYSEQUENCE_HPP_
+
+#include "Fraction.hpp"
+#include <cstddef> //for std::size_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class enumerates, in increasing order, all the reduced fractions whose
+denominator is at most a given order 'n' (the Farey sequence F_n), and that
+lie between a lower and an upper bound.
+
+The terms are generated with the next-term recurrence of the Farey sequence:
+if a/b and c/d are consecutive terms of F_n, then the next term is
+
+    k*c - a
+    -------    where k = (n+b)/d
+    k*d - b
+
+so no term is ever reduced and no gcd is computed while enumerating.
+Only the constructor does some work (an extended Euclid, or a Stern-Brocot
+descent) to find the first term and its predecessor.
+
+The sequence can be split into consecutive sub-sequences with split(), so
+that each one could be enumerated on a different thread.
+
+The bounds are not required to be in [0,1] - the fractions with a bounded
+denominator on the whole line follow the same recurrence.
+If a term doesn't fit in an 'int', next() throws NumericOverflowException().
+*/
+class FareySequence
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	Enumerates the terms of F_order in [lower, upper] (or [lower, upper) if
+	'includeUpper' is false).
+	If 'order' is less than 1, or if upper < lower, the sequence is empty.
+	*/
+	explicit FareySequence(int order, const Fraction& lower = Fraction(0),
+		const Fraction& upper = Fraction(1), bool includeUpper = true);
+
+
+	//-- public methods --//
+
+	//Stores the next term in 'numerator' and 'denominator' and returns 'true',
+	//or returns 'false' if there are no more terms.
+	bool next(int& numerator, int& denominator);
+
+	//Stores the next term in 'frac' and returns 'true', or returns 'false' if
+	//there are no more terms.
+	bool next(Fraction& frac);
+
+	/*
+	Splits the remaining terms of the sequence into (at most) 'parts'
+	consecutive sub-sequences of roughly the same length, which together
+	enumerate exactly the same terms, in the same order.
+	*/
+	std::vector<FareySequence> split(std::size_t parts) const;
+
+	//Getter for the order
+	int getOrder() const {
+		return this->m_order;
+	}
+
+private:
+	//-- private data members --//
+
+	//The maximal denominator
+	int m_order;
+
+	//The upper bound
+	Fraction m_upper;
+
+	//Whether the upper bound itself is enumerated
+	bool m_include_upper;
+
+	//The term before the current one (a/b in the recurrence)
+	long long m_prev_numerator;
+	long long m_prev_denominator;
+
+	//The current term, which is returned by the next call to next() (c/d in
+	//the recurrence)
+	long long m_numerator;
+	long long m_denominator;
+
+	//'true' when there are no more terms
+	bool m_done;
+
+
+	//-- private methods --//
+
+	//Sets the current term to the first term of the sequence which is not
+	//less than 'lower', and the previous term to its predecessor.
+	void seek(const Fraction& lower);
+
+	//Returns 'true' if the current term is past the upper bound.
+	bool pastUpper() const;
+
+}; //class FareySequence {
+
+
+/*
+Returns the simplest fraction in [lower, upper] (i.e. the one with the
+smallest denominator, and then with the smallest absolute numerator), found by
+descending the Stern-Brocot tree.
+If upper < lower, the bounds are swapped.
+*/
+Fraction simplestBetween(const Fraction& lower, const Fraction& upper);
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,526 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the FixedDenominatorArray class
+*/
+
+#include "FixedDenominatorArray.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include "SimdKernels.hpp"
+#include "WideArithmetics.hpp"
+#include <algorithm> //for std::min, std::fill
+#include <climits> //for INT_MIN, INT_MAX
+#include <stdexcept> //for std::invalid_argument
+#include <string>
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//The number of elements an element-wise operation on two arrays processes
+//between two overflow checks.
+static const std::size_t BLOCK_SIZE = 4096;
+
+
+//Returns the greatest common divisor of 'num1' and 'num2'.
+static unsigned long long gcd(unsigned long long num1, unsigned long long num2) {
+	while (0 != num2) {
+		unsigned long long remainder = num1 % num2;
+		num1 = num2;
+		num2 = remainder;
+	}
+	return num1;
+}
+
+
+//Returns |num| (which can't overflow in 'unsigned long long').
+static unsigned long long magnitude(long long num) {
+	return (num < 0) ? 0ull - (unsigned long long)num : (unsigned long long)num;
+}
+
+
+//Returns 'true' if 'num' is in the range of an 'int'.
+static bool fitsInt(long long num) {
+	return num >= INT_MIN && num <= INT_MAX;
+}
+
+
+//Stores the smallest and largest numerators in 'low' and 'high' (0 for an
+//empty array). A loop with no branches, which the compiler vectorizes.
+static void numeratorRange(const std::vector<int>& numerators, long long& low, long long& high) {
+	int minimum = numerators.empty() ? 0 : numerators[0];
+	int maximum = minimum;
+
+	for (std::size_t i = 0; i < numerators.size(); ++i) {
+		minimum = (numerators[i] < minimum) ? numerators[i] : minimum;
+		maximum = (numerators[i] > maximum) ? numerators[i] : maximum;
+	}
+
+	low = minimum;
+	high = maximum;
+}
+
+
+//Throws DivisionByZeroException() for a zero denominator, and
+//std::invalid_argument for a negative one.
+static int checkedDenominator(int denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+	if (denominator < 0)
+		throw std::invalid_argument("FixedDenominatorArray: the denominator must be positive");
+	return denominator;
+}
+
+
+//Returns the lcm of the denominators of 'columns' (1 for empty columns).
+//If it doesn't fit in an 'int', it throws NumericOverflowException().
+static int commonDenominator(const FractionColumns& columns) {
+	const int* denominators = columns.denominators();
+	long long lcm = 1;
+
+	for (std::size_t i = 0; i < columns.size(); ++i) {
+		long long denominator = (long long)magnitude(denominators[i]);
+		if (0 == denominator)
+			throw DivisionByZeroException();
+
+		//Most values share a few denominators, which already divide the lcm.
+		if (0 == lcm % denominator)
+			continue;
+
+		lcm = lcm / (long long)gcd(lcm, denominator) * denominator;
+		if (lcm > INT_MAX)
+			throw NumericOverflowException();
+	}
+
+	return (int)lcm;
+}
+
+
+/***
+*bool blockOperation() - Applies a batch operation of SimdKernels in place
+*
+*Purpose:
+*       Computes operation(numerators, other, numerators) in blocks of
+*       BLOCK_SIZE elements, with the overflow mask of the block on the stack.
+*
+*       If a block overflowed, the blocks so far (which hold the wrapped
+*       results) are restored with 'undo' - an add is undone by a wrapping
+*       subtraction and vice versa, since wrapping arithmetic is reversible.
+*
+*Entry:
+*       int*              numerators - The left operands, and the results.
+*       const int*             other - The right operands.
+*       std::size_t            count - The number of elements.
+*       Operation          operation - The batch function.
+*       Undo                    undo - Called as undo(numerator, other) on
+*                                      'unsigned's to restore a numerator.
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If any element overflowed.
+*
+*******************************************************************************/
+template <typename Operation, typename Undo>
+static void blockOperation(int* numerators, const int* other, std::size_t count, Operation operation, Undo undo) {
+	std::uint64_t overflow_mask[BLOCK_SIZE / 64];
+
+	for (std::size_t block = 0; block < count; block += BLOCK_SIZE) {
+		std::size_t block_size = std::min(BLOCK_SIZE, count - block);
+
+		if (operation(numerators + block, other + block, numerators + block, block_size, overflow_mask)) {
+			for (std::size_t i = 0; i < block + block_size; ++i)
+				numerators[i] = (int)undo((unsigned)numerators[i], (unsigned)other[i]);
+			throw NumericOverflowException();
+		}
+	}
+}
+
+
+/***
+*std::size_t compareNumerators() - Sets the mask bits of the elements that
+*                                  satisfy a predicate
+*
+*Purpose:
+*       For every block of 64 elements, the predicate is evaluated into an
+*       array of flags (a loop with no branches, which the compiler
+*       vectorizes), and the flags are then packed into the mask word of the
+*       block (as filter() does).
+*
+*Entry:
+*       std::size_t       count - The number of elements.
+*       std::uint64_t*     mask - Would hold the selection.
+*       Predicate     predicate - Called as predicate(i).
+*
+*Exit:
+*       std::size_t - The number of selected elements.
+*
+*Exceptions:
+*
+*******************************************************************************/
+template <typename Predicate>
+static std::size_t compareNumerators(std::size_t count, std::uint64_t* mask, Predicate predicate) {
+	std::size_t selected = 0;
+
+	for (std::size_t block = 0; block < count; block += 64) {
+		std::size_t block_size = std::min<std::size_t>(64, count - block);
+
+		unsigned char flags[64];
+		for (std::size_t i = 0; i < block_size; ++i)
+			flags[i] = predicate(block + i);
+
+		std::uint64_t word = 0;
+		for (std::size_t i = 0; i < block_size; ++i)
+			word |= (std::uint64_t)flags[i] << i;
+
+		mask[block / 64] = word;
+		selected += __builtin_popcountll(word);
+	}
+
+	return selected;
+}
+
+
+//Applies 'comparison' to the pairs compareNumerators() passes in.
+template <typename Left, typename Right>
+static std::size_t compareWith(Comparison comparison, std::size_t count, std::uint64_t* mask,
+	Left left, Right right)
+{
+	switch (comparison) {
+	case Comparison::Less:
+		return compareNumerators(count, mask, [&](std::size_t i) { return left(i) < right(i); });
+	case Comparison::LessEqual:
+		return compareNumerators(count, mask, [&](std::size_t i) { return left(i) <= right(i); });
+	case Comparison::Greater:
+		return compareNumerators(count, mask, [&](std::size_t i) { return left(i) > right(i); });
+	case Comparison::GreaterEqual:
+		return compareNumerators(count, mask, [&](std::size_t i) { return left(i) >= right(i); });
+	case Comparison::Equal:
+		return compareNumerators(count, mask, [&](std::size_t i) { return left(i) == right(i); });
+	case Comparison::NotEqual:
+		return compareNumerators(count, mask, [&](std::size_t i) { return left(i) != right(i); });
+	}
+	return 0;
+}
+
+
+//The constructor.
+FixedDenominatorArray::FixedDenominatorArray(int denominator, std::size_t size) :
+	m_numerators(size, 0),
+	m_denominator(checkedDenominator(denominator))
+{
+}
+
+
+//A fraction n/d is a multiple of 1/denominator iff n*denominator is a multiple
+//of d (this works for unreduced fractions as well).
+FixedDenominatorArray::FixedDenominatorArray(const FractionColumns& columns, int denominator) :
+	m_numerators(columns.size()),
+	m_denominator(checkedDenominator(denominator))
+{
+	const int* numerators = columns.numerators();
+	const int* denominators = columns.denominators();
+
+	for (std::size_t i = 0; i < columns.size(); ++i) {
+		if (0 == denominators[i])
+			throw DivisionByZeroException();
+
+		long long scaled = (long long)numerators[i] * denominator;
+		if (0 != scaled % denominators[i]) {
+			throw std::invalid_argument("FixedDenominatorArray: the fraction at index " + std::to_string(i) +
+				" is not a multiple of 1/" + std::to_string(denominator));
+		}
+
+		long long numerator = scaled / denominators[i];
+		if (!fitsInt(numerator))
+			throw NumericOverflowException();
+		this->m_numerators[i] = (int)numerator;
+	}
+}
+
+
+//Uses the lcm of the denominators.
+FixedDenominatorArray::FixedDenominatorArray(const FractionColumns& columns) :
+	FixedDenominatorArray(columns, commonDenominator(columns))
+{
+}
+
+
+//Every fraction is reduced by the gcd of its numerator and the denominator.
+void FixedDenominatorArray::toColumns(FractionColumns& columns) const {
+	columns.resize(this->size());
+	int* numerators = columns.numerators();
+	int* denominators = columns.denominators();
+
+	for (std::size_t i = 0; i < this->size(); ++i) {
+		long long numerator = this->m_numerators[i];
+		long long divisor = (long long)gcd(magnitude(numerator), (unsigned long long)this->m_denominator);
+
+		numerators[i] = (int)(numerator / divisor);
+		denominators[i] = (int)(this->m_denominator / divisor);
+	}
+}
+
+
+//The numerators are summed in 64 bits in blocks small enough not to overflow,
+//and the blocks in 128 bits. The sum is reduced once.
+Fraction FixedDenominatorArray::sum() const {
+	static const std::size_t SUM_BLOCK_SIZE = (std::size_t)1 << 30;
+
+	int128 total = 0;
+	for (std::size_t block = 0; block < this->size(); block += SUM_BLOCK_SIZE) {
+		std::size_t end = std::min(this->size(), block + SUM_BLOCK_SIZE);
+
+		long long block_sum = 0;
+		for (std::size_t i = block; i < end; ++i)
+			block_sum += this->m_numerators[i];
+		total += block_sum;
+	}
+
+	int128 divisor = WideArithmetics::gcd(total, this->m_denominator);
+	int128 numerator = total / divisor;
+	int128 denominator = this->m_denominator / divisor;
+	if (!WideArithmetics::fitsInt(numerator))
+		throw NumericOverflowException();
+
+	return Fraction((int)numerator, (int)denominator);
+}
+
+
+//n/D = (n*(new/g)/(D/g))/new, where g = gcd(new, D).
+void FixedDenominatorArray::rescale(int denominator) {
+	checkedDenominator(denominator);
+
+	long long divisor = (long long)gcd((unsigned long long)denominator, (unsigned long long)this->m_denominator);
+	this->scaleNumerators(denominator / divisor, this->m_denominator / divisor, denominator);
+}
+
+
+//The gcd of the denominator and all the numerators - which usually drops to 1
+//after a few numerators, so the loop stops early.
+void FixedDenominatorArray::normalize() {
+	unsigned long long divisor = (unsigned long long)this->m_denominator;
+
+	for (std::size_t i = 0; i < this->size() && divisor > 1; ++i)
+		divisor = gcd(divisor, magnitude(this->m_numerators[i]));
+
+	if (divisor <= 1)
+		return;
+
+	for (std::size_t i = 0; i < this->size(); ++i)
+		this->m_numerators[i] = (int)(this->m_numerators[i] / (long long)divisor);
+	this->m_denominator = (int)(this->m_denominator / (long long)divisor);
+}
+
+
+//Adds the numerators with the batch add() of the running CPU's SimdLevel
+//(undone by a subtraction).
+void FixedDenominatorArray::add(const FixedDenominatorArray& other) { //x[i]+=other[i]
+	this->checkCompatible(other, "add()");
+	blockOperation(this->m_numerators.data(), other.m_numerators.data(), this->size(),
+		simdKernels().add,
+		[](unsigned numerator, unsigned other_numerator) { return numerator - other_numerator; });
+}
+
+
+//Subtracts the numerators with the batch subtract() of the running CPU's
+//SimdLevel (undone by an addition).
+void FixedDenominatorArray::subtract(const FixedDenominatorArray& other) { //x[i]-=other[i]
+	this->checkCompatible(other, "subtract()");
+	blockOperation(this->m_numerators.data(), other.m_numerators.data(), this->size(),
+		simdKernels().subtract,
+		[](unsigned numerator, unsigned other_numerator) { return numerator + other_numerator; });
+}
+
+
+//'value' is c/D for c = a*(D/b), and adding c to all the numerators overflows
+//iff it overflows the smallest or the largest one - so the check is a single
+//pass, before the array is changed.
+void FixedDenominatorArray::add(const Fraction& value) {
+	long long scaled = (long long)value.getNumerator() * this->m_denominator;
+	if (0 != scaled % value.getDenominator())
+		throw std::invalid_argument("FixedDenominatorArray::add(): the value is not a multiple of 1/" +
+			std::to_string(this->m_denominator));
+
+	long long addend = scaled / value.getDenominator();
+
+	long long low, high;
+	numeratorRange(this->m_numerators, low, high);
+	if (!fitsInt(addend) || !fitsInt(low + addend) || !fitsInt(high + addend))
+		throw NumericOverflowException();
+
+	int constant = (int)addend;
+	for (std::size_t i = 0; i < this->size(); ++i)
+		this->m_numerators[i] += constant;
+}
+
+
+//Multiplies by numerator/denominator.
+void FixedDenominatorArray::multiply(const Fraction& factor) {
+	this->multiplyBy(factor.getNumerator(), factor.getDenominator());
+}
+
+
+//x / (a/b) = x * (b/a). The reciprocal isn't built as a Fraction, since
+//|INT_MIN| doesn't fit in an 'int'.
+void FixedDenominatorArray::divide(const Fraction& divisor) {
+	if (0 == divisor.getNumerator())
+		throw DivisionByZeroException();
+
+	this->multiplyBy(divisor.getDenominator(), divisor.getNumerator());
+}
+
+
+//x = n/D and value = a/b: x < value iff n*b < a*D (both positive
+//denominators), and the products fit in 64 bits.
+std::size_t FixedDenominatorArray::compare(Comparison comparison, const Fraction& value,
+	std::uint64_t* mask) const
+{
+	long long value_denominator = value.getDenominator();
+	long long scaled_value = (long long)value.getNumerator() * this->m_denominator;
+	if (value_denominator < 0) {
+		value_denominator = -value_denominator;
+		scaled_value = -scaled_value;
+	}
+
+	const int* numerators = this->m_numerators.data();
+	return compareWith(comparison, this->size(), mask,
+		[=](std::size_t i) { return (long long)numerators[i] * value_denominator; },
+		[=](std::size_t) { return scaled_value; });
+}
+
+
+//With a shared denominator, the fractions compare as their numerators.
+std::size_t FixedDenominatorArray::compare(Comparison comparison, const FixedDenominatorArray& other,
+	std::uint64_t* mask) const
+{
+	this->checkCompatible(other, "compare()");
+
+	const int* numerators = this->m_numerators.data();
+	const int* other_numerators = other.m_numerators.data();
+	return compareWith(comparison, this->size(), mask,
+		[=](std::size_t i) { return numerators[i]; },
+		[=](std::size_t i) { return other_numerators[i]; });
+}
+
+
+//Compares the sizes and the denominators.
+void FixedDenominatorArray::checkCompatible(const FixedDenominatorArray& other, const char* function) const {
+	if (this->size() != other.size())
+		throw std::invalid_argument(std::string("FixedDenominatorArray::") + function + ": the arrays have different sizes");
+	if (this->m_denominator != other.m_denominator)
+		throw std::invalid_argument(std::string("FixedDenominatorArray::") + function + ": the arrays have different denominators");
+}
+
+
+/***
+*void FixedDenominatorArray::multiplyBy() - Multiplies every fraction by p/q
+*
+*Purpose:
+*       The sign of q is moved to p first. Then:
+*
+*           n     p       n * (p/g)
+*          --- * --- =  ------------   where g = gcd(p, D)
+*           D     q      (D/g) * q
+*
+*       so the new denominator is computed once, and every numerator is
+*       multiplied by the same integer (with no division).
+*
+*       A factor of 0 makes every numerator 0 (the denominator is kept).
+*
+*Entry:
+*       long long   numerator - p (at most 2^31 in magnitude).
+*       long long denominator - q (not 0, at most 2^31 in magnitude).
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If the denominator or a numerator doesn't
+*                                    fit in an 'int'.
+*
+*******************************************************************************/
+void FixedDenominatorArray::multiplyBy(long long numerator, long long denominator) {
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	if (0 == numerator) {
+		std::fill(this->m_numerators.begin(), this->m_numerators.end(), 0);
+		return;
+	}
+
+	long long divisor = (long long)gcd(magnitude(numerator), (unsigned long long)this->m_denominator);
+	long long new_denominator = this->m_denominator / divisor * denominator;
+	if (new_denominator > INT_MAX)
+		throw NumericOverflowException();
+
+	this->scaleNumerators(numerator / divisor, 1, (int)new_denominator);
+}
+
+
+/***
+*void FixedDenominatorArray::scaleNumerators() - Sets every numerator n to
+*                                                n*factor/divisor
+*
+*Purpose:
+*       The results are checked before the array is changed:
+*       - If the divisor is 1 (multiplying, or rescaling to a multiple of the
+*         denominator), the products are monotonic in n, so they fit iff the
+*         products of the smallest and largest numerators fit - a single
+*         vectorized pass.
+*       - Else, every product is checked to be a multiple of the divisor, and
+*         every quotient to fit.
+*       Then the numerators are scaled in a second pass.
+*
+*Entry:
+*       long long      factor - The multiplier (|factor| <= 2^31).
+*       long long     divisor - The (positive) divisor (at most INT_MAX).
+*       int       denominator - The new denominator.
+*
+*Exit:
+*
+*Exceptions:
+*       std::invalid_argument      - If a product isn't a multiple of the
+*                                    divisor.
+*       NumericOverflowException() - If a result doesn't fit in an 'int'.
+*
+*******************************************************************************/
+void FixedDenominatorArray::scaleNumerators(long long factor, long long divisor, int denominator) {
+	int* numerators = this->m_numerators.data();
+	std::size_t count = this->size();
+
+	if (1 == divisor) {
+		long long low, high;
+		numeratorRange(this->m_numerators, low, high);
+		if (!fitsInt(low * factor) || !fitsInt(high * factor))
+			throw NumericOverflowException();
+
+		for (std::size_t i = 0; i < count; ++i)
+			numerators[i] = (int)(numerators[i] * factor);
+	}
+	else {
+		for (std::size_t i = 0; i < count; ++i) {
+			long long product = numerators[i] * factor;
+			if (0 != product % divisor) {
+				throw std::invalid_argument("FixedDenominatorArray: the fraction at index " + std::to_string(i) +
+					" is not a multiple of 1/" + std::to_string(denominator));
+			}
+			if (!fitsInt(product / divisor))
+				throw NumericOverflowException();
+		}
+
+		for (std::size_t i = 0; i < count; ++i)
+			numerators[i] = (int)(numerators[i] * factor / divisor);
+	}
+
+	this->m_denominator = denominator;
+}
+
+} //namespace fraction {
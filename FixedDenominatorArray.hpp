@@ -0,0 +1,192 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the FixedDenominatorArray class
+*/
+
+
+#ifndef FIXEDDENOMINATORARRAY_HPP_
+#define FIXEDDENOMINATORARRAY_HPP_
+
+#include "Comparison.hpp"
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents an array of fractions that share one denominator - e.g.
+amounts in cents (/100), timestamps in ticks (/2^k) or in frames (/30) - stored
+as an array of integer numerators and a single positive denominator.
+
+Since the denominator is shared, adding, subtracting and comparing two arrays
+are plain integer operations on the numerators (no gcd, no multiplication and
+no reduction), in loops the compiler vectorizes. Multiplying or dividing by a
+Fraction rescales the shared denominator once, and the numerators by a single
+factor.
+
+The numerators are not reduced with the denominator - a value is reduced only
+when it's exported (with at() or toColumns()).
+
+All the operations check for overflows: if any element (or the denominator)
+would overflow an 'int', NumericOverflowException() is thrown and the array is
+left unchanged.
+The operations on two arrays throw std::invalid_argument if the arrays have
+different sizes or different denominators (see rescale()).
+*/
+class FixedDenominatorArray
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	Creates an array of 'size' zeros over 'denominator'.
+	If the denominator is 0, it throws DivisionByZeroException(), and if it's
+	negative, it throws std::invalid_argument.
+	*/
+	explicit FixedDenominatorArray(int denominator, std::size_t size = 0);
+
+	/*
+	Creates an array of the fractions in 'columns' over 'denominator'.
+
+	Every fraction must be a multiple of 1/denominator (i.e. its reduced
+	denominator divides 'denominator'), or std::invalid_argument is thrown.
+	Throws like the constructor above for a bad denominator, and
+	NumericOverflowException() if a numerator doesn't fit in an 'int'.
+	*/
+	FixedDenominatorArray(const FractionColumns& columns, int denominator);
+
+	/*
+	Creates an array of the fractions in 'columns' over their smallest common
+	denominator (the lcm of their denominators).
+	If the lcm doesn't fit in an 'int', it throws NumericOverflowException().
+	*/
+	explicit FixedDenominatorArray(const FractionColumns& columns);
+
+
+	//-- public methods --//
+
+	//Returns the number of fractions.
+	std::size_t size() const {
+		return this->m_numerators.size();
+	}
+
+	//Getter for the shared denominator
+	int getDenominator() const {
+		return this->m_denominator;
+	}
+
+	//Returns the numerators (the i-th fraction is numerators()[i]/getDenominator()).
+	int* numerators() {
+		return this->m_numerators.data();
+	}
+
+	const int* numerators() const {
+		return this->m_numerators.data();
+	}
+
+	//Appends numerator/getDenominator().
+	void pushBack(int numerator) {
+		this->m_numerators.push_back(numerator);
+	}
+
+	//Returns the i-th fraction, reduced, with the given overflow protection.
+	Fraction at(std::size_t index, bool overflowProtection = false) const {
+		return Fraction(this->m_numerators[index], this->m_denominator, overflowProtection);
+	}
+
+	//Stores all the fractions, reduced, in 'columns' (replacing their content).
+	void toColumns(FractionColumns& columns) const;
+
+	//Returns the sum of all the fractions (reduced).
+	//If it doesn't fit in a Fraction, it throws NumericOverflowException().
+	Fraction sum() const;
+
+	/*
+	Changes the shared denominator to 'denominator', without changing the
+	values.
+	Every value must be a multiple of 1/denominator (which always holds if the
+	new denominator is a multiple of the old one), or std::invalid_argument is
+	thrown.
+	*/
+	void rescale(int denominator);
+
+	//Changes the shared denominator to the smallest one that all the values
+	//are multiples of (i.e. divides it and the numerators by their gcd).
+	void normalize();
+
+	// Element-wise operations with an array of the same size and denominator.
+	void add(const FixedDenominatorArray& other); //x[i]+=other[i]
+	void subtract(const FixedDenominatorArray& other); //x[i]-=other[i]
+
+	/*
+	Adds 'value' to every fraction.
+	'value' must be a multiple of 1/getDenominator(), or std::invalid_argument
+	is thrown.
+	*/
+	void add(const Fraction& value);
+
+	/*
+	Multiplies every fraction by 'factor': the denominator is multiplied by
+	the denominator of 'factor', and the numerators by its numerator (after
+	cancelling their common factors with the denominator).
+	*/
+	void multiply(const Fraction& factor);
+
+	//Divides every fraction by 'divisor' (multiplies by its reciprocal).
+	//If the divisor is 0, it throws DivisionByZeroException().
+	void divide(const Fraction& divisor);
+
+	/*
+	Sets the bits of the fractions x for which 'x comparison value' holds, and
+	returns their number. The mask is laid out as the masks of filter(), and
+	must have SafeArithmetics::maskWords(size()) words.
+	*/
+	std::size_t compare(Comparison comparison, const Fraction& value, std::uint64_t* mask) const;
+
+	//The same as the compare() above, for 'x[i] comparison other[i]'.
+	std::size_t compare(Comparison comparison, const FixedDenominatorArray& other,
+		std::uint64_t* mask) const;
+
+private:
+	//-- private data members --//
+
+	//The numerators
+	std::vector<int> m_numerators;
+
+	//The shared denominator (always positive)
+	int m_denominator;
+
+
+	//-- private methods --//
+
+	//Throws std::invalid_argument if 'other' has a different size or
+	//denominator.
+	void checkCompatible(const FixedDenominatorArray& other, const char* function) const;
+
+	//Multiplies every fraction by numerator/denominator (see multiply()).
+	void multiplyBy(long long numerator, long long denominator);
+
+	/*
+	Sets every numerator n to n*factor/divisor (with a positive divisor), and
+	the denominator to 'denominator'.
+	If any n*factor isn't a multiple of 'divisor', it throws
+	std::invalid_argument; if any result doesn't fit in an 'int', it throws
+	NumericOverflowException(). Either way, the array is left unchanged.
+	*/
+	void scaleNumerators(long long factor, long long divisor, int denominator);
+
+}; //class FixedDenominatorArray {
+
+} //namespace fraction {
+
+#endif
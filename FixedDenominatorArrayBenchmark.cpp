@@ -0,0 +1,77 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of FixedDenominatorArray against Fractions.
+*
+* It adds two arrays of random amounts in cents element-wise, and compares them
+* element-wise, once as FixedDenominatorArrays and once as vectors of Fractions
+* (with operator+= and operator<), and prints the time per element of each.
+*/
+
+#include "Benchmark.hpp"
+#include "FixedDenominatorArray.hpp"
+#include "SafeArithmetics.hpp" //for SafeArithmetics::maskWords()
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of values in every array.
+static const std::size_t VALUES = 1 << 22;
+
+//The shared denominator (cents).
+static const int DENOMINATOR = 100;
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> distribution(-1000000, 1000000);
+
+	fraction::FixedDenominatorArray left(DENOMINATOR), right(DENOMINATOR);
+	std::vector<fraction::Fraction> left_fractions, right_fractions;
+	for (std::size_t i = 0; i < VALUES; ++i) {
+		int first = distribution(generator), second = distribution(generator);
+		left.pushBack(first);
+		right.pushBack(second);
+		left_fractions.push_back(fraction::Fraction(first, DENOMINATOR));
+		right_fractions.push_back(fraction::Fraction(second, DENOMINATOR));
+	}
+
+	std::vector<std::uint64_t> mask(SafeArithmetics::maskWords(VALUES));
+	std::size_t fixed_selected = 0, fraction_selected = 0;
+
+	double fixed_add = Benchmark::measure(VALUES, [&]() { left.add(right); });
+	double fraction_add = Benchmark::measure(VALUES, [&]() {
+		for (std::size_t i = 0; i < VALUES; ++i)
+			left_fractions[i] += right_fractions[i];
+	});
+
+	double fixed_compare = Benchmark::measure(VALUES, [&]() {
+		fixed_selected = left.compare(fraction::Comparison::Less, right, mask.data());
+	});
+	double fraction_compare = Benchmark::measure(VALUES, [&]() {
+		for (std::size_t i = 0; i < VALUES; ++i)
+			fraction_selected += left_fractions[i] < right_fractions[i];
+	});
+
+	//Both must give the same sums and the same selection.
+	for (std::size_t i = 0; i < VALUES; ++i) {
+		if (!(left.at(i) == left_fractions[i])) {
+			std::cout << "sums differ!" << std::endl;
+			return 1;
+		}
+	}
+	if (fixed_selected != fraction_selected) {
+		std::cout << "selections differ!" << std::endl;
+		return 1;
+	}
+
+	std::cout << "add:     " << fixed_add << " ns/value (fixed denominator), "
+		<< fraction_add << " ns/value (Fraction)" << std::endl;
+	std::cout << "compare: " << fixed_compare << " ns/value (fixed denominator), "
+		<< fraction_compare << " ns/value (Fraction)" << std::endl;
+}
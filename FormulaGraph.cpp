@@ -0,0 +1,288 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the FormulaGraph class
+*/
+
+#include "FormulaGraph.hpp"
+#include "Parallel.hpp"
+#include <algorithm> //for std::min, std::max
+#include <stdexcept> //for std::invalid_argument
+#include <string>
+
+
+namespace fraction {
+
+
+//The minimal number of formulas in a chunk of a level (smaller levels are
+//computed on the calling thread - starting threads costs more than that).
+static const std::size_t MIN_CHUNK_SIZE = 1 << 12;
+
+
+//Creates the bucket of level 0 (of the inputs, which is never used).
+FormulaGraph::FormulaGraph() :
+	m_buckets(1),
+	m_queued(0)
+{
+}
+
+
+//Inputs are level 0, and are stored with the overflow protection on (so the
+//formulas computed from them are checked).
+FormulaGraph::NodeId FormulaGraph::addInput(const Fraction& value) {
+	Node node;
+	node.value = value;
+	node.value.setOverflowProtection(true);
+	node.op = Operation::Input;
+	node.left = 0;
+	node.right = 0;
+	node.level = 0;
+	node.first_dependent = NO_EDGE;
+	node.queued = false;
+
+	return this->m_nodes.push(node);
+}
+
+
+//Formula nodes.
+FormulaGraph::NodeId FormulaGraph::add(NodeId left, NodeId right) { //left+right
+	return this->addFormula(Operation::Add, left, right, "add");
+}
+
+FormulaGraph::NodeId FormulaGraph::subtract(NodeId left, NodeId right) { //left-right
+	return this->addFormula(Operation::Subtract, left, right, "subtract");
+}
+
+FormulaGraph::NodeId FormulaGraph::multiply(NodeId left, NodeId right) { //left*right
+	return this->addFormula(Operation::Multiply, left, right, "multiply");
+}
+
+FormulaGraph::NodeId FormulaGraph::divide(NodeId left, NodeId right) { //left/right
+	return this->addFormula(Operation::Divide, left, right, "divide");
+}
+
+//A negation has a single operand, which is also stored as its right one.
+FormulaGraph::NodeId FormulaGraph::negate(NodeId operand) { //-operand
+	return this->addFormula(Operation::Negate, operand, operand, "negate");
+}
+
+
+//An unchanged value changes nothing. Else, the formulas that read the input
+//are queued right away (so recompute() only has to process the buckets).
+void FormulaGraph::setInput(NodeId input, const Fraction& value) {
+	if (input >= this->m_nodes.size() || !this->isInput(input))
+		throw std::invalid_argument("FormulaGraph::setInput(): node " + std::to_string(input) + " is not an input");
+
+	Node& node = this->m_nodes[input];
+	if (node.value == value)
+		return;
+
+	node.value = value;
+	node.value.setOverflowProtection(true);
+	this->enqueueDependents(input);
+}
+
+
+/***
+*std::size_t FormulaGraph::recompute() - Propagates the pending changes
+*
+*Purpose:
+*       Processes the buckets in increasing level. Every chunk of a bucket
+*       recomputes its formulas, and collects the dependents of the ones whose
+*       value changed in a list of its own. After the level is done, the
+*       lists are queued (on the calling thread, so the buckets and the
+*       'queued' flags are never written concurrently), and the bucket is
+*       cleared.
+*
+*       The formulas of a level only read nodes of lower levels, which are
+*       final by then, so the chunks are independent.
+*
+*       If a formula throws, the dependents collected so far are still
+*       queued, and the bucket of the level is kept (recomputing a formula
+*       that was already recomputed finds the same value, so it's harmless),
+*       before the exception is rethrown.
+*
+*Entry:
+*       unsigned threads - The number of threads (0 means the number of
+*                          hardware threads).
+*
+*Exit:
+*       std::size_t - The number of formulas that were recomputed.
+*
+*Exceptions:
+*       NumericOverflowException() - If a value doesn't fit in a Fraction.
+*       DivisionByZeroException()  - If a value is divided by 0.
+*
+*******************************************************************************/
+std::size_t FormulaGraph::recompute(unsigned threads) {
+	std::size_t recomputed = 0;
+	std::size_t thread_count = Parallel::threadCount(threads);
+
+	for (std::size_t level = 1; level < this->m_buckets.size() && 0 != this->m_queued; ++level) {
+		std::vector<NodeId>& bucket = this->m_buckets[level];
+		if (bucket.empty())
+			continue;
+
+		std::size_t chunks = std::max<std::size_t>(1,
+			std::min<std::size_t>(thread_count * 4, bucket.size() / MIN_CHUNK_SIZE));
+		std::size_t chunk_size = (bucket.size() + chunks - 1) / chunks;
+		std::vector<std::vector<NodeId>> changed(chunks);
+
+		auto task = [&](std::size_t chunk) {
+			std::size_t begin = chunk * chunk_size;
+			std::size_t end = std::min(bucket.size(), begin + chunk_size);
+
+			for (std::size_t i = begin; i < end; ++i) {
+				Node& node = this->m_nodes[bucket[i]];
+				Fraction value = this->compute(node);
+				if (value == node.value)
+					continue;
+
+				node.value = value;
+				for (std::size_t edge = node.first_dependent; NO_EDGE != edge; edge = this->m_edges[edge].next)
+					changed[chunk].push_back(this->m_edges[edge].dependent);
+			}
+		};
+
+		try {
+			if (1 == chunks)
+				task(0);
+			else
+				Parallel::forEach(chunks, threads, task);
+		}
+		catch (...) {
+			for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+				for (std::size_t i = 0; i < changed[chunk].size(); ++i)
+					this->enqueue(changed[chunk][i]);
+			}
+			throw;
+		}
+
+		for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+			for (std::size_t i = 0; i < changed[chunk].size(); ++i)
+				this->enqueue(changed[chunk][i]);
+		}
+
+		for (std::size_t i = 0; i < bucket.size(); ++i)
+			this->m_nodes[bucket[i]].queued = false;
+
+		recomputed += bucket.size();
+		this->m_queued -= bucket.size();
+		bucket.clear();
+	}
+
+	return recomputed;
+}
+
+
+/***
+*FormulaGraph::NodeId FormulaGraph::addFormula() - Adds a formula node
+*
+*Purpose:
+*       The level of the formula is 1 more than the highest level of its
+*       operands. It's added to the dependents of its operands (once, if both
+*       are the same node), and queued, so its value is computed by the next
+*       recompute().
+*
+*Entry:
+*       Operation          op - The operation.
+*       NodeId           left - The left operand.
+*       NodeId          right - The right operand.
+*       const char*  function - The name of the calling method (for the
+*                               message of the exception).
+*
+*Exit:
+*       NodeId - The new node.
+*
+*Exceptions:
+*       std::invalid_argument - If an operand doesn't exist.
+*
+*******************************************************************************/
+FormulaGraph::NodeId FormulaGraph::addFormula(Operation op, NodeId left, NodeId right, const char* function) {
+	if (left >= this->m_nodes.size() || right >= this->m_nodes.size()) {
+		throw std::invalid_argument(std::string("FormulaGraph::") + function + "(): no node " +
+			std::to_string(std::max(left, right)));
+	}
+
+	Node node;
+	node.op = op;
+	node.left = left;
+	node.right = right;
+	node.level = 1 + std::max(this->m_nodes[left].level, this->m_nodes[right].level);
+	node.first_dependent = NO_EDGE;
+	node.queued = false;
+
+	NodeId id = this->m_nodes.push(node);
+
+	this->addDependent(left, id);
+	if (right != left)
+		this->addDependent(right, id);
+
+	if (node.level >= this->m_buckets.size())
+		this->m_buckets.resize(node.level + 1);
+	this->enqueue(id);
+
+	return id;
+}
+
+
+//Prepends the edge to the list.
+void FormulaGraph::addDependent(NodeId node, NodeId dependent) {
+	Edge edge;
+	edge.dependent = dependent;
+	edge.next = this->m_nodes[node].first_dependent;
+
+	this->m_nodes[node].first_dependent = this->m_edges.push(edge);
+}
+
+
+//The 'queued' flag keeps a formula from being in its bucket twice.
+void FormulaGraph::enqueue(NodeId node) {
+	Node& record = this->m_nodes[node];
+	if (record.queued)
+		return;
+
+	record.queued = true;
+	this->m_buckets[record.level].push_back(node);
+	++this->m_queued;
+}
+
+
+//Queues every formula in the dependents list of 'node'.
+void FormulaGraph::enqueueDependents(NodeId node) {
+	for (std::size_t edge = this->m_nodes[node].first_dependent; NO_EDGE != edge; edge = this->m_edges[edge].next)
+		this->enqueue(this->m_edges[edge].dependent);
+}
+
+
+//The operands are protected, so the result is checked for overflows.
+Fraction FormulaGraph::compute(const Node& node) const {
+	Fraction result = this->m_nodes[node.left].value;
+	const Fraction& right = this->m_nodes[node.right].value;
+
+	switch (node.op) {
+	case Operation::Add:
+		result += right;
+		break;
+	case Operation::Subtract:
+		result -= right;
+		break;
+	case Operation::Multiply:
+		result *= right;
+		break;
+	case Operation::Divide:
+		result /= right;
+		break;
+	case Operation::Negate:
+		result = -result;
+		break;
+	case Operation::Input:
+		break;
+	}
+
+	return result;
+}
+
+} //namespace fraction {
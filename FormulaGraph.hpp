@@ -0,0 +1,193 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the FormulaGraph class
+*/
+
+
+#ifndef FORMULAGRAPH_HPP_
+#define FORMULAGRAPH_HPP_
+
+#include "Arena.hpp"
+#include "Fraction.hpp"
+#include <cstddef> //for std::size_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents a graph of interdependent fraction formulas - e.g. a
+sheet whose cells are computed from other cells - that is recomputed
+incrementally.
+
+Every node is either an input, whose value is set directly, or a formula: an
+arithmetic operation on one or two other nodes (which must already exist, so
+the graph has no cycles). The nodes and their edges are stored in arenas.
+
+Every formula has a level: 1 more than the highest level of its operands
+(inputs are level 0). So the nodes of a level depend only on lower levels, and
+can be computed in any order - and in parallel.
+
+Changes are batched: setInput() only records the change, and recompute()
+propagates all the changes made since the last time in a single pass:
+- The formulas that read a changed input are queued by their level.
+- The levels are processed in increasing order. A formula is recomputed only
+  if it's queued, and only if its value actually changed, are the formulas
+  that read it queued (so a change that's absorbed, e.g. by a multiplication
+  by 0, stops there).
+- A level with many queued formulas is computed in parallel chunks.
+
+Values are computed with the overflow protection on. If a formula throws
+(NumericOverflowException() or DivisionByZeroException()), recompute()
+rethrows it, and the formulas that weren't recomputed stay queued - so after
+the inputs are fixed, the next recompute() finishes the propagation.
+*/
+class FormulaGraph
+{
+public:
+	//-- public types --//
+
+	//The index of a node (nodes are numbered 0, 1, 2, ... in the order they're
+	//added).
+	typedef std::size_t NodeId;
+
+
+	//-- constructors/destructor --//
+
+	//Creates an empty graph.
+	FormulaGraph();
+
+	FormulaGraph(const FormulaGraph&) = delete;
+	FormulaGraph& operator= (const FormulaGraph&) = delete;
+
+
+	//-- public methods --//
+
+	//Adds an input with the value 'value'.
+	NodeId addInput(const Fraction& value);
+
+	/*
+	Add formula nodes on existing nodes (or throw std::invalid_argument).
+	The value of a new formula is computed by the next recompute() (until then,
+	it's 0).
+	*/
+	NodeId add(NodeId left, NodeId right); //left+right
+	NodeId subtract(NodeId left, NodeId right); //left-right
+	NodeId multiply(NodeId left, NodeId right); //left*right
+	NodeId divide(NodeId left, NodeId right); //left/right
+	NodeId negate(NodeId operand); //-operand
+
+	/*
+	Sets the value of the input 'input' (or throws std::invalid_argument if
+	it's not an input). The formulas that depend on it are updated by the next
+	recompute().
+	*/
+	void setInput(NodeId input, const Fraction& value);
+
+	/*
+	Recomputes the formulas affected by the changes since the last call, on
+	'threads' threads (0 means the number of hardware threads), and returns
+	the number of formulas that were recomputed.
+	*/
+	std::size_t recompute(unsigned threads = 0);
+
+	//Returns the value of 'node' as of the last recompute() (or as set, for an
+	//input).
+	const Fraction& value(NodeId node) const {
+		return this->m_nodes[node].value;
+	}
+
+	//Returns 'true' if 'node' is an input.
+	bool isInput(NodeId node) const {
+		return Operation::Input == this->m_nodes[node].op;
+	}
+
+	//Returns the number of nodes.
+	std::size_t size() const {
+		return this->m_nodes.size();
+	}
+
+	//Returns 'true' if there are formulas waiting for recompute().
+	bool hasPendingChanges() const {
+		return 0 != this->m_queued;
+	}
+
+private:
+	//-- private types --//
+
+	//What a node computes.
+	enum class Operation {
+		Input,
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Negate
+	};
+
+	//The value "no edge" in the dependents lists.
+	static const std::size_t NO_EDGE = ~std::size_t(0);
+
+	//A node.
+	struct Node {
+		Fraction value;
+		Operation op;
+		NodeId left;
+		NodeId right;
+		std::size_t level;
+
+		//The first edge of the list of the formulas that read this node
+		std::size_t first_dependent;
+
+		//'true' while the node is in a bucket (waiting to be recomputed)
+		bool queued;
+	};
+
+	//An entry of the list of the formulas that read a node.
+	struct Edge {
+		NodeId dependent;
+		std::size_t next;
+	};
+
+
+	//-- private data members --//
+
+	//The nodes
+	Arena<Node> m_nodes;
+
+	//The edges of all the dependents lists
+	Arena<Edge> m_edges;
+
+	//The queued formulas of every level (m_buckets[0] is always empty)
+	std::vector<std::vector<NodeId>> m_buckets;
+
+	//The number of queued formulas
+	std::size_t m_queued;
+
+
+	//-- private methods --//
+
+	//Adds the formula 'left op right', and queues it.
+	NodeId addFormula(Operation op, NodeId left, NodeId right, const char* function);
+
+	//Adds 'dependent' to the dependents list of 'node'.
+	void addDependent(NodeId node, NodeId dependent);
+
+	//Queues 'node' in the bucket of its level, unless it's already queued.
+	void enqueue(NodeId node);
+
+	//Queues the formulas that read 'node'.
+	void enqueueDependents(NodeId node);
+
+	//Returns the value of the formula 'node' from the values of its operands.
+	Fraction compute(const Node& node) const;
+
+}; //class FormulaGraph {
+
+} //namespace fraction {
+
+#endif
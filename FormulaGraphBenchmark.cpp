@@ -0,0 +1,68 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of FormulaGraph.
+*
+* It builds a layered graph - every formula adds or subtracts two nodes of the
+* previous layer - and times the first (full) recompute(), and incremental
+* recompute()s after changing a single input and after a batch of 100 inputs.
+*/
+
+#include "Benchmark.hpp"
+#include "FormulaGraph.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <random>
+
+
+//The number of inputs, and the number and width of the layers of formulas
+//(the values at most double in every layer, so they fit in a Fraction).
+static const std::size_t INPUTS = 16384;
+static const std::size_t LAYERS = 16;
+static const std::size_t WIDTH = 16384;
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> value_distribution(1, 10);
+	std::uniform_int_distribution<std::size_t> offset_distribution(0, 7);
+
+	fraction::FormulaGraph graph;
+	for (std::size_t i = 0; i < INPUTS; ++i)
+		graph.addInput(fraction::Fraction(value_distribution(generator), value_distribution(generator) % 4 + 1));
+
+	//Every formula reads nodes close to its position in the previous layer, so
+	//a change spreads out gradually.
+	std::size_t previous = 0;
+	for (std::size_t layer = 0; layer < LAYERS; ++layer) {
+		std::size_t first = graph.size();
+		for (std::size_t i = 0; i < WIDTH; ++i) {
+			std::size_t left = previous + (i + offset_distribution(generator)) % WIDTH;
+			std::size_t right = previous + (i + WIDTH - offset_distribution(generator)) % WIDTH;
+			if (i % 2)
+				graph.add(left, right);
+			else
+				graph.subtract(left, right);
+		}
+		previous = first;
+	}
+
+	std::size_t recomputed = 0;
+	double full = Benchmark::measure(1, [&]() { recomputed = graph.recompute(); });
+	std::cout << "full:       " << full << " ns/recompute (" << recomputed << " formulas)" << std::endl;
+
+	double single = Benchmark::measure(1, [&]() {
+		graph.setInput(INPUTS / 2, fraction::Fraction(7, 3));
+		recomputed = graph.recompute();
+	});
+	std::cout << "1 input:    " << single << " ns/recompute (" << recomputed << " formulas)" << std::endl;
+
+	double batch = Benchmark::measure(1, [&]() {
+		for (std::size_t i = 0; i < 100; ++i)
+			graph.setInput(i * (INPUTS / 100), fraction::Fraction(value_distribution(generator), 4));
+		recomputed = graph.recompute();
+	});
+	std::cout << "100 inputs: " << batch << " ns/recompute (" << recomputed << " formulas)" << std::endl;
+}
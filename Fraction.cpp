@@ -7,11 +7,15 @@
 * and the ProtectedVector class
 */
 
+#ifndef FRACTION_CPP_
+#define FRACTION_CPP_
+
 #include "Fraction.hpp"
 #include "SafeArithmetics.hpp"
 #include "DivisionByZeroException.hpp"
 #include "NumericOverflowException.hpp"
 #include "Utilities.hpp" //For Utilities::isInteger() and Utilities::gcd()
+#include <climits> //for INT_MIN, INT_MAX
 #include <iostream>
 #include <string> //Used in operator>>
 #include <cstddef> //for std::size_t
@@ -22,11 +26,33 @@ namespace fraction {
 
 //The overall numeric overflow protection of 2 Fractions is 'true' if atleast
 //one of the Fractions has the protection.
-static bool getOverallProtection(const Fraction& frac1, const Fraction& frac2) {
+FRACTION_STATIC bool getOverallProtection(const Fraction& frac1, const Fraction& frac2) {
 	return frac1.getOverflowProtection() || frac2.getOverflowProtection();
 }
 
 
+//Returns the greatest common divisor of |num1| and |num2| (which, unlike
+//Utilities::gcd(), is always non-negative, and is 2^31 for gcd(INT_MIN,0)).
+//'num2' is at most 2^31 in magnitude, so after the first (64-bit) remainder
+//the rest of the Euclidean algorithm uses 32-bit divisions, which are faster.
+FRACTION_STATIC long long wideGcd(long long num1, long long num2) {
+	unsigned long long first = (num1 < 0) ? 0ull - (unsigned long long)num1 : (unsigned long long)num1;
+	unsigned second = (unsigned)((num2 < 0) ? 0ull - (unsigned long long)num2 : (unsigned long long)num2);
+
+	if (0 == second)
+		return (long long)first;
+
+	unsigned remainder = (unsigned)(first % second);
+	while (0 != remainder) {
+		unsigned next = second % remainder;
+		second = remainder;
+		remainder = next;
+	}
+
+	return second;
+}
+
+
 /***
 * bool getFractionPart()
 *
@@ -70,7 +96,7 @@ static bool getOverallProtection(const Fraction& frac1, const Fraction& frac2) {
 *Exceptions:
 *
 *******************************************************************************/
-static bool getFractionPart(const std::string& input, std::size_t start_index,
+FRACTION_STATIC bool getFractionPart(const std::string& input, std::size_t start_index,
 	std::size_t end_index, int& num, bool overflow_protection, bool& numeric_overflow_occured)
 {
 	try {
@@ -90,12 +116,12 @@ static bool getFractionPart(const std::string& input, std::size_t start_index,
 
 
 // + operator
-Fraction operator+ (const Fraction& frac) {
+FRACTION_INLINE Fraction operator+ (const Fraction& frac) {
 	return frac;
 }
 
 //- operator
-Fraction operator- (const Fraction& frac) {
+FRACTION_INLINE Fraction operator- (const Fraction& frac) {
 	return frac * (-1);
 }
 
@@ -108,19 +134,19 @@ Fraction operator- (const Fraction& frac) {
 
 //Returns 'true' if the calling object and the one from the input have the
 //numerators and denominators.
-bool Fraction::operator== (const Fraction& frac) const { //frac1==frac2
+FRACTION_INLINE bool Fraction::operator== (const Fraction& frac) const { //frac1==frac2
 	return (this->m_numerator == frac.m_numerator && this->m_denominator == frac.m_denominator);
 }
 
 
 //Transforms the integer to Fraction, and calls operator== on Fraction objects.
-bool operator== (const Fraction& lhs, int number) { //lhs==number
+FRACTION_INLINE bool operator== (const Fraction& lhs, int number) { //lhs==number
 	return lhs==Fraction(number);
 }
 
 
 //number == rhs iff rhs == number.
-bool operator== (int number, const Fraction& rhs) { //number==rhs
+FRACTION_INLINE bool operator== (int number, const Fraction& rhs) { //number==rhs
 	return rhs==number;
 }
 
@@ -129,19 +155,19 @@ bool operator== (int number, const Fraction& rhs) { //number==rhs
 
 
 //lhs != rhs iff !(lhs == rhs)
-bool operator!= (const Fraction& lhs, const Fraction& rhs) { //lhs!=rhs
+FRACTION_INLINE bool operator!= (const Fraction& lhs, const Fraction& rhs) { //lhs!=rhs
 	return !(lhs==rhs);
 }
 
 
 //lhs != number iff !(lhs == number)
-bool operator!= (const Fraction& lhs, int number) { //lhs==number
+FRACTION_INLINE bool operator!= (const Fraction& lhs, int number) { //lhs==number
 	return !(lhs==number);
 }
 
 
 //number != rhs iff !(number == rhs)
-bool operator!= (int number, const Fraction& rhs) { //number==rhs
+FRACTION_INLINE bool operator!= (int number, const Fraction& rhs) { //number==rhs
 	return !(rhs==number);
 }
 
@@ -151,21 +177,31 @@ bool operator!= (int number, const Fraction& rhs) { //number==rhs
 
 //lhs < rhs iff (lhs-rhs) < 0.
 //lhs-rhs is negative iff its sign() is -1.
-bool Fraction::operator< (const Fraction& rhs) const { //lhs<rhs
+//
+//If the small value tables are enabled, small fractions are compared by
+//cross-multiplying instead (the products fit in an 'int').
+FRACTION_INLINE bool Fraction::operator< (const Fraction& rhs) const { //lhs<rhs
+#ifdef FRACTION_SMALL_VALUE_TABLES
+	if (SmallValueTables::defaultTable().inBound(this->m_numerator, this->m_denominator,
+		rhs.m_numerator, rhs.m_denominator))
+	{
+		return this->m_numerator * rhs.m_denominator < rhs.m_numerator * this->m_denominator;
+	}
+#endif
 	return ((*this)-rhs).sign() < 0;
 }
 
 
 //Transforms the integer to Fraction, and calls operator< on both
 //Fractions.
-bool operator< (const Fraction& lhs, int number) { //lhs<number
+FRACTION_INLINE bool operator< (const Fraction& lhs, int number) { //lhs<number
 	return lhs < Fraction(number);
 }
 
 
 //Transforms the integer to Fraction, and calls operator< on both
 //Fractions.
-bool operator< (int number, const Fraction& rhs) { //number<rhs
+FRACTION_INLINE bool operator< (int number, const Fraction& rhs) { //number<rhs
 	return Fraction(number) < rhs;
 }
 
@@ -174,19 +210,19 @@ bool operator< (int number, const Fraction& rhs) { //number<rhs
 
 
 //(lhs <= rhs) iff !(rhs < lhs)
-bool operator<= (const Fraction& lhs, const Fraction& rhs) { //lhs<=rhs
+FRACTION_INLINE bool operator<= (const Fraction& lhs, const Fraction& rhs) { //lhs<=rhs
 	return !(rhs < lhs);
 }
 
 
 //(lhs <= number) iff !(number < lhs)
-bool operator<= (const Fraction& lhs, int number) { //lhs<=number
+FRACTION_INLINE bool operator<= (const Fraction& lhs, int number) { //lhs<=number
 	return !(number < lhs);
 }
 
 
 //lhs <= rhs iff !(rhs < lhs)
-bool operator<= (int number, const Fraction& rhs) { //number<=rhs
+FRACTION_INLINE bool operator<= (int number, const Fraction& rhs) { //number<=rhs
 	return !(rhs < number);
 }
 
@@ -195,18 +231,18 @@ bool operator<= (int number, const Fraction& rhs) { //number<=rhs
 
 
 //(lhs > rhs) iff (rhs < lhs)
-bool operator> (const Fraction& lhs, const Fraction& rhs) { //lhs>rhs
+FRACTION_INLINE bool operator> (const Fraction& lhs, const Fraction& rhs) { //lhs>rhs
 	return rhs < lhs;
 }
 
 
 //(lhs > number) iff (number < lhs)
-bool operator> (const Fraction& lhs, int number) { //lhs>number
+FRACTION_INLINE bool operator> (const Fraction& lhs, int number) { //lhs>number
 	return number < lhs;
 }
 
 //(number > rhs) iff (rhs < number)
-bool operator> (int number, const Fraction& rhs) { //number>rhs
+FRACTION_INLINE bool operator> (int number, const Fraction& rhs) { //number>rhs
 	return rhs < number;
 }
 
@@ -215,17 +251,17 @@ bool operator> (int number, const Fraction& rhs) { //number>rhs
 
 
 //(lhs >= rhs) iff !(lhs < rhs)
-bool operator>= (const Fraction& lhs, const Fraction& rhs) { //lhs>=rhs
+FRACTION_INLINE bool operator>= (const Fraction& lhs, const Fraction& rhs) { //lhs>=rhs
 	return !(lhs < rhs);
 }
 
 //(lhs >= number) iff !(lhs < number)
-bool operator>= (const Fraction& lhs, int number) { //lhs>=number
+FRACTION_INLINE bool operator>= (const Fraction& lhs, int number) { //lhs>=number
 	return !(lhs < number);
 }
 
 //(number >= rhs) iff !(number < rhs)
-bool operator>= (int number, const Fraction& rhs) { //number>=rhs
+FRACTION_INLINE bool operator>= (int number, const Fraction& rhs) { //number>=rhs
 	return !(number < rhs);
 }
 
@@ -239,20 +275,20 @@ bool operator>= (int number, const Fraction& rhs) { //number>=rhs
 //First it sets the overflow protection of 'lhs' to be the overall
 //protection of the 2 Fractions.
 //Then it call 'lhs+=rhs', and returns 'lhs'.
-Fraction operator+ (Fraction lhs, const Fraction& rhs) { //lhs+rhs
+FRACTION_INLINE Fraction operator+ (Fraction lhs, const Fraction& rhs) { //lhs+rhs
 	lhs.setOverflowProtection(getOverallProtection(lhs,rhs));
 	lhs+=rhs;
 	return lhs;
 }
 
 //Simply calls 'lhs+=number' - we don't change the overflow protection.
-Fraction operator+ (Fraction lhs, int number) { //lhs+number
+FRACTION_INLINE Fraction operator+ (Fraction lhs, int number) { //lhs+number
 	lhs+=number;
 	return lhs;
 }
 
 //(number+rhs) is the same as (rhs+number)
-Fraction operator+ (int number, const Fraction& rhs) { //number+rhs
+FRACTION_INLINE Fraction operator+ (int number, const Fraction& rhs) { //number+rhs
 	return rhs+number;
 }
 
@@ -264,21 +300,21 @@ Fraction operator+ (int number, const Fraction& rhs) { //number+rhs
 //First it sets the overflow protection of 'lhs' to be the overall
 //protection of the 2 Fractions.
 //Then it call 'lhs-=rhs', and returns 'lhs'.
-Fraction operator- (Fraction lhs, const Fraction& rhs) { //lhs+rhs
+FRACTION_INLINE Fraction operator- (Fraction lhs, const Fraction& rhs) { //lhs+rhs
 	lhs.setOverflowProtection(getOverallProtection(lhs, rhs));
 	lhs -= rhs;
 	return lhs;
 }
 
 //Simply calls 'lhs-=number' - we don't change the overflow protection.
-Fraction operator- (Fraction lhs, int number) { //lhs-number
+FRACTION_INLINE Fraction operator- (Fraction lhs, int number) { //lhs-number
 	lhs -= Fraction(number);
 	return lhs;
 }
 
 //We create a copy of 'number', and call operator-= on that object.
 //So (number -= rhs) will be (Fraction(number) -= rhs).
-Fraction operator- (int number, const Fraction& rhs) { //number-rhs
+FRACTION_INLINE Fraction operator- (int number, const Fraction& rhs) { //number-rhs
 	Fraction number_frac = Fraction(number);
 	number_frac -= rhs;
 	return number_frac;
@@ -291,20 +327,20 @@ Fraction operator- (int number, const Fraction& rhs) { //number-rhs
 //First it sets the overflow protection of 'lhs' to be the overall
 //protection of the 2 Fractions.
 //Then it call 'lhs*=rhs', and returns 'lhs'.
-Fraction operator* (Fraction lhs, const Fraction& rhs) { //lhs*rhs
+FRACTION_INLINE Fraction operator* (Fraction lhs, const Fraction& rhs) { //lhs*rhs
 	lhs.setOverflowProtection(getOverallProtection(lhs, rhs));
 	lhs *= rhs;
 	return lhs;
 }
 
 //Simply calls 'lhs*=number' - we don't change the overflow protection.
-Fraction operator* (Fraction lhs, int number) { //lhs*number
+FRACTION_INLINE Fraction operator* (Fraction lhs, int number) { //lhs*number
 	lhs *= Fraction(number);
 	return lhs;
 }
 
 //(number * rhs) is the same as (rhs * number)
-Fraction operator* (int number, const Fraction& rhs) { //number*rhs
+FRACTION_INLINE Fraction operator* (int number, const Fraction& rhs) { //number*rhs
 	return rhs*number;
 }
 
@@ -315,7 +351,7 @@ Fraction operator* (int number, const Fraction& rhs) { //number*rhs
 //First it sets the overflow protection of 'lhs' to be the overall
 //protection of the 2 Fractions.
 //Then it call 'lhs/=rhs', and returns 'lhs'.
-Fraction operator/ (Fraction lhs, const Fraction& rhs) { // lhs/rhs
+FRACTION_INLINE Fraction operator/ (Fraction lhs, const Fraction& rhs) { // lhs/rhs
 	lhs.setOverflowProtection(getOverallProtection(lhs, rhs));
 	lhs /= rhs;
 	return lhs;
@@ -323,7 +359,7 @@ Fraction operator/ (Fraction lhs, const Fraction& rhs) { // lhs/rhs
 }
 
 //Simply calls 'lhs/=number' - we don't change the overflow protection.
-Fraction operator/ (Fraction lhs, int number) { // lhs/number
+FRACTION_INLINE Fraction operator/ (Fraction lhs, int number) { // lhs/number
 	lhs /= Fraction(number);
 	return lhs;
 }
@@ -331,7 +367,7 @@ Fraction operator/ (Fraction lhs, int number) { // lhs/number
 
 //We create a copy of 'number', and call operator/= on that object.
 //So (number /= rhs) will be (Fraction(number) /= rhs).
-Fraction operator/ (int number, const Fraction& rhs) { // number/rhs
+FRACTION_INLINE Fraction operator/ (int number, const Fraction& rhs) { // number/rhs
 	Fraction number_frac = Fraction(number);
 	number_frac /= rhs;
 	return number_frac;
@@ -344,97 +380,69 @@ Fraction operator/ (int number, const Fraction& rhs) { // number/rhs
 // += operators
 
 
-/*
-We know that a/b + c/d = (ad + bc)/bd.
-A different way to write it is:
-
-       d               b
-a * -------- + c * --------
-    gcd(b,d)       gcd(b,d)
-----------------------------
-      (b*d)/gcd(b,d)
-
-The benefit of calculating this way is that it reduces the chances of an overflow
-to occur.
-
-So the new numerator would be 'a * (d/gcd(b,d)) + c * (b/gcd(b,d))'
-and the denominator would be '(b * d)/gcd(b,d)'.
-
-
-Note that we're using 'SafeArithmetics' if the numeric overflow protection is
-on.
-Else, we're using normal operators.
-*/
-Fraction& Fraction::operator+= (const Fraction& rhs) & {
-
-	/* 
-
-	 
-                    ad+bc
-    a/b + c/d =  ------------
-                     b*d
-
-	OR:
-
-                     ad+bc
-                    -------
-    a/b + c/d =     gcd(b,d)
-                  ------------
-                  (b*d)/gcd(b,d)
-
-    OR:
-
-                        d               b
-                 a * -------- + c * --------
-    a/b + c/d =      gcd(b,d)       gcd(b,d)
-				 ----------------------------
-                         (b*d)/gcd(b,d)
-	*/
-
-	int a = this->m_numerator;
-	int b = this->m_denominator;
-
-	int c = rhs.m_numerator;
-	int d = rhs.m_denominator;
-
-	int gcd = Utilities::gcd(b, d);
-
-	int numerator, denominator;
-
-	if (this->m_overflow_protection) {
-
-		// d/gcd
-		int d_gcd = SafeArithmetics::divide(d, gcd);
-
-		//a*d/gcd
-		int numerator1 = SafeArithmetics::multiply(a, d_gcd);
-		//c*b/gcd
-		int numerator2 = SafeArithmetics::multiply(c, SafeArithmetics::divide(b,gcd));
+/***
+*Fraction& Fraction::operator+=() - Adds a Fraction (Knuth's algorithm)
+*
+*Purpose:
+*       Both fractions are reduced, so with g1 = gcd(b,d):
+*
+*                         a*(d/g1) + c*(b/g1)        t
+*           a/b + c/d =  ---------------------  =  ----------
+*                             (b/g1)*d              (b/g1)*d
+*
+*       and a common factor of t and the denominator can only be a factor of
+*       g1 (since t is co-prime to b/g1 and d/g1). So with g2 = gcd(t,g1):
+*
+*                           t/g2
+*           a/b + c/d =  -----------
+*                        (b/g1)*(d/g2)
+*
+*       which is already reduced - no gcd of the (large) result is needed,
+*       and both gcds are of numbers no larger than the denominators.
+*
+*       The intermediates are 'long long's, which can't overflow (every
+*       product is less than 2^62), so an overflow is detected only if the
+*       result itself doesn't fit in an 'int' - not when an intermediate
+*       product does.
+*
+*Entry:
+*       const Fraction& rhs - The added Fraction.
+*
+*Exit:
+*       Fraction& - *this.
+*
+*Exceptions:
+*       NumericOverflowException() - If the overflow protection is on and the
+*                                    sum doesn't fit in a Fraction.
+*
+*******************************************************************************/
+FRACTION_INLINE Fraction& Fraction::operator+= (const Fraction& rhs) & {
+	long long a = this->m_numerator;
+	long long b = this->m_denominator;
 
-		//a*d/gcd + c*b/gcd
-		numerator = SafeArithmetics::add(numerator1, numerator2);
+	long long c = rhs.m_numerator;
+	long long d = rhs.m_denominator;
 
-		//b*d/gcd
-		denominator = SafeArithmetics::multiply(b, d_gcd);
-	}
-	else {
-		int d_gcd = d / gcd;
+	long long gcd1 = wideGcd(b, d);
 
-		numerator = a*d_gcd + c*(b / gcd);
-		denominator = b*d_gcd;
+	//Co-prime denominators (the common case for random fractions) need no
+	//second gcd.
+	if (1 == gcd1) {
+		this->assignReduced(a*d + c*b, b*d);
+		return *this;
 	}
 
-	//Set the calling object's numerator and denominator to the ones we computed.
-	this->setNumerator(numerator);
-	this->setDenominator(denominator);
+	long long b_gcd = b / gcd1;
+	long long t = a*(d / gcd1) + c*b_gcd;
+	long long gcd2 = wideGcd(t, gcd1);
 
-	//And finally, return *this.
+	this->assignReduced(t / gcd2, b_gcd * (d / gcd2));
 	return *this;
 }
 
 
 //Transforms the integer to a Fraction, and call operator+= with that object.
-Fraction& Fraction::operator+= (int number) & { //lhs+=number
+FRACTION_INLINE Fraction& Fraction::operator+= (int number) & { //lhs+=number
 	*this += Fraction(number);
 	return *this;
 }
@@ -444,14 +452,14 @@ Fraction& Fraction::operator+= (int number) & { //lhs+=number
 
 
 //(lhs -= rhs) is the same as (lhs += (-rhs)).
-Fraction& Fraction::operator-= (const Fraction& rhs) & { //lhs-=rhs
+FRACTION_INLINE Fraction& Fraction::operator-= (const Fraction& rhs) & { //lhs-=rhs
 	*this += (-rhs);
 	return *this;
 }
 
 //Transforms the integer to a Fraction, and then we call 
 //(lhs -= Fraction(number)).
-Fraction& Fraction::operator-= (int number) & { //lhs-=number
+FRACTION_INLINE Fraction& Fraction::operator-= (int number) & { //lhs-=number
 	*this -= (Fraction(number));
 	return *this;
 }
@@ -460,43 +468,14 @@ Fraction& Fraction::operator-= (int number) & { //lhs-=number
 // *= operators
 
 
-/*
-We know that a/b * c/d = ac/bd
-So in order to compute the numerator of the product, we compute the product
-of the Fraction's numerators.
-We do a similar thing while computing the denominator.
-
-Note that we're using 'SafeArithmetics' if the numeric overflow protection is
-on.
-Else, we're using normal multiplication.
-*/
-Fraction& Fraction::operator*= (const Fraction& lhs) & { //rhs*=lhs
-
-	//The new numerator and denominator of the calling object.
-	int numerator, denominator;
-
-	if (this->m_overflow_protection) {
-		numerator = SafeArithmetics::multiply(this->m_numerator, lhs.m_numerator);
-
-		denominator = SafeArithmetics::multiply(this->m_denominator, lhs.m_denominator);
-
-	}
-	else {
-		numerator = this->m_numerator * lhs.m_numerator;
-		denominator = this->m_denominator * lhs.m_denominator;
-	}
-
-	//Set the calling object's numerator and denominator to the ones we computed.
-	this->setNumerator(numerator);
-	this->setDenominator(denominator);
-
-	//And finally, return *this.
+//Multiplies by the numerator and denominator of 'rhs' (see multiplyBy()).
+FRACTION_INLINE Fraction& Fraction::operator*= (const Fraction& rhs) & { //lhs*=rhs
+	this->multiplyBy(rhs.m_numerator, rhs.m_denominator);
 	return *this;
-
 }
 
 //Transforms the integer to a Fraction, and call operator*= with that object.
-Fraction& Fraction::operator*= (int number) & { //lhs*=number
+FRACTION_INLINE Fraction& Fraction::operator*= (int number) & { //lhs*=number
 	*this *= Fraction(number);
 	return *this;
 }
@@ -507,17 +486,21 @@ Fraction& Fraction::operator*= (int number) & { //lhs*=number
 
 //We know that
 // a/b / c/d =  a/b * (d/c).
-//So we create a Fraction which is (1/rhs).
-//i.e. its numerator is rhs's denominator, and its denominator is rhs's numerator.
-Fraction& Fraction::operator/= (const Fraction& rhs) & { // lhs/=rhs
-	*this *= Fraction(rhs.getDenominator(), rhs.getNumerator());
+//So we multiply by rhs's denominator over rhs's numerator (without creating
+//the Fraction d/c, whose sign can't be fixed if c is INT_MIN).
+//If rhs is 0, it throws DivisionByZeroException().
+FRACTION_INLINE Fraction& Fraction::operator/= (const Fraction& rhs) & { // lhs/=rhs
+	if (0 == rhs.m_numerator)
+		throw DivisionByZeroException();
+
+	this->multiplyBy(rhs.m_denominator, rhs.m_numerator);
 	return *this;
 }
 
 
 //Transforms the integer to a Fraction, and then we call 
 //(lhs /= Fraction(number)).
-Fraction& Fraction::operator/= (int number) & { // lhs/=number
+FRACTION_INLINE Fraction& Fraction::operator/= (int number) & { // lhs/=number
 	*this /= Fraction(number);
 	return *this;
 }
@@ -535,7 +518,7 @@ Prefix operator++
 Calls operator+=(1) on *this.
 Returns *this.
 */
-Fraction& Fraction::operator++ () & { //prefix ++frac
+FRACTION_INLINE Fraction& Fraction::operator++ () & { //prefix ++frac
 	*this += 1;
 	return *this;
 }
@@ -548,7 +531,7 @@ Creates a copy of *this.
 Calls operator++ prefix on *this.
 Returns the copy.
 */
-Fraction Fraction::operator++ (int) & { //postfix frac++
+FRACTION_INLINE Fraction Fraction::operator++ (int) & { //postfix frac++
 	Fraction new_frac = *this;
 	++*this;
 	return new_frac;
@@ -564,7 +547,7 @@ Prefix operator--
 Calls operator-=(1) on *this.
 Returns *this.
 */
-Fraction& Fraction::operator-- () & { //prefix --frac
+FRACTION_INLINE Fraction& Fraction::operator-- () & { //prefix --frac
 	*this -= 1;
 	return *this;
 }
@@ -576,7 +559,7 @@ Creates a copy of *this.
 Calls operator-- prefix on *this.
 Returns the copy.
 */
-Fraction Fraction::operator-- (int) & { //postfix frac--
+FRACTION_INLINE Fraction Fraction::operator-- (int) & { //postfix frac--
 	Fraction new_frac = *this;
 	--*this;
 	return new_frac;
@@ -595,7 +578,7 @@ Prints the fraction in the following way:
                                                       print "5" instead)
 4) Else, it print "'numerator'/'denominator'".
 */
-std::ostream& operator<< (std::ostream& os, const Fraction& frac) {
+FRACTION_INLINE std::ostream& operator<< (std::ostream& os, const Fraction& frac) {
 	int numerator = frac.getNumerator();
 	int denominator = frac.getDenominator();
 
@@ -618,7 +601,7 @@ std::ostream& operator<< (std::ostream& os, const Fraction& frac) {
 *Purpose:
 *       It reads a Fraction from the given istream in the following format:
 *       "numerator/denominator", or "numerator" (in which case, the denominator
-*       would be 1).
+*       would be 1). Decimals are read with readDecimal() (DecimalConversion.hpp).
 *
 * 
 *       We do by so by keeping reading lines from the istream, and then find '/' in
@@ -653,7 +636,7 @@ std::ostream& operator<< (std::ostream& os, const Fraction& frac) {
 *       DivisionByZeroException()  - If the denominator is 0.
 *
 *******************************************************************************/
-std::istream& operator>> (std::istream& is, Fraction& frac) {
+FRACTION_INLINE std::istream& operator>> (std::istream& is, Fraction& frac) {
 
 	//The numerator and denomirator we'll read.
 	int numerator, denominator;
@@ -716,9 +699,9 @@ std::istream& operator>> (std::istream& is, Fraction& frac) {
 		throw DivisionByZeroException();
 
 	//Set the calling Fraction object's numerator and denominator to be the ones
-	//we just read
-	frac.setNumerator(numerator);
-	frac.setDenominator(denominator);
+	//we just read (together, so the new numerator isn't reduced with the old
+	//denominator).
+	frac = Fraction(numerator, denominator, overflow_protection);
 
 	return is;
 
@@ -731,7 +714,7 @@ std::istream& operator>> (std::istream& is, Fraction& frac) {
 //Casts to float.
 //If the denominator is not 0, it returns numerator/denominator.
 //Else, it throws DivisionByZeroException().
-Fraction::operator float() const {
+FRACTION_INLINE Fraction::operator float() const {
 	if (0==this->m_denominator)
 		throw DivisionByZeroException();
 
@@ -739,4 +722,86 @@ Fraction::operator float() const {
 }
 
 
-} //namespace fraction {
\ No newline at end of file
+//private methods
+
+
+/***
+*void Fraction::multiplyBy() - Multiplies by numerator/denominator
+*
+*Purpose:
+*       Both fractions are reduced, so with g1 = gcd(a,d) and g2 = gcd(c,b):
+*
+*            a     c      (a/g1)*(c/g2)
+*           --- * --- = -----------------
+*            b     d      (b/g2)*(d/g1)
+*
+*       which is already reduced. Cancelling first keeps the products (and
+*       the gcds) small: a product whose reduced value fits in an 'int' never
+*       overflows, and no gcd of the products is needed.
+*
+*       The products are 'long long's (each is at most 2^62 in magnitude), so
+*       the only overflow check is on the result.
+*
+*Entry:
+*       int   numerator - c
+*       int denominator - d (not 0, but may be negative - for operator/=).
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If the overflow protection is on and the
+*                                    product doesn't fit in a Fraction.
+*
+*******************************************************************************/
+FRACTION_INLINE void Fraction::multiplyBy(int numerator, int denominator) {
+	long long a = this->m_numerator;
+	long long b = this->m_denominator;
+
+	long long c = numerator;
+	long long d = denominator;
+
+	//A zero needs no gcds (and gcd(0,d) = d would leave the other factors).
+	if (0 == a || 0 == c) {
+		this->assignReduced(0, 1);
+		return;
+	}
+
+	long long gcd1 = wideGcd(a, d);
+	long long gcd2 = wideGcd(c, b);
+
+	this->assignReduced((a / gcd1) * (c / gcd2), (b / gcd2) * (d / gcd1));
+}
+
+
+//The sign is fixed on the 'long long's, where negating can't overflow, so a
+//result that fits is stored as is.
+FRACTION_INLINE void Fraction::assignReduced(long long numerator, long long denominator) {
+	if (0 == numerator)
+		denominator = 1;
+	else if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	if (numerator >= INT_MIN && numerator <= INT_MAX && denominator <= INT_MAX) {
+		this->m_numerator = (int)numerator;
+		this->m_denominator = (int)denominator;
+		return;
+	}
+
+	if (this->m_overflow_protection)
+		throw NumericOverflowException();
+
+	//Without the overflow protection, the parts are truncated to 'int's (as the
+	//operators always did on an overflow). The truncated parts may have a
+	//common factor and a negative denominator, so they're reduced (which also
+	//fixes the sign) only after the truncation.
+	this->m_numerator = (int)numerator;
+	this->m_denominator = (int)denominator;
+	this->reduce();
+}
+
+
+} //namespace fraction {
+
+#endif
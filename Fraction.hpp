@@ -12,10 +12,14 @@
 #define FRACTION_HPP_
 
 #include "DivisionByZeroException.hpp"
+#include "HeaderOnly.hpp"
 #include "SafeArithmetics.hpp"
 #include <iostream>
 #include <utility> //for std::swap
 #include "Utilities.hpp"
+#ifdef FRACTION_SMALL_VALUE_TABLES
+#include "SmallValueTables.hpp"
+#endif
 
 
 /*
@@ -195,6 +199,29 @@ public:
 	explicit operator float() const;
 
 private:
+	//-- private constructors --//
+
+	//Selects the constructor that doesn't reduce.
+	struct Reduced {};
+
+	/*
+	Assigns a numerator and denominator that are already reduced, with a
+	positive denominator (as the ones of every Fraction are), without reducing
+	them again.
+
+	AtomicFraction unpacks its words with it, so a CAS retry doesn't pay for a
+	gcd.
+	*/
+	Fraction (int numerator, int denominator, bool overflowProtection, Reduced) :
+		m_numerator(numerator),
+		m_denominator(denominator),
+		m_overflow_protection(overflowProtection)
+	{
+	}
+
+	friend class AtomicFraction;
+
+
 	//-- private data members --//
 
 	//The numerator
@@ -225,6 +252,25 @@ private:
 	}
 
 
+	/*
+	Multiplies the fraction by numerator/denominator (with a non-zero
+	denominator), cancelling the common factors of each numerator with the
+	other denominator before multiplying - see operator*=.
+	*/
+	void multiplyBy(int numerator, int denominator);
+
+
+	/*
+	Sets the fraction to numerator/denominator, which are already co-prime,
+	computed as 'long long's.
+	The sign is moved to the numerator, and a zero gets the denominator 1.
+	If either doesn't fit in an 'int': with the overflow protection it throws
+	NumericOverflowException() (and the fraction is left unchanged), and
+	without it both are truncated to 'int's and then reduced.
+	*/
+	void assignReduced(long long numerator, long long denominator);
+
+
 	/*
 	Makes the numerator and denominator to be co-prime.
 
@@ -236,6 +282,14 @@ private:
 		if (0==this->m_denominator && this->m_overflow_protection)
 			throw DivisionByZeroException();
 
+#ifdef FRACTION_SMALL_VALUE_TABLES
+		//Small numerators and denominators are reduced with table lookups.
+		if (SmallValueTables::reduce(this->m_numerator, this->m_denominator)) {
+			this->fix_sign();
+			return;
+		}
+#endif
+
 		//Get the gcd of the numerator and denominator.
 		int gcd = Utilities::gcd(this->m_numerator, this->m_denominator);
 
@@ -328,4 +382,8 @@ std::istream& operator>> (std::istream& is, Fraction& frac);
 
 } //namespace fraction {
 
-#endif
\ No newline at end of file
+#ifdef FRACTION_HEADER_ONLY
+#include "Fraction.cpp"
+#endif
+
+#endif
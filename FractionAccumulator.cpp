@@ -0,0 +1,265 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the FractionAccumulator class
+*/
+
+#include "FractionAccumulator.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include "WideArithmetics.hpp"
+#include <cstdint> //for std::uint64_t
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//Returns 'true' if the (positive) 'divisor' divides the (positive) 'dividend',
+//and stores the quotient in 'quotient'.
+//If both fit in 64 bits (as the denominators of sums of 'int' fractions
+//usually do), it's a single 64-bit division rather than a call to the 128-bit
+//one.
+static bool divides(int128 dividend, int128 divisor, int128& quotient) {
+	if (0 == ((dividend | divisor) >> 64)) {
+		std::uint64_t narrow_dividend = (std::uint64_t)dividend;
+		std::uint64_t narrow_divisor = (std::uint64_t)divisor;
+		if (0 != narrow_dividend % narrow_divisor)
+			return false;
+		quotient = (int128)(narrow_dividend / narrow_divisor);
+		return true;
+	}
+
+	if (0 != dividend % divisor)
+		return false;
+	quotient = dividend / divisor;
+	return true;
+}
+
+
+// += operators
+
+
+//Adds the numerator and denominator of 'frac' to the sum.
+FractionAccumulator& FractionAccumulator::operator+= (const Fraction& frac) { //acc+=frac
+	this->add(frac.getNumerator(), frac.getDenominator());
+	return *this;
+}
+
+
+//An integer is the fraction number/1.
+FractionAccumulator& FractionAccumulator::operator+= (int number) { //acc+=number
+	this->add(number, 1);
+	return *this;
+}
+
+
+//Makes the denominator positive, and adds numerator/denominator to the sum.
+void FractionAccumulator::add(int numerator, int denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	int128 num = numerator;
+	int128 den = denominator;
+
+	//Note that negating in 128 bits can't overflow, even for INT_MIN.
+	if (den < 0) {
+		num = -num;
+		den = -den;
+	}
+
+	this->addWide(num, den);
+	++this->m_count;
+}
+
+
+//Adds the (wide) sum of 'other', and its count.
+void FractionAccumulator::merge(const FractionAccumulator& other) {
+	this->merge(other.m_numerator, other.m_denominator, other.m_count);
+}
+
+
+//Adds the wide fraction, and the count.
+void FractionAccumulator::merge(int128 numerator, int128 denominator, std::size_t count) {
+	this->addWide(numerator, denominator);
+	this->m_count += count;
+}
+
+
+//Reduces the sum, and checks that both the numerator and denominator fit in
+//an 'int'.
+Fraction FractionAccumulator::result(bool overflowProtection) {
+	this->reduce();
+
+	if (!WideArithmetics::fitsInt(this->m_numerator) || !WideArithmetics::fitsInt(this->m_denominator))
+		throw NumericOverflowException();
+
+	return Fraction((int)this->m_numerator, (int)this->m_denominator, overflowProtection);
+}
+
+
+//sum/count = (numerator/gcd(numerator,count)) / (denominator * (count/gcd(numerator,count)))
+//The sum is reduced first, so the result is reduced as well.
+Fraction FractionAccumulator::mean(bool overflowProtection) {
+	if (0 == this->m_count)
+		throw DivisionByZeroException();
+
+	this->reduce();
+
+	int128 count = (int128)this->m_count;
+	int128 gcd = WideArithmetics::gcd(this->m_numerator, count);
+
+	int128 numerator = this->m_numerator / gcd;
+	int128 denominator = WideArithmetics::multiply(this->m_denominator, count / gcd);
+
+	if (!WideArithmetics::fitsInt(numerator) || !WideArithmetics::fitsInt(denominator))
+		throw NumericOverflowException();
+
+	return Fraction((int)numerator, (int)denominator, overflowProtection);
+}
+
+
+/***
+*void FractionAccumulator::addWide() - Adds a wide fraction to the sum
+*
+*Purpose:
+*       Adds numerator/denominator to the sum with addUnchecked().
+*
+*       If that would overflow 128 bits, then we reduce both the sum and the
+*       added fraction and try again - the unreduced intermediates might be
+*       much larger than the actual values.
+*       If it still overflows, we let NumericOverflowException() propagate.
+*
+*       Finally, if the numerator or denominator of the sum grew past the
+*       threshold, we reduce the sum, so that the next additions would work on
+*       small numbers.
+*
+*Entry:
+*       int128   numerator - The numerator of the added fraction
+*       int128 denominator - The (positive) denominator of the added fraction
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If the reduced sum doesn't fit in 128 bits.
+*
+*******************************************************************************/
+void FractionAccumulator::addWide(int128 numerator, int128 denominator) {
+	try {
+		this->addUnchecked(numerator, denominator);
+	}
+	catch (NumericOverflowException&) {
+		this->reduce();
+
+		int128 gcd = WideArithmetics::gcd(numerator, denominator);
+		if (0 != gcd) {
+			numerator /= gcd;
+			denominator /= gcd;
+		}
+
+		this->addUnchecked(numerator, denominator);
+	}
+
+	if (WideArithmetics::bitLength(this->m_numerator) > this->m_reduce_threshold ||
+		WideArithmetics::bitLength(this->m_denominator) > this->m_reduce_threshold)
+	{
+		this->reduce();
+	}
+}
+
+
+/***
+*void FractionAccumulator::addUnchecked() - Adds a wide fraction to the sum
+*
+*Purpose:
+*       Computes a/b + c/d, where a/b is the sum and c/d is the added fraction.
+*
+*       Streams usually share a few denominators, so we first check the cheap
+*       cases, which don't need a gcd at all:
+*       1) If b==d, then the sum is (a+c)/b.
+*       2) If d divides b (i.e. lcm(b,d)==b), then the sum is (a + c*(b/d))/b.
+*          If d is the divisor of the last such addition (and b didn't change
+*          since), b/d is already known, so there's no division at all. Else,
+*          the test is a single division - a 64-bit one, if b fits in 64 bits
+*          - and d becomes the known divisor.
+*
+*       Else, we use the same formula as Fraction::operator+=:
+*
+*           a * (d/gcd(b,d)) + c * (b/gcd(b,d))
+*           -----------------------------------
+*                   b * (d/gcd(b,d))
+*
+*       The sum is computed into local variables, so if an overflow occurs the
+*       sum is left unchanged.
+*
+*Entry:
+*       int128   numerator - The numerator of the added fraction (c)
+*       int128 denominator - The (positive) denominator of the added fraction (d)
+*
+*Exit:
+*
+*Exceptions:
+*       NumericOverflowException() - If an intermediate doesn't fit in 128 bits.
+*
+*******************************************************************************/
+void FractionAccumulator::addUnchecked(int128 numerator, int128 denominator) {
+	int128 a = this->m_numerator;
+	int128 b = this->m_denominator;
+
+	int128 c = numerator;
+	int128 d = denominator;
+
+	int128 new_numerator, new_denominator;
+	int128 quotient;
+
+	if (b == d) {
+		new_numerator = WideArithmetics::add(a, c);
+		new_denominator = b;
+	}
+	else if (d == this->m_divisor) {
+		new_numerator = WideArithmetics::add(a, WideArithmetics::multiply(c, this->m_quotient));
+		new_denominator = b;
+	}
+	else if (divides(b, d, quotient)) {
+		new_numerator = WideArithmetics::add(a, WideArithmetics::multiply(c, quotient));
+		new_denominator = b;
+
+		this->m_divisor = d;
+		this->m_quotient = quotient;
+	}
+	else {
+		int128 gcd = WideArithmetics::gcd(b, d);
+		int128 d_gcd = d / gcd;
+
+		new_numerator = WideArithmetics::add(WideArithmetics::multiply(a, d_gcd),
+			WideArithmetics::multiply(c, b / gcd));
+		new_denominator = WideArithmetics::multiply(b, d_gcd);
+	}
+
+	if (new_denominator != b)
+		this->m_divisor = 0;
+
+	this->m_numerator = new_numerator;
+	this->m_denominator = new_denominator;
+}
+
+
+//Divides the numerator and denominator by their gcd (which forgets the known
+//divisor, unless the gcd is 1).
+//The denominator is positive, so the gcd is never 0.
+void FractionAccumulator::reduce() {
+	int128 gcd = WideArithmetics::gcd(this->m_numerator, this->m_denominator);
+	if (1 == gcd)
+		return;
+
+	this->m_numerator /= gcd;
+	this->m_denominator /= gcd;
+	this->m_divisor = 0;
+}
+
+
+} //namespace fraction {
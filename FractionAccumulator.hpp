@@ -0,0 +1,169 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the FractionAccumulator class
+*/
+
+
+#ifndef FRACTIONACCUMULATOR_HPP_
+#define FRACTIONACCUMULATOR_HPP_
+
+#include "Fraction.hpp"
+#include "WideArithmetics.hpp"
+#include <cstddef> //for std::size_t
+
+
+namespace fraction {
+
+
+/*
+This class represents a running sum of Fractions.
+
+Unlike summing with Fraction::operator+=, the sum is kept in 128-bit
+numerator and denominator, and it's not reduced after every addition -
+it's reduced only when the numerator or denominator grows past a given
+number of bits, or when result() is called.
+So summing many fractions with small denominators doesn't overflow as long
+as the (reduced) total fits in a Fraction.
+
+Streams usually share a few denominators, so adding a fraction whose
+denominator is the denominator of the sum, or divides it, needs no gcd. The
+last such divisor is kept with its quotient, so adding it again needs no
+division either.
+
+The denominator is always positive.
+
+If even the reduced sum doesn't fit in 128 bits, the adding operators throw
+NumericOverflowException().
+
+Accumulators that summed different parts of a stream (e.g. on different
+threads) can be combined with merge().
+*/
+class FractionAccumulator
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	Starts with a sum of 0.
+	'reduceThreshold' is the bit length of the numerator or denominator past
+	which the sum is reduced.
+	*/
+	explicit FractionAccumulator(int reduceThreshold = DEFAULT_REDUCE_THRESHOLD) :
+		m_numerator(0),
+		m_denominator(1),
+		m_count(0),
+		m_reduce_threshold(reduceThreshold),
+		m_divisor(0),
+		m_quotient(0)
+	{
+	}
+
+	//-- operators --//
+
+	// += operators
+	FractionAccumulator& operator+= (const Fraction& frac); //acc+=frac
+	FractionAccumulator& operator+= (int number); //acc+=number
+
+
+	//-- public methods --//
+
+	//Adds numerator/denominator to the sum.
+	//If the denominator is 0, it throws DivisionByZeroException().
+	void add(int numerator, int denominator);
+
+	//Adds the sum of 'other' to the sum, and the count of 'other' to the count.
+	void merge(const FractionAccumulator& other);
+
+	//Adds numerator/denominator (with a positive denominator) to the sum, as
+	//the sum of 'count' values - e.g. a sum that was published by another
+	//accumulator.
+	void merge(WideArithmetics::int128 numerator, WideArithmetics::int128 denominator, std::size_t count);
+
+	/*
+	Reduces the sum and returns it as a Fraction with the given overflow
+	protection.
+
+	If the reduced sum doesn't fit in a Fraction, it throws
+	NumericOverflowException().
+	*/
+	Fraction result(bool overflowProtection = false);
+
+	/*
+	Returns the mean of the values added so far (the sum divided by the count)
+	as a Fraction with the given overflow protection.
+	The division is done in 128 bits, so the mean may fit in a Fraction even if
+	the sum doesn't.
+
+	If no values were added, it throws DivisionByZeroException().
+	If the mean doesn't fit in a Fraction, it throws NumericOverflowException().
+	*/
+	Fraction mean(bool overflowProtection = false);
+
+	//Makes the numerator and denominator co-prime.
+	void reduce();
+
+	//Sets the sum back to 0 and the count to 0.
+	void reset() {
+		this->m_numerator = 0;
+		this->m_denominator = 1;
+		this->m_count = 0;
+		this->m_divisor = 0;
+	}
+
+	//Getter for the (not necessarily reduced) numerator of the sum
+	WideArithmetics::int128 getNumerator() const {
+		return this->m_numerator;
+	}
+
+	//Getter for the (not necessarily reduced) denominator of the sum
+	WideArithmetics::int128 getDenominator() const {
+		return this->m_denominator;
+	}
+
+	//Getter for the number of values added so far
+	std::size_t getCount() const {
+		return this->m_count;
+	}
+
+	//The default bit length past which the sum is reduced.
+	static const int DEFAULT_REDUCE_THRESHOLD = 96;
+
+private:
+	//-- private data members --//
+
+	//The numerator of the sum
+	WideArithmetics::int128 m_numerator;
+
+	//The denominator of the sum (always positive)
+	WideArithmetics::int128 m_denominator;
+
+	//The number of values added so far
+	std::size_t m_count;
+
+	//The bit length past which the sum is reduced
+	int m_reduce_threshold;
+
+	//A denominator that divides the denominator of the sum (0 if there's
+	//none), and the quotient - valid until the denominator of the sum changes
+	WideArithmetics::int128 m_divisor;
+	WideArithmetics::int128 m_quotient;
+
+
+	//-- private methods --//
+
+	//Adds numerator/denominator (with a positive denominator) to the sum.
+	void addWide(WideArithmetics::int128 numerator, WideArithmetics::int128 denominator);
+
+	//Adds numerator/denominator to the sum, without any fallback on overflow.
+	void addUnchecked(WideArithmetics::int128 numerator, WideArithmetics::int128 denominator);
+
+}; //class FractionAccumulator {
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,169 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of the hot operators of Fraction.
+*
+* It first checks the results of the arithmetic operators - exact values on
+* small operands, and on overflowing operands (without the overflow protection)
+* that the truncated results are still reduced with a positive denominator -
+* and exits with an error if one is wrong.
+*
+* Then it times construction (reduction), +=, *= and operator< on the same
+* random fractions, and prints the time per operation. 'make bench_builds' builds it
+* as separate translation units, in the header-only mode and with link-time
+* optimization, so the gain of inlining the operators can be compared (and
+* kept track of).
+*/
+
+#include "Benchmark.hpp"
+#include "Fraction.hpp"
+#include <algorithm> //for std::sort
+#include <cstddef> //for std::size_t
+#include <cstdlib> //for std::exit, std::llabs
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of fractions every operation is done on, and the number of passes.
+static const std::size_t FRACTIONS = 1 << 18;
+static const int PASSES = 16;
+
+
+//Returns the time in nanoseconds per operation of calling operation(i) for
+//every fraction in every pass.
+template <typename Operation>
+static double timeOperations(Operation operation) {
+	return Benchmark::measure(PASSES * FRACTIONS, [&operation]() {
+		for (int pass = 0; pass < PASSES; ++pass) {
+			for (std::size_t i = 0; i < FRACTIONS; ++i)
+				operation(i);
+		}
+	});
+}
+
+
+//The number of operand pairs every operator is checked on.
+static const int CHECKS = 1 << 16;
+
+
+//Returns the gcd of |num1| and |num2|.
+static long long gcd(long long num1, long long num2) {
+	num1 = std::llabs(num1);
+	num2 = std::llabs(num2);
+	while (0 != num2) {
+		long long remainder = num1 % num2;
+		num1 = num2;
+		num2 = remainder;
+	}
+	return num1;
+}
+
+
+//Exits with an error if 'frac' isn't reduced with a positive denominator, or
+//(if 'denominator' isn't 0) if it isn't numerator/denominator.
+static void check(const fraction::Fraction& frac, long long numerator, long long denominator, const char* name) {
+	bool valid = frac.getDenominator() > 0 && 1 == gcd(frac.getNumerator(), frac.getDenominator());
+	if (valid && 0 != denominator)
+		valid = (long long)frac.getNumerator() * denominator == numerator * frac.getDenominator();
+
+	if (!valid) {
+		std::cout << name << " gave " << frac.getNumerator() << "/" << frac.getDenominator() << "!" << std::endl;
+		std::exit(1);
+	}
+}
+
+
+/*
+Checks +=, -=, *= and /= on random operands: on operands of up to 15 bits the
+exact results (which fit in 'long long's) are compared, and on operands of up
+to 6 digits - which overflow most of the time - only that the truncated
+results are reduced and have a positive denominator.
+*/
+static void checkOperators(std::mt19937& generator) {
+	std::uniform_int_distribution<int> small(-(1 << 15), 1 << 15), small_positive(1, 1 << 15);
+	std::uniform_int_distribution<int> large(-999999, 999999), large_positive(1, 999999);
+
+	for (int i = 0; i < CHECKS; ++i) {
+		bool exact = (0 == i % 2);
+		int lhs_numerator = exact ? small(generator) : large(generator);
+		int lhs_denominator = exact ? small_positive(generator) : large_positive(generator);
+		int rhs_numerator = exact ? small(generator) : large(generator);
+		int rhs_denominator = exact ? small_positive(generator) : large_positive(generator);
+		fraction::Fraction lhs(lhs_numerator, lhs_denominator), rhs(rhs_numerator, rhs_denominator);
+
+		long long a = lhs.getNumerator(), b = lhs.getDenominator();
+		long long c = rhs.getNumerator(), d = rhs.getDenominator();
+
+		fraction::Fraction sum(lhs), difference(lhs), product(lhs), quotient(lhs);
+		sum += rhs;
+		difference -= rhs;
+		product *= rhs;
+		check(sum, a*d + c*b, exact ? b*d : 0, "+=");
+		check(difference, a*d - c*b, exact ? b*d : 0, "-=");
+		check(product, a*c, exact ? b*d : 0, "*=");
+		if (0 != c) {
+			quotient /= rhs;
+			check(quotient, a*d, exact ? b*c : 0, "/=");
+		}
+	}
+}
+
+
+int main() {
+	std::mt19937 generator(2024);
+	checkOperators(generator);
+
+	std::uniform_int_distribution<int> small(-1000, 1000);
+	std::uniform_int_distribution<int> positive(1, 1000);
+
+	std::vector<int> numerators(FRACTIONS), denominators(FRACTIONS);
+	std::vector<fraction::Fraction> fractions;
+	for (std::size_t i = 0; i < FRACTIONS; ++i) {
+		numerators[i] = small(generator);
+		denominators[i] = positive(generator);
+		fractions.push_back(fraction::Fraction(numerators[i], denominators[i]));
+	}
+
+	//Keeps the results, so they aren't optimized away.
+	long long checksum = 0;
+
+	double construct_ns = timeOperations([&](std::size_t i) {
+		fraction::Fraction frac(numerators[i], denominators[i]);
+		checksum += frac.getNumerator();
+	});
+
+	//The sum is restarted often enough to not overflow.
+	fraction::Fraction sum;
+	double add_ns = timeOperations([&](std::size_t i) {
+		if (0 == i % 2)
+			sum = fraction::Fraction(0);
+		sum += fractions[i];
+		checksum += sum.getDenominator();
+	});
+
+	fraction::Fraction product(1);
+	double multiply_ns = timeOperations([&](std::size_t i) {
+		if (0 == i % 2)
+			product = fraction::Fraction(1);
+		product *= fractions[i];
+		checksum += product.getNumerator();
+	});
+
+	double compare_ns = timeOperations([&](std::size_t i) {
+		checksum += (fractions[i] < fractions[(i + 1) % FRACTIONS]) ? 1 : 0;
+	});
+
+	std::vector<fraction::Fraction> sorted(fractions);
+	double sort_ns = Benchmark::measure(FRACTIONS, [&sorted]() { std::sort(sorted.begin(), sorted.end()); });
+	checksum += sorted[0].getNumerator();
+
+	std::cout << "construct\t" << construct_ns << " ns/op" << std::endl;
+	std::cout << "+=\t\t" << add_ns << " ns/op" << std::endl;
+	std::cout << "*=\t\t" << multiply_ns << " ns/op" << std::endl;
+	std::cout << "<\t\t" << compare_ns << " ns/op" << std::endl;
+	std::cout << "sort\t\t" << sort_ns << " ns/fraction" << std::endl;
+	std::cout << "(checksum " << checksum << ")" << std::endl;
+}
@@ -0,0 +1,137 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration and implementation of the
+* FractionColumns class
+*/
+
+
+#ifndef FRACTIONCOLUMNS_HPP_
+#define FRACTIONCOLUMNS_HPP_
+
+#include "Fraction.hpp"
+#include <cstddef> //for std::size_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents an array of fractions stored as two columns - one of
+numerators and one of denominators - instead of an array of Fraction objects.
+
+This is the layout the bulk APIs of the library (loading, kernels, etc.) work
+on: the columns can be processed by simple loops over 'int's, and no
+overflow protection 'bool' is stored per value.
+
+The fractions are expected to be reduced, with positive denominators (which is
+what the library's producers of columns store).
+*/
+class FractionColumns
+{
+public:
+	//-- constructors/destructor --//
+
+	/* constructor */
+
+	//Creates empty columns.
+	FractionColumns() { }
+
+	//Creates columns of 'size' zeros (0/1).
+	explicit FractionColumns(std::size_t size) :
+		m_numerators(size, 0),
+		m_denominators(size, 1)
+	{
+	}
+
+
+	//-- public methods --//
+
+	//Returns the number of fractions.
+	std::size_t size() const {
+		return this->m_numerators.size();
+	}
+
+	//Returns 'true' if there are no fractions.
+	bool empty() const {
+		return this->m_numerators.empty();
+	}
+
+	//Reserves room for 'size' fractions.
+	void reserve(std::size_t size) {
+		this->m_numerators.reserve(size);
+		this->m_denominators.reserve(size);
+	}
+
+	//Changes the number of fractions. New fractions are 0/1.
+	void resize(std::size_t size) {
+		this->m_numerators.resize(size, 0);
+		this->m_denominators.resize(size, 1);
+	}
+
+	//Removes all the fractions.
+	void clear() {
+		this->m_numerators.clear();
+		this->m_denominators.clear();
+	}
+
+	//Appends numerator/denominator (which is expected to be reduced).
+	void pushBack(int numerator, int denominator) {
+		this->m_numerators.push_back(numerator);
+		this->m_denominators.push_back(denominator);
+	}
+
+	//Appends the numerator and denominator of 'frac'.
+	void pushBack(const Fraction& frac) {
+		this->pushBack(frac.getNumerator(), frac.getDenominator());
+	}
+
+	//Appends all the fractions of 'other'.
+	void append(const FractionColumns& other) {
+		this->m_numerators.insert(this->m_numerators.end(), other.m_numerators.begin(),
+			other.m_numerators.end());
+		this->m_denominators.insert(this->m_denominators.end(), other.m_denominators.begin(),
+			other.m_denominators.end());
+	}
+
+	//Returns the fraction at 'index' as a Fraction with the given overflow
+	//protection.
+	Fraction at(std::size_t index, bool overflowProtection = false) const {
+		return Fraction(this->m_numerators[index], this->m_denominators[index], overflowProtection);
+	}
+
+	//Returns the column of numerators.
+	int* numerators() {
+		return this->m_numerators.data();
+	}
+
+	const int* numerators() const {
+		return this->m_numerators.data();
+	}
+
+	//Returns the column of denominators.
+	int* denominators() {
+		return this->m_denominators.data();
+	}
+
+	const int* denominators() const {
+		return this->m_denominators.data();
+	}
+
+private:
+	//-- private data members --//
+
+	//The numerators
+	std::vector<int> m_numerators;
+
+	//The denominators
+	std::vector<int> m_denominators;
+
+}; //class FractionColumns {
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,206 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the filtering and bucketing kernels over
+* FractionColumns. Their loops are the kernels of the running CPU's SimdLevel
+* (see SimdKernels.hpp); here they're split into parallel chunks.
+*/
+
+
+#include "FractionKernels.hpp"
+#include "Parallel.hpp"
+#include "SimdKernels.hpp"
+#include <algorithm> //for std::min, std::max
+
+
+namespace fraction {
+
+
+//The minimal number of values in a chunk that's processed by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 16;
+
+//Up to this number of boundaries, bucketize() compares every boundary against
+//a whole block, instead of binary searching every value.
+static const std::size_t MAX_LINEAR_BOUNDARIES = 16;
+
+
+/***
+*void forEachChunk() - Runs a task on parallel chunks of values
+*
+*Purpose:
+*       Splits the 'count' values into chunks (a few per thread, as long as
+*       the chunks aren't too small) that begin on multiples of 64 - so no two
+*       chunks share a word of a mask - and calls task(chunk, begin, end) for
+*       every chunk on the threads.
+*
+*Entry:
+*       std::size_t     count - The number of values.
+*       unsigned      threads - The number of threads (0 means the number of
+*                               hardware threads).
+*       std::size_t&   chunks - Would hold the number of chunks.
+*       Task             task - Called for every chunk.
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+template <typename Task>
+static void forEachChunk(std::size_t count, unsigned threads, std::size_t& chunks, Task task) {
+	std::size_t blocks = (count + 63) / 64;
+	chunks = std::max<std::size_t>(1,
+		std::min<std::size_t>(Parallel::threadCount(threads) * 4, count / MIN_CHUNK_SIZE));
+
+	Parallel::forEach(chunks, threads, [&](std::size_t chunk) {
+		std::size_t begin = blocks * chunk / chunks * 64;
+		std::size_t end = std::min(count, blocks * (chunk + 1) / chunks * 64);
+		task(chunk, begin, end);
+	});
+}
+
+
+/***
+*std::size_t filterColumns() - Sets the mask bits of the values that satisfy
+*                              a predicate
+*
+*Purpose:
+*       Calls the filter kernel on every chunk of the values, and sums the
+*       numbers of values they selected.
+*
+*Entry:
+*       const FractionColumns& columns - The values.
+*       unsigned               threads - The number of threads.
+*       Kernel                  kernel - Called as kernel(numerators,
+*                                        denominators, begin, end), and returns
+*                                        the number of selected values.
+*
+*Exit:
+*       std::size_t - The number of selected values.
+*
+*Exceptions:
+*
+*******************************************************************************/
+template <typename Kernel>
+static std::size_t filterColumns(const FractionColumns& columns, unsigned threads, Kernel kernel) {
+	const int* numerators = columns.numerators();
+	const int* denominators = columns.denominators();
+
+	std::vector<std::size_t> selected(Parallel::threadCount(threads) * 4, 0);
+	std::size_t chunks;
+
+	forEachChunk(columns.size(), threads, chunks, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+		selected[chunk] = kernel(numerators, denominators, begin, end);
+	});
+
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < chunks; ++i)
+		total += selected[i];
+	return total;
+}
+
+
+//Cross-multiplies every value x = n/d with value = vn/vd, and compares
+//n*vd with vn*d.
+std::size_t filter(const FractionColumns& columns, Comparison comparison, const Fraction& value,
+	std::uint64_t* mask, unsigned threads)
+{
+	long long vn = value.getNumerator();
+	long long vd = value.getDenominator();
+	const SimdKernels& kernels = simdKernels();
+
+	return filterColumns(columns, threads, [&](const int* numerators, const int* denominators,
+		std::size_t begin, std::size_t end) {
+		return kernels.filter(numerators, denominators, begin, end, comparison, vn, vd, mask);
+	});
+}
+
+
+//Selects ln/ld <= n/d < hn/hd.
+std::size_t filterRange(const FractionColumns& columns, const Fraction& low, const Fraction& high,
+	std::uint64_t* mask, unsigned threads)
+{
+	long long ln = low.getNumerator(), ld = low.getDenominator();
+	long long hn = high.getNumerator(), hd = high.getDenominator();
+	const SimdKernels& kernels = simdKernels();
+
+	return filterColumns(columns, threads, [&](const int* numerators, const int* denominators,
+		std::size_t begin, std::size_t end) {
+		return kernels.filterRange(numerators, denominators, begin, end, ln, ld, hn, hd, mask);
+	});
+}
+
+
+//Walks the set bits of every word from the lowest one.
+void maskToIndices(const std::uint64_t* mask, std::size_t count, std::vector<std::size_t>& indices) {
+	indices.clear();
+
+	std::size_t words = (count + 63) / 64;
+	for (std::size_t word_index = 0; word_index < words; ++word_index) {
+		std::uint64_t word = mask[word_index];
+		while (0 != word) {
+			indices.push_back(word_index * 64 + __builtin_ctzll(word));
+			word &= word - 1;
+		}
+	}
+}
+
+
+/***
+*void bucketize() - Assigns every value to a bucket between sorted boundaries
+*
+*Purpose:
+*       The bucket of a value is the number of boundaries that are less than
+*       or equal to it.
+*
+*       With up to MAX_LINEAR_BOUNDARIES boundaries, the values are processed
+*       in blocks: every boundary is compared (by cross-multiplication)
+*       against all the values of the block, and the results are added to
+*       their buckets - loops with no branches, which the compiler vectorizes.
+*
+*       With more boundaries, every value is binary searched, which takes
+*       log(boundaryCount) comparisons instead of boundaryCount. The search
+*       halves the range the same way for every value, whatever the
+*       comparisons are (only its base moves), so groups of values are
+*       searched together in lockstep: their comparisons don't depend on each
+*       other, and the next base is selected without a branch.
+*
+*Entry:
+*       const FractionColumns&     columns - The values.
+*       const Fraction*         boundaries - The sorted boundaries.
+*       std::size_t          boundaryCount - The number of boundaries.
+*       int*                       buckets - Would hold the bucket of every
+*                                            value.
+*       unsigned                   threads - The number of threads.
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+void bucketize(const FractionColumns& columns, const Fraction* boundaries, std::size_t boundaryCount,
+	int* buckets, unsigned threads)
+{
+	std::vector<long long> boundary_numerators(boundaryCount), boundary_denominators(boundaryCount);
+	for (std::size_t k = 0; k < boundaryCount; ++k) {
+		boundary_numerators[k] = boundaries[k].getNumerator();
+		boundary_denominators[k] = boundaries[k].getDenominator();
+	}
+
+	const int* numerators = columns.numerators();
+	const int* denominators = columns.denominators();
+	const SimdKernels& kernels = simdKernels();
+	std::size_t chunks;
+
+	forEachChunk(columns.size(), threads, chunks, [&](std::size_t, std::size_t begin, std::size_t end) {
+		if (boundaryCount <= MAX_LINEAR_BOUNDARIES)
+			kernels.bucketizeLinear(numerators, denominators, begin, end, boundary_numerators.data(),
+				boundary_denominators.data(), boundaryCount, buckets);
+		else
+			kernels.bucketizeSearch(numerators, denominators, begin, end, boundary_numerators.data(),
+				boundary_denominators.data(), boundaryCount, buckets);
+	});
+}
+
+} //namespace fraction {
@@ -0,0 +1,79 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the filtering and bucketing kernels
+* over FractionColumns
+*/
+
+
+#ifndef FRACTIONKERNELS_HPP_
+#define FRACTIONKERNELS_HPP_
+
+#include "Comparison.hpp"
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+These kernels compare whole columns against constant fractions without
+operator< (which subtracts, and so computes a gcd, per comparison).
+
+Since the denominators are positive, n1/d1 < n2/d2 iff n1*d2 < n2*d1, and the
+products of two 'int's always fit in 64 bits - so every comparison is two
+widening multiplications and an integer comparison, with no branches. The
+loops run over blocks of 64 values, so the compiler can vectorize them.
+
+The columns are expected to have positive denominators (as FractionColumns
+does).
+
+The selections are returned as bitmasks: bit (i % 64) of mask[i / 64] is set
+iff the i-th value is selected. A mask of 'count' values has
+SafeArithmetics::maskWords(count) words, and its bits past 'count' are 0.
+
+Large columns are processed in parallel chunks on 'threads' threads (0 means
+the number of hardware threads).
+*/
+
+
+/*
+Sets the bits of the values x of 'columns' for which 'x comparison value'
+holds, and returns their number.
+*/
+std::size_t filter(const FractionColumns& columns, Comparison comparison, const Fraction& value,
+	std::uint64_t* mask, unsigned threads = 0);
+
+/*
+Sets the bits of the values x of 'columns' for which low <= x < high, and
+returns their number.
+*/
+std::size_t filterRange(const FractionColumns& columns, const Fraction& low, const Fraction& high,
+	std::uint64_t* mask, unsigned threads = 0);
+
+//Stores the indices of the set bits of the mask of 'count' values in
+//'indices' (replacing their content), in increasing order.
+void maskToIndices(const std::uint64_t* mask, std::size_t count, std::vector<std::size_t>& indices);
+
+/*
+Assigns every value x of 'columns' to a bucket by the 'boundaryCount'
+boundaries (which must be sorted): buckets[i] is the number of boundaries that
+are less than or equal to the i-th value - i.e. it's 0 for values less than
+the first boundary, k for values in [boundaries[k-1], boundaries[k]), and
+'boundaryCount' for values from the last boundary on.
+
+For a few boundaries, every boundary is compared against a whole block of
+values; for many, every value is binary searched.
+*/
+void bucketize(const FractionColumns& columns, const Fraction* boundaries, std::size_t boundaryCount,
+	int* buckets, unsigned threads = 0);
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,82 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of the kernels of FractionKernels.hpp.
+*
+* It filters and buckets the same random columns with the kernels and with
+* Fraction::operator<, and prints the time of each per value, and the
+* throughput it amounts to (in GB/s of columns read), to be compared with the
+* memory bandwidth of the machine. The kernels run at the SimdLevel the
+* dispatch selects (FRACTION_SIMD_LEVEL lowers it).
+*/
+
+#include "Benchmark.hpp"
+#include "CpuDispatch.hpp"
+#include "FractionKernels.hpp"
+#include "SafeArithmetics.hpp" //for SafeArithmetics::maskWords()
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of values in the columns.
+static const std::size_t VALUES = 1 << 24;
+
+
+//Returns the throughput in GB/s of reading the columns in 'nanoseconds' per
+//value.
+static double throughput(double nanoseconds) {
+	return 2 * sizeof(int) / nanoseconds;
+}
+
+
+int main() {
+	std::cout << "SIMD level: " << fraction::simdLevelName(fraction::simdLevel()) << std::endl;
+
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> numerator_distribution(-100000, 100000);
+	std::uniform_int_distribution<int> denominator_distribution(1, 100000);
+
+	fraction::FractionColumns columns;
+	columns.reserve(VALUES);
+	for (std::size_t i = 0; i < VALUES; ++i)
+		columns.pushBack(fraction::Fraction(numerator_distribution(generator), denominator_distribution(generator)));
+
+	fraction::Fraction threshold(3, 7);
+	std::vector<std::uint64_t> mask(SafeArithmetics::maskWords(VALUES));
+	std::vector<int> buckets(VALUES);
+
+	std::size_t kernel_selected = 0, scalar_selected = 0;
+	double kernel_ns = Benchmark::measure(VALUES, [&]() {
+		kernel_selected = fraction::filter(columns, fraction::Comparison::Less, threshold, mask.data());
+	});
+	double scalar_ns = Benchmark::measure(VALUES, [&]() {
+		for (std::size_t i = 0; i < VALUES; ++i)
+			scalar_selected += (columns.at(i) < threshold) ? 1 : 0;
+	});
+	std::cout << "x < 3/7\t\tkernel " << kernel_ns << " ns/value (" << throughput(kernel_ns)
+		<< " GB/s), operator< " << scalar_ns << " ns/value (" << throughput(scalar_ns) << " GB/s) ("
+		<< kernel_selected << " = " << scalar_selected << " selected)" << std::endl;
+
+	double range_ns = Benchmark::measure(VALUES, [&]() {
+		kernel_selected = fraction::filterRange(columns, fraction::Fraction(-1, 3), threshold, mask.data());
+	});
+	std::cout << "-1/3 <= x < 3/7\tkernel " << range_ns << " ns/value (" << throughput(range_ns)
+		<< " GB/s) (" << kernel_selected << " selected)" << std::endl;
+
+	for (std::size_t boundary_count = 2; boundary_count <= 256; boundary_count *= 2) {
+		std::vector<fraction::Fraction> boundaries;
+		for (std::size_t k = 0; k < boundary_count; ++k)
+			boundaries.push_back(fraction::Fraction(-1 + 2 * (int)k, (int)boundary_count));
+
+		double bucket_ns = Benchmark::measure(VALUES, [&]() {
+			fraction::bucketize(columns, boundaries.data(), boundaries.size(), buckets.data());
+		});
+		std::cout << boundary_count << " buckets\tkernel " << bucket_ns << " ns/value ("
+			<< throughput(bucket_ns) << " GB/s)" << std::endl;
+	}
+}
@@ -0,0 +1,365 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the FractionLoader class and of
+* parseFraction()
+*/
+
+#include "FractionLoader.hpp"
+#include "DecimalConversion.hpp" //for parseDecimal()
+#include "Parallel.hpp"
+#include <algorithm> //for std::copy
+#include <cerrno>
+#include <climits> //for INT_MIN, INT_MAX
+#include <cstring> //for std::memchr
+#include <system_error>
+#include <fcntl.h> //for open()
+#include <sys/mman.h> //for mmap(), munmap(), madvise()
+#include <sys/stat.h> //for fstat()
+#include <unistd.h> //for close()
+
+
+namespace fraction {
+
+
+//The size of the chunks the input is split into is at least this many bytes,
+//so small inputs aren't split between threads at all.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 20;
+
+//The number of chunks per thread, so threads that finish early can take more.
+static const std::size_t CHUNKS_PER_THREAD = 4;
+
+
+/***
+*ParseStatus parseInteger() - Parses an integer
+*
+*Purpose:
+*       Parses [begin, end) as an integer with an optional '+' or '-' sign,
+*       followed by at least one digit, and nothing else (the same integers
+*       Utilities::isInteger() accepts).
+*
+*       The value is accumulated in a 'long long', and once it's past the
+*       range of an 'int' we stop accumulating (but keep checking that the
+*       rest are digits, since a malformed string is reported as such even if
+*       it's long).
+*
+*Entry:
+*       const char* begin - The beginning of the text.
+*       const char*   end - The end of the text.
+*       long long&  value - Would hold the integer.
+*
+*Exit:
+*       ParseStatus - Ok, Malformed, or Overflow if the integer doesn't fit in
+*                     an 'int'.
+*
+*Exceptions:
+*
+*******************************************************************************/
+static ParseStatus parseInteger(const char* begin, const char* end, long long& value) {
+	bool negative = false;
+	if (begin != end && ('+' == *begin || '-' == *begin)) {
+		negative = ('-' == *begin);
+		++begin;
+	}
+
+	if (begin == end)
+		return ParseStatus::Malformed;
+
+	long long magnitude = 0;
+	bool overflow = false;
+	for (; begin != end; ++begin) {
+		unsigned digit = (unsigned)(*begin - '0');
+		if (digit > 9)
+			return ParseStatus::Malformed;
+
+		if (!overflow) {
+			magnitude = magnitude * 10 + digit;
+			overflow = (magnitude > (long long)INT_MAX + 1);
+		}
+	}
+
+	value = negative ? -magnitude : magnitude;
+	if (overflow || value > INT_MAX)
+		return ParseStatus::Overflow;
+	return ParseStatus::Ok;
+}
+
+
+//The (non-negative) gcd of two integers, Euclidean algorithm.
+static long long gcd(long long num1, long long num2) {
+	if (num1 < 0)
+		num1 = -num1;
+	if (num2 < 0)
+		num2 = -num2;
+
+	while (0 != num2) {
+		long long remainder = num1 % num2;
+		num1 = num2;
+		num2 = remainder;
+	}
+	return num1;
+}
+
+
+/***
+*ParseStatus parseFraction() - Parses a fraction
+*
+*Purpose:
+*       Splits [begin, end) at the first '/' (if any), and parses the parts
+*       as the numerator and denominator (the denominator is 1 if there is no
+*       '/').
+*
+*       Text without a '/' that isn't an integer but contains a '.' is parsed
+*       as a decimal by parseDecimal().
+*
+*       A malformed part is reported before an overflowing one, as in
+*       operator>> (which only throws on an overflow if both parts are
+*       integers).
+*
+*       Finally, the fraction is reduced and its sign is moved to the
+*       numerator. This is done in 'long long', since making the denominator
+*       positive might overflow an 'int' (e.g. "1/-2147483648").
+*
+*Entry:
+*       const char*      begin - The beginning of the text.
+*       const char*        end - The end of the text.
+*       int&         numerator - Would hold the reduced numerator.
+*       int&       denominator - Would hold the reduced, positive, denominator.
+*
+*Exit:
+*       ParseStatus - The result of the parsing. 'numerator' and 'denominator'
+*                     are changed only if it's Ok.
+*
+*Exceptions:
+*
+*******************************************************************************/
+ParseStatus parseFraction(const char* begin, const char* end, int& numerator, int& denominator) {
+	const char* slash = (const char*)std::memchr(begin, '/', end - begin);
+
+	long long parsed_numerator, parsed_denominator = 1;
+	ParseStatus numerator_status = parseInteger(begin, slash ? slash : end, parsed_numerator);
+	ParseStatus denominator_status = slash ?
+		parseInteger(slash + 1, end, parsed_denominator) : ParseStatus::Ok;
+
+	if (ParseStatus::Malformed == numerator_status || ParseStatus::Malformed == denominator_status) {
+		//A single number with a '.' may be a decimal.
+		if (!slash && std::memchr(begin, '.', end - begin))
+			return parseDecimal(begin, end, numerator, denominator);
+		return ParseStatus::Malformed;
+	}
+	if (ParseStatus::Overflow == numerator_status || ParseStatus::Overflow == denominator_status)
+		return ParseStatus::Overflow;
+	if (0 == parsed_denominator)
+		return ParseStatus::DivisionByZero;
+
+	long long divisor = gcd(parsed_numerator, parsed_denominator);
+	parsed_numerator /= divisor;
+	parsed_denominator /= divisor;
+
+	if (parsed_denominator < 0) {
+		parsed_numerator = -parsed_numerator;
+		parsed_denominator = -parsed_denominator;
+	}
+
+	if (parsed_numerator > INT_MAX || parsed_denominator > INT_MAX)
+		return ParseStatus::Overflow;
+
+	numerator = (int)parsed_numerator;
+	denominator = (int)parsed_denominator;
+	return ParseStatus::Ok;
+}
+
+
+//The result of parsing one chunk.
+struct ParsedChunk {
+
+	//The fractions of the chunk
+	FractionColumns columns;
+
+	//The malformed lines, with line numbers relative to the chunk (0-based)
+	std::vector<MalformedLine> errors;
+
+	//The number of lines in the chunk
+	std::size_t lines;
+};
+
+
+//Parses every line in [begin, end) into 'chunk'.
+//Lines are found with memchr(), which scans many bytes at a time.
+static void parseChunk(const char* begin, const char* end, ParsedChunk& chunk) {
+	chunk.lines = 0;
+
+	//A rough guess of 8 bytes per line, to avoid most of the reallocations.
+	chunk.columns.reserve((end - begin) / 8);
+
+	while (begin != end) {
+		const char* newline = (const char*)std::memchr(begin, '\n', end - begin);
+		const char* line_end = newline ? newline : end;
+
+		const char* text_end = line_end;
+		if (text_end != begin && '\r' == text_end[-1])
+			--text_end;
+
+		int numerator, denominator;
+		ParseStatus status = parseFraction(begin, text_end, numerator, denominator);
+		if (ParseStatus::Ok == status) {
+			chunk.columns.pushBack(numerator, denominator);
+		}
+		else {
+			MalformedLine error;
+			error.lineNumber = chunk.lines;
+			error.status = status;
+			error.text.assign(begin, text_end);
+			chunk.errors.push_back(error);
+		}
+
+		++chunk.lines;
+		begin = newline ? newline + 1 : end;
+	}
+}
+
+
+/***
+*void FractionLoader::loadBuffer() - Loads fractions from memory
+*
+*Purpose:
+*       1) Splits the text into chunks: the i-th chunk nominally starts at
+*          i*size/chunks, and every start is moved forward to the beginning of
+*          the next line, so no line is split between chunks.
+*
+*       2) Parses the chunks in parallel, each one into its own ParsedChunk.
+*
+*       3) Computes, with prefix sums of the chunk sizes and line counts, where
+*          every chunk goes in the output, and copies the chunks there in
+*          parallel. The line numbers of the errors are shifted by the number
+*          of lines before their chunk.
+*
+*Entry:
+*       const char*                   data - The text.
+*       std::size_t                   size - The size of the text.
+*       FractionColumns&           columns - Would hold the fractions.
+*       std::vector<MalformedLine>& errors - Would hold the malformed lines.
+*
+*Exit:
+*
+*Exceptions:
+*       std::bad_alloc - If there's not enough memory for the columns.
+*
+*******************************************************************************/
+void FractionLoader::loadBuffer(const char* data, std::size_t size, FractionColumns& columns,
+	std::vector<MalformedLine>& errors) const
+{
+	unsigned threads = Parallel::threadCount(this->m_threads);
+
+	std::size_t chunk_count = threads * CHUNKS_PER_THREAD;
+	if (chunk_count > size / MIN_CHUNK_SIZE)
+		chunk_count = size / MIN_CHUNK_SIZE;
+	if (0 == chunk_count)
+		chunk_count = 1;
+
+	std::vector<const char*> starts(chunk_count + 1);
+	starts[0] = data;
+	starts[chunk_count] = data + size;
+	for (std::size_t i = 1; i < chunk_count; ++i) {
+		const char* start = data + (i * size) / chunk_count;
+		if (start < starts[i - 1])
+			start = starts[i - 1];
+
+		if (start != data && '\n' != start[-1]) {
+			const char* newline = (const char*)std::memchr(start, '\n', data + size - start);
+			start = newline ? newline + 1 : data + size;
+		}
+		starts[i] = start;
+	}
+
+	std::vector<ParsedChunk> chunks(chunk_count);
+	Parallel::forEach(chunk_count, threads, [&](std::size_t i) {
+		parseChunk(starts[i], starts[i + 1], chunks[i]);
+	});
+
+	std::vector<std::size_t> offsets(chunk_count + 1, 0);
+	std::size_t line_offset = 0;
+	errors.clear();
+	for (std::size_t i = 0; i < chunk_count; ++i) {
+		offsets[i + 1] = offsets[i] + chunks[i].columns.size();
+
+		for (std::size_t j = 0; j < chunks[i].errors.size(); ++j) {
+			errors.push_back(chunks[i].errors[j]);
+			errors.back().lineNumber += line_offset + 1;
+		}
+		line_offset += chunks[i].lines;
+	}
+
+	columns.clear();
+	columns.resize(offsets[chunk_count]);
+	Parallel::forEach(chunk_count, threads, [&](std::size_t i) {
+		const FractionColumns& chunk = chunks[i].columns;
+		std::copy(chunk.numerators(), chunk.numerators() + chunk.size(), columns.numerators() + offsets[i]);
+		std::copy(chunk.denominators(), chunk.denominators() + chunk.size(), columns.denominators() + offsets[i]);
+	});
+}
+
+
+/***
+*void FractionLoader::load() - Loads fractions from a file
+*
+*Purpose:
+*       Memory-maps the file and calls loadBuffer() on it.
+*       The pages are read by the kernel as the threads touch them, and we
+*       hint it that the whole file is needed, so it reads ahead.
+*
+*Entry:
+*       const std::string&            path - The path of the file.
+*       FractionColumns&           columns - Would hold the fractions.
+*       std::vector<MalformedLine>& errors - Would hold the malformed lines.
+*
+*Exit:
+*
+*Exceptions:
+*       std::system_error - If the file can't be opened, or mapped.
+*
+*******************************************************************************/
+void FractionLoader::load(const std::string& path, FractionColumns& columns,
+	std::vector<MalformedLine>& errors) const
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::system_error(errno, std::generic_category(), path);
+
+	struct stat status;
+	if (fstat(fd, &status) < 0) {
+		int error = errno;
+		close(fd);
+		throw std::system_error(error, std::generic_category(), path);
+	}
+
+	std::size_t size = (std::size_t)status.st_size;
+	if (0 == size) {
+		close(fd);
+		columns.clear();
+		errors.clear();
+		return;
+	}
+
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	int error = errno;
+	close(fd);
+	if (MAP_FAILED == mapping)
+		throw std::system_error(error, std::generic_category(), path);
+
+	madvise(mapping, size, MADV_WILLNEED);
+
+	try {
+		this->loadBuffer((const char*)mapping, size, columns, errors);
+	}
+	catch (...) {
+		munmap(mapping, size);
+		throw;
+	}
+	munmap(mapping, size);
+}
+
+
+} //namespace fraction {
@@ -0,0 +1,104 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the FractionLoader class, and of
+* the non-allocating fraction parser it's built on
+*/
+
+
+#ifndef FRACTIONLOADER_HPP_
+#define FRACTIONLOADER_HPP_
+
+#include "FractionColumns.hpp"
+#include "ParseStatus.hpp"
+#include <cstddef> //for std::size_t
+#include <string>
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+Parses the text in [begin, end) in the format operator>> accepts -
+"numerator/denominator" or "numerator", where both are integers with an
+optional sign and no white spaces - or as a decimal (see parseDecimal()),
+without allocating anything.
+
+On success, it stores the reduced fraction (with a positive denominator) in
+'numerator' and 'denominator'.
+*/
+ParseStatus parseFraction(const char* begin, const char* end, int& numerator, int& denominator);
+
+
+//A line that couldn't be parsed.
+struct MalformedLine {
+
+	//The (1-based) line number in the input
+	std::size_t lineNumber;
+
+	//Why the line couldn't be parsed
+	ParseStatus status;
+
+	//The line itself
+	std::string text;
+};
+
+
+/*
+This class loads large text files of fractions, one per line, into
+FractionColumns.
+
+The file is memory-mapped and split into chunks that end on line boundaries.
+The chunks are parsed in parallel, each one into its own columns, and the
+columns are then stitched together in the order of the input.
+
+Unlike operator>>, which skips lines it can't parse, every line that isn't a
+valid fraction is reported with its line number. A line may end with "\r\n".
+*/
+class FractionLoader
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	'threads' is the number of threads used (0 means the number of hardware
+	threads).
+	*/
+	explicit FractionLoader(unsigned threads = 0) :
+		m_threads(threads)
+	{
+	}
+
+
+	//-- public methods --//
+
+	/*
+	Loads the file at 'path' into 'columns' (replacing their content), and
+	stores the lines that couldn't be parsed in 'errors' (sorted by line
+	number).
+
+	If the file can't be opened or mapped, it throws std::system_error.
+	*/
+	void load(const std::string& path, FractionColumns& columns,
+		std::vector<MalformedLine>& errors) const;
+
+	//The same as load(), for text that's already in memory.
+	void loadBuffer(const char* data, std::size_t size, FractionColumns& columns,
+		std::vector<MalformedLine>& errors) const;
+
+private:
+	//-- private data members --//
+
+	//The number of threads (0 means the number of hardware threads)
+	unsigned m_threads;
+
+}; //class FractionLoader {
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,287 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the prefix sums (scans) over FractionColumns.
+*/
+
+
+#include "FractionScan.hpp"
+#include "FractionAccumulator.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include "ScanOverflowException.hpp"
+#include "Parallel.hpp"
+#include "WideArithmetics.hpp"
+#include <algorithm> //for std::min, std::max, std::swap
+#include <climits> //for INT_MIN, INT_MAX
+#include <cstdint> //for std::uint64_t
+#include <vector>
+
+
+namespace fraction {
+
+
+//The minimal number of values in a chunk that's scanned by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 14;
+
+//Marks a chunk in which no output overflowed.
+static const std::size_t NO_OVERFLOW = (std::size_t)-1;
+
+
+//Returns the greatest common divisor of 'num1' and 'num2' (which isn't 0).
+//After a single division both operands are less than 'num2', and the rest
+//is done by the binary gcd - shifts and subtractions are much cheaper than
+//divisions.
+static std::uint64_t gcd(std::uint64_t num1, std::uint64_t num2) {
+	num1 %= num2;
+	if (0 == num1)
+		return num2;
+
+	int shift = __builtin_ctzll(num1 | num2);
+	num1 >>= __builtin_ctzll(num1);
+	do {
+		num2 >>= __builtin_ctzll(num2);
+		if (num1 > num2)
+			std::swap(num1, num2);
+		num2 -= num1;
+	} while (0 != num2);
+	return num1 << shift;
+}
+
+
+/***
+*bool addReduced() - Adds a fraction to a reduced total
+*
+*Purpose:
+*       Computes n/d + vn/vd, where n/d is reduced with a positive denominator,
+*       and all four fit in an 'int'.
+*
+*       The sum is computed unreduced - n*vd + vn*d over d*vd - which can't
+*       overflow 64 bits: both products are less than 2^62 in magnitude. It's
+*       then reduced with a single gcd.
+*       Running totals usually share a few denominators, so if vd divides d,
+*       the sum is (n + vn*(d/vd))/d instead, which keeps the operands of the
+*       gcd small.
+*
+*       If the reduced sum doesn't fit in an 'int', the total is left
+*       unchanged.
+*
+*Entry:
+*       long long&   numerator - The numerator of the total (n)
+*       long long& denominator - The denominator of the total (d)
+*       long long           vn - The numerator of the added fraction
+*       long long           vd - The denominator of the added fraction
+*
+*Exit:
+*       bool - 'true' if the sum fits in an 'int' (and was stored in the
+*              total), 'false' otherwise.
+*
+*Exceptions:
+*       DivisionByZeroException() - If 'vd' is 0.
+*
+*******************************************************************************/
+static bool addReduced(long long& numerator, long long& denominator, long long vn, long long vd) {
+	if (0 == vd)
+		throw DivisionByZeroException();
+
+	long long new_numerator, new_denominator;
+	if (0 == denominator % vd) {
+		new_numerator = numerator + vn * (denominator / vd);
+		new_denominator = denominator;
+	}
+	else {
+		new_numerator = numerator * vd + vn * denominator;
+		new_denominator = denominator * vd;
+		if (new_denominator < 0) {
+			new_numerator = -new_numerator;
+			new_denominator = -new_denominator;
+		}
+	}
+
+	std::uint64_t magnitude = (new_numerator < 0) ? -(std::uint64_t)new_numerator : (std::uint64_t)new_numerator;
+	long long divisor = (long long)gcd(magnitude, (std::uint64_t)new_denominator);
+	if (1 != divisor) {
+		new_numerator /= divisor;
+		new_denominator /= divisor;
+	}
+
+	if (new_numerator < INT_MIN || new_numerator > INT_MAX || new_denominator > INT_MAX)
+		return false;
+
+	numerator = new_numerator;
+	denominator = new_denominator;
+	return true;
+}
+
+
+/***
+*void scan() - Computes the inclusive or exclusive scan of 'values'
+*
+*Purpose:
+*       Let P(k) = values[0] + ... + values[k-1], so the inclusive scan
+*       outputs P(1)...P(n) and the exclusive scan outputs P(0)...P(n-1).
+*
+*       The values are split into chunks, and:
+*       1) Every chunk but the last is summed (in parallel). The sum is kept
+*          reduced in 64 bits with addReduced() while it fits, and in a
+*          FractionAccumulator from then on.
+*       2) The sums are added up (serially - there are only a few chunks) into
+*          P(begin) of every chunk. If P(begin) of a chunk doesn't fit in an
+*          'int' (or the sum of the previous chunk overflowed 128 bits), then
+*          an output of the previous chunks overflows, and neither it nor the
+*          following chunks are scanned.
+*       3) Every chunk is scanned from its P(begin) with addReduced() (in
+*          parallel), and the index of the first output that overflows in
+*          every chunk is recorded.
+*
+*       Since the prefix sums are reduced, if P(begin) and P(end) of a chunk
+*       both fit in an 'int', then the sums of its parts (which are
+*       differences of prefix sums) fit in 64 bits - so if the sum of a chunk
+*       overflows 128 bits, then an output of that chunk (or of an earlier one)
+*       overflows, and the third step finds it.
+*
+*       With a single thread, there's a single chunk, and only the third step
+*       is done.
+*
+*       Every output is written after its value is read, so the scan can be
+*       done in place.
+*
+*Entry:
+*       const FractionColumns& values - The values to scan.
+*       FractionColumns&       result - Would hold the prefix sums.
+*       unsigned              threads - The number of threads.
+*       bool                exclusive - 'true' for an exclusive scan.
+*
+*Exit:
+*
+*Exceptions:
+*       ScanOverflowException()   - If an output doesn't fit in an 'int'.
+*       DivisionByZeroException() - If a denominator is 0.
+*
+*******************************************************************************/
+static void scan(const FractionColumns& values, FractionColumns& result, unsigned threads, bool exclusive) {
+	std::size_t count = values.size();
+	result.resize(count);
+	if (0 == count)
+		return;
+
+	const int* numerators = values.numerators();
+	const int* denominators = values.denominators();
+	int* result_numerators = result.numerators();
+	int* result_denominators = result.denominators();
+
+	unsigned thread_count = Parallel::threadCount(threads);
+	std::size_t chunks = (1 == thread_count) ? 1 : std::max<std::size_t>(1,
+		std::min<std::size_t>(thread_count * 4, count / MIN_CHUNK_SIZE));
+
+	//1) The sums of the chunks.
+	std::vector<FractionAccumulator> sums(chunks - 1);
+	std::vector<char> sum_overflowed(chunks - 1, 0);
+
+	if (chunks > 1) {
+		Parallel::forEach(chunks - 1, threads, [&](std::size_t chunk) {
+			std::size_t begin = count * chunk / chunks;
+			std::size_t end = count * (chunk + 1) / chunks;
+
+			long long numerator = 0, denominator = 1;
+			std::size_t i = begin;
+			while (i < end && addReduced(numerator, denominator, numerators[i], denominators[i]))
+				++i;
+
+			try {
+				sums[chunk].add((int)numerator, (int)denominator);
+				for (; i < end; ++i)
+					sums[chunk].add(numerators[i], denominators[i]);
+			}
+			catch (NumericOverflowException&) {
+				sum_overflowed[chunk] = 1;
+			}
+		});
+	}
+
+	//2) The prefix sum that precedes every chunk.
+	std::vector<long long> offset_numerators(chunks, 0), offset_denominators(chunks, 1);
+	std::size_t scanned_chunks = chunks;
+	FractionAccumulator total;
+
+	for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+		if (sum_overflowed[chunk - 1]) {
+			scanned_chunks = chunk;
+			break;
+		}
+
+		try {
+			total.merge(sums[chunk - 1]);
+		}
+		catch (NumericOverflowException&) {
+			scanned_chunks = chunk;
+			break;
+		}
+
+		total.reduce();
+		if (!WideArithmetics::fitsInt(total.getNumerator()) || !WideArithmetics::fitsInt(total.getDenominator())) {
+			scanned_chunks = chunk;
+			break;
+		}
+
+		offset_numerators[chunk] = (long long)total.getNumerator();
+		offset_denominators[chunk] = (long long)total.getDenominator();
+	}
+
+	//3) Scanning every chunk from its preceding prefix sum.
+	std::vector<std::size_t> overflow_index(scanned_chunks, NO_OVERFLOW);
+
+	Parallel::forEach(scanned_chunks, threads, [&](std::size_t chunk) {
+		std::size_t begin = count * chunk / chunks;
+		std::size_t end = count * (chunk + 1) / chunks;
+
+		long long numerator = offset_numerators[chunk];
+		long long denominator = offset_denominators[chunk];
+
+		if (exclusive) {
+			for (std::size_t i = begin; i < end; ++i) {
+				long long vn = numerators[i], vd = denominators[i];
+				result_numerators[i] = (int)numerator;
+				result_denominators[i] = (int)denominator;
+
+				if (!addReduced(numerator, denominator, vn, vd)) {
+					if (i + 1 < count)
+						overflow_index[chunk] = i + 1;
+					return;
+				}
+			}
+		}
+		else {
+			for (std::size_t i = begin; i < end; ++i) {
+				if (!addReduced(numerator, denominator, numerators[i], denominators[i])) {
+					overflow_index[chunk] = i;
+					return;
+				}
+
+				result_numerators[i] = (int)numerator;
+				result_denominators[i] = (int)denominator;
+			}
+		}
+	});
+
+	for (std::size_t chunk = 0; chunk < scanned_chunks; ++chunk) {
+		if (NO_OVERFLOW != overflow_index[chunk])
+			throw ScanOverflowException(overflow_index[chunk]);
+	}
+}
+
+
+//An inclusive scan(): the outputs are P(1)...P(n).
+void inclusiveScan(const FractionColumns& values, FractionColumns& result, unsigned threads) {
+	scan(values, result, threads, false);
+}
+
+
+//An exclusive scan(): the outputs are P(0)...P(n-1).
+void exclusiveScan(const FractionColumns& values, FractionColumns& result, unsigned threads) {
+	scan(values, result, threads, true);
+}
+
+} //namespace fraction {
@@ -0,0 +1,52 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the prefix sums (scans) over
+* FractionColumns
+*/
+
+
+#ifndef FRACTIONSCAN_HPP_
+#define FRACTIONSCAN_HPP_
+
+#include "FractionColumns.hpp"
+
+
+namespace fraction {
+
+
+/*
+These functions compute the running totals of columns of fractions exactly,
+in parallel chunks on 'threads' threads (0 means the number of hardware
+threads).
+
+The scan is done in two passes. The first pass sums every chunk into a
+FractionAccumulator (128 bits, reduced only when it grows), and the sums of
+the chunks are added up into the total that precedes every chunk. The second
+pass scans every chunk from its preceding total: every sum of a total and a
+value is computed unreduced in 64 bits (where it can't overflow) and then
+reduced once into its output - so there is a single gcd per output, and no
+overflow checks in between.
+
+'result' is resized to the size of 'values', and may be 'values' itself (the
+scan is then done in place). Its fractions are reduced, with positive
+denominators.
+
+If an output doesn't fit in a Fraction, ScanOverflowException() is thrown
+with the index of the first such output, and the content of 'result' is
+undefined.
+If a denominator is 0, DivisionByZeroException() is thrown.
+*/
+
+
+//Sets result[i] to values[0] + ... + values[i].
+void inclusiveScan(const FractionColumns& values, FractionColumns& result, unsigned threads = 0);
+
+//Sets result[i] to values[0] + ... + values[i-1] (so result[0] is 0).
+void exclusiveScan(const FractionColumns& values, FractionColumns& result, unsigned threads = 0);
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,65 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of the scans of FractionScan.hpp.
+*
+* It computes the running totals of the same random columns by chaining
+* Fraction::operator+= and with inclusiveScan() on one thread and on all the
+* hardware threads, and prints the time per value of each.
+*/
+
+#include "Benchmark.hpp"
+#include "FractionScan.hpp"
+#include "Parallel.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <random>
+
+
+//The number of values in the columns.
+static const std::size_t VALUES = 1 << 22;
+
+
+int main() {
+	//Denominators that divide 40 and balanced numerators, so the running totals
+	//stay small enough for operator+= not to overflow.
+	static const int DENOMINATORS[] = { 1, 2, 4, 5, 8, 10, 20, 40 };
+
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> numerator_distribution(-1000, 1000);
+	std::uniform_int_distribution<int> denominator_distribution(0, 7);
+
+	fraction::FractionColumns values;
+	values.reserve(VALUES);
+	for (std::size_t i = 0; i < VALUES; ++i)
+		values.pushBack(fraction::Fraction(numerator_distribution(generator),
+			DENOMINATORS[denominator_distribution(generator)]));
+
+	fraction::FractionColumns chained(VALUES), scanned;
+
+	double chained_time = Benchmark::measure(VALUES, [&]() {
+		fraction::Fraction total(0);
+		for (std::size_t i = 0; i < VALUES; ++i) {
+			total += values.at(i);
+			chained.numerators()[i] = total.getNumerator();
+			chained.denominators()[i] = total.getDenominator();
+		}
+	});
+	std::cout << "operator+=\t\t" << chained_time << " ns/value" << std::endl;
+
+	double serial_time = Benchmark::measure(VALUES, [&]() { fraction::inclusiveScan(values, scanned, 1); });
+	std::cout << "inclusiveScan(), 1 thread\t" << serial_time << " ns/value" << std::endl;
+
+	unsigned threads = Parallel::threadCount(0);
+	double parallel_time = Benchmark::measure(VALUES, [&]() { fraction::inclusiveScan(values, scanned, threads); });
+	std::cout << "inclusiveScan(), " << threads << " threads\t" << parallel_time << " ns/value" << std::endl;
+
+	bool same = true;
+	for (std::size_t i = 0; i < VALUES; ++i) {
+		if (chained.numerators()[i] != scanned.numerators()[i] || chained.denominators()[i] != scanned.denominators()[i])
+			same = false;
+	}
+	std::cout << (same ? "same totals" : "DIFFERENT TOTALS") << std::endl;
+}
@@ -0,0 +1,404 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the exact statistics over FractionColumns
+*/
+
+
+#include "FractionStatistics.hpp"
+#include "DivisionByZeroException.hpp"
+#include "FractionAccumulator.hpp"
+#include "Parallel.hpp"
+#include <algorithm> //for std::nth_element, std::sort, std::push_heap, std::pop_heap
+#include <stdexcept> //for std::invalid_argument
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//The minimal number of values in a chunk that's processed by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 16;
+
+
+//A value of the columns, copied out for partitioning.
+struct ValueEntry {
+	int numerator;
+	int denominator; //positive
+};
+
+
+//lhs < rhs, by cross-multiplying in 64 bits (the denominators are positive).
+static bool lessThan(const ValueEntry& lhs, const ValueEntry& rhs) {
+	return (long long)lhs.numerator * rhs.denominator < (long long)rhs.numerator * lhs.denominator;
+}
+
+
+//lhs > rhs - the order of the bounded heaps of topK(), which keep the smallest
+//of the values they hold on top.
+static bool greaterThan(const ValueEntry& lhs, const ValueEntry& rhs) {
+	return lessThan(rhs, lhs);
+}
+
+
+//Returns the number of parallel chunks of 'count' values - a few per thread,
+//as long as the chunks aren't too small.
+static std::size_t chunkCount(std::size_t count, unsigned threads) {
+	return std::max<std::size_t>(1,
+		std::min<std::size_t>(Parallel::threadCount(threads) * 4, count / MIN_CHUNK_SIZE));
+}
+
+
+//Copies the values of the columns.
+static std::vector<ValueEntry> copyEntries(const FractionColumns& values) {
+	const int* numerators = values.numerators();
+	const int* denominators = values.denominators();
+
+	std::vector<ValueEntry> entries(values.size());
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		entries[i].numerator = numerators[i];
+		entries[i].denominator = denominators[i];
+	}
+	return entries;
+}
+
+
+//Returns the ValueEntry as a WideFraction (the columns are reduced).
+static WideFraction toWide(const ValueEntry& entry) {
+	WideFraction result;
+	result.numerator = entry.numerator;
+	result.denominator = entry.denominator;
+	return result;
+}
+
+
+//-- moments --//
+
+
+/***
+*void sumMoments() - Sums the values, and optionally their squares
+*
+*Purpose:
+*       Every parallel chunk sums its values (and their squares) into its own
+*       FractionAccumulators, which are then merged in order into 'sum' (and
+*       'squares').
+*
+*       The square of a reduced n/d is n^2/d^2, which is reduced as well, and
+*       both fit in 64 bits.
+*
+*Entry:
+*       const FractionColumns&   values - The values.
+*       unsigned                threads - The number of threads.
+*       FractionAccumulator&        sum - Would hold the sum.
+*       FractionAccumulator*    squares - If not nullptr, would hold the sum
+*                                         of the squares.
+*
+*Exit:
+*
+*Exceptions:
+*       DivisionByZeroException() - If a denominator is 0.
+*       NumericOverflowException() - If a sum doesn't fit in 128 bits.
+*
+*******************************************************************************/
+static void sumMoments(const FractionColumns& values, unsigned threads, FractionAccumulator& sum,
+	FractionAccumulator* squares)
+{
+	const int* numerators = values.numerators();
+	const int* denominators = values.denominators();
+	std::size_t count = values.size();
+	std::size_t chunks = chunkCount(count, threads);
+
+	std::vector<FractionAccumulator> chunk_sums(chunks), chunk_squares((nullptr != squares) ? chunks : 0);
+
+	Parallel::forEach(chunks, threads, [&](std::size_t chunk) {
+		std::size_t begin = count * chunk / chunks;
+		std::size_t end = count * (chunk + 1) / chunks;
+
+		FractionAccumulator& chunk_sum = chunk_sums[chunk];
+		for (std::size_t i = begin; i < end; ++i)
+			chunk_sum.add(numerators[i], denominators[i]);
+
+		if (nullptr == squares)
+			return;
+
+		FractionAccumulator& chunk_square = chunk_squares[chunk];
+		for (std::size_t i = begin; i < end; ++i) {
+			int128 numerator = numerators[i];
+			int128 denominator = denominators[i];
+			chunk_square.merge(numerator * numerator, denominator * denominator, 1);
+		}
+	});
+
+	for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+		sum.merge(chunk_sums[chunk]);
+		if (nullptr != squares)
+			squares->merge(chunk_squares[chunk]);
+	}
+}
+
+
+//Returns the reduced sum of the accumulator divided by 'count'.
+static WideFraction divideByCount(FractionAccumulator& accumulator, std::size_t count) {
+	accumulator.reduce();
+
+	WideFraction sum;
+	sum.numerator = accumulator.getNumerator();
+	sum.denominator = accumulator.getDenominator();
+
+	return sum * WideFraction::reduced(1, (int128)count);
+}
+
+
+//sum/count
+WideFraction mean(const FractionColumns& values, unsigned threads) {
+	if (values.empty())
+		throw DivisionByZeroException();
+
+	FractionAccumulator sum;
+	sumMoments(values, threads, sum, nullptr);
+
+	return divideByCount(sum, values.size());
+}
+
+
+//The mean of the squares minus the square of the mean - exact, so there's no
+//cancellation error - and for the sample variance, times count/(count-1).
+WideFraction variance(const FractionColumns& values, bool sample, unsigned threads) {
+	std::size_t count = values.size();
+	if (0 == count || (sample && 1 == count))
+		throw DivisionByZeroException();
+
+	FractionAccumulator sum, squares;
+	sumMoments(values, threads, sum, &squares);
+
+	WideFraction mean_value = divideByCount(sum, count);
+	WideFraction mean_square = divideByCount(squares, count);
+	WideFraction result = mean_square - mean_value * mean_value;
+
+	if (sample)
+		result = result * WideFraction::reduced((int128)count, (int128)(count - 1));
+
+	return result;
+}
+
+
+//-- selection --//
+
+
+/***
+*void selectRanks() - Partitions a range so that the values of the given ranks
+*                     are in their sorted positions
+*
+*Purpose:
+*       Puts the value of the middle rank in its position with
+*       std::nth_element - after which every value before it is less than or
+*       equal to it, and every value after it is greater than or equal to it -
+*       and then does the same for the ranks below it in the range before it,
+*       and for the ranks above it in the range after it.
+*
+*       Every level of the recursion partitions disjoint ranges of a total
+*       length of at most the whole range, and there are log(rankCount)
+*       levels.
+*
+*Entry:
+*       ValueEntry*                first - The beginning of the range.
+*       ValueEntry*                 last - The end of the range.
+*       const std::size_t*    ranks - The sorted, distinct ranks (in the
+*                                     whole array) in the range.
+*       std::size_t       rankCount - The number of ranks.
+*       std::size_t          offset - The rank of 'first' in the whole array.
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+static void selectRanks(ValueEntry* first, ValueEntry* last, const std::size_t* ranks, std::size_t rankCount,
+	std::size_t offset)
+{
+	if (0 == rankCount)
+		return;
+
+	std::size_t middle = rankCount / 2;
+	std::size_t rank = ranks[middle];
+	ValueEntry* nth = first + (rank - offset);
+
+	std::nth_element(first, nth, last, lessThan);
+
+	selectRanks(first, nth, ranks, middle, offset);
+	selectRanks(nth + 1, last, ranks + middle + 1, rankCount - middle - 1, rank + 1);
+}
+
+
+//Partitions a copy of the values around the rank.
+Fraction select(const FractionColumns& values, std::size_t rank) {
+	if (rank >= values.size())
+		throw std::invalid_argument("select(): The rank is out of range");
+
+	std::vector<ValueEntry> entries = copyEntries(values);
+	std::nth_element(entries.begin(), entries.begin() + rank, entries.end(), lessThan);
+
+	return Fraction(entries[rank].numerator, entries[rank].denominator);
+}
+
+
+/***
+*std::vector<WideFraction> quantiles() - Computes interpolated quantiles
+*
+*Purpose:
+*       The position of the quantile at p = pn/pd is h = (count-1)*p, which is
+*       split exactly into its integer part 'low' and the remainder
+*       r/pd = h - low. The quantile is then
+*
+*           x[low] + (r/pd) * (x[low+1] - x[low])
+*
+*       where x is the sorted values (x[low+1] isn't needed if r is 0).
+*
+*       The ranks of all the quantiles are collected first, and selected
+*       together with selectRanks().
+*
+*Entry:
+*       const FractionColumns&              values - The values.
+*       const std::vector<Fraction>& probabilities - The probabilities.
+*
+*Exit:
+*       std::vector<WideFraction> - The quantile of every probability.
+*
+*Exceptions:
+*       std::invalid_argument - If there are no values, or a probability isn't
+*                               in [0, 1].
+*
+*******************************************************************************/
+std::vector<WideFraction> quantiles(const FractionColumns& values, const std::vector<Fraction>& probabilities) {
+	if (values.empty())
+		throw std::invalid_argument("quantiles(): There are no values");
+
+	std::size_t count = values.size();
+	std::vector<int128> lows(probabilities.size()), remainders(probabilities.size());
+	std::vector<std::size_t> ranks;
+
+	for (std::size_t i = 0; i < probabilities.size(); ++i) {
+		const Fraction& probability = probabilities[i];
+		if (probability < 0 || probability > 1)
+			throw std::invalid_argument("quantiles(): A probability isn't in [0, 1]");
+
+		int128 position = (int128)(count - 1) * probability.getNumerator();
+		lows[i] = position / probability.getDenominator();
+		remainders[i] = position % probability.getDenominator();
+
+		ranks.push_back((std::size_t)lows[i]);
+		if (0 != remainders[i])
+			ranks.push_back((std::size_t)lows[i] + 1);
+	}
+
+	std::sort(ranks.begin(), ranks.end());
+	ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+	std::vector<ValueEntry> entries = copyEntries(values);
+	selectRanks(entries.data(), entries.data() + count, ranks.data(), ranks.size(), 0);
+
+	std::vector<WideFraction> results(probabilities.size());
+	for (std::size_t i = 0; i < probabilities.size(); ++i) {
+		WideFraction low = toWide(entries[(std::size_t)lows[i]]);
+		if (0 == remainders[i]) {
+			results[i] = low;
+			continue;
+		}
+
+		WideFraction high = toWide(entries[(std::size_t)lows[i] + 1]);
+		WideFraction weight = WideFraction::reduced(remainders[i], probabilities[i].getDenominator());
+		results[i] = low + weight * (high - low);
+	}
+
+	return results;
+}
+
+
+//The quantile at 1/2.
+WideFraction median(const FractionColumns& values) {
+	return quantiles(values, std::vector<Fraction>(1, Fraction(1, 2)))[0];
+}
+
+
+//-- top-k --//
+
+
+/***
+*std::vector<Fraction> topK() - Returns the k largest values
+*
+*Purpose:
+*       Every parallel chunk keeps the k largest values it has seen in a
+*       min-heap: while the heap isn't full every value is pushed, and after
+*       that a value replaces the top only if it's larger than it.
+*
+*       The heaps of the chunks are then concatenated, the k largest of them
+*       are selected with std::nth_element, and sorted.
+*
+*Entry:
+*       const FractionColumns& values - The values.
+*       std::size_t                 k - The number of values.
+*       unsigned              threads - The number of threads.
+*
+*Exit:
+*       std::vector<Fraction> - The min(k, count) largest values, from the
+*                               largest.
+*
+*Exceptions:
+*
+*******************************************************************************/
+std::vector<Fraction> topK(const FractionColumns& values, std::size_t k, unsigned threads) {
+	const int* numerators = values.numerators();
+	const int* denominators = values.denominators();
+	std::size_t count = values.size();
+
+	if (0 == k || 0 == count)
+		return std::vector<Fraction>();
+
+	std::size_t chunks = chunkCount(count, threads);
+	std::vector<std::vector<ValueEntry> > heaps(chunks);
+
+	Parallel::forEach(chunks, threads, [&](std::size_t chunk) {
+		std::size_t begin = count * chunk / chunks;
+		std::size_t end = count * (chunk + 1) / chunks;
+
+		std::vector<ValueEntry>& heap = heaps[chunk];
+		heap.reserve(std::min(k, end - begin));
+
+		for (std::size_t i = begin; i < end; ++i) {
+			ValueEntry entry = { numerators[i], denominators[i] };
+
+			if (heap.size() < k) {
+				heap.push_back(entry);
+				std::push_heap(heap.begin(), heap.end(), greaterThan);
+			}
+			else if (lessThan(heap.front(), entry)) {
+				std::pop_heap(heap.begin(), heap.end(), greaterThan);
+				heap.back() = entry;
+				std::push_heap(heap.begin(), heap.end(), greaterThan);
+			}
+		}
+	});
+
+	std::vector<ValueEntry> largest;
+	for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+		largest.insert(largest.end(), heaps[chunk].begin(), heaps[chunk].end());
+
+	if (largest.size() > k) {
+		std::nth_element(largest.begin(), largest.begin() + k, largest.end(), greaterThan);
+		largest.resize(k);
+	}
+	std::sort(largest.begin(), largest.end(), greaterThan);
+
+	std::vector<Fraction> results;
+	results.reserve(largest.size());
+	for (std::size_t i = 0; i < largest.size(); ++i)
+		results.push_back(Fraction(largest[i].numerator, largest[i].denominator));
+
+	return results;
+}
+
+} //namespace fraction {
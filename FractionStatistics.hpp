@@ -0,0 +1,94 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the exact statistics over
+* FractionColumns
+*/
+
+
+#ifndef FRACTIONSTATISTICS_HPP_
+#define FRACTIONSTATISTICS_HPP_
+
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include "WideFraction.hpp"
+#include <cstddef> //for std::size_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+These functions compute statistics of columns of fractions exactly - without
+converting them to floating point.
+
+The columns are expected to be reduced, with positive denominators (see
+FractionColumns.hpp), and the values are compared by cross-multiplying them in
+64 bits, where nothing can overflow.
+
+The sums of mean() and variance() are kept in FractionAccumulators (128 bits,
+reduced only when they grow) over parallel chunks on 'threads' threads (0
+means the number of hardware threads). If a sum, or the result (or an
+intermediate of it), doesn't fit in 128 bits, they throw
+NumericOverflowException().
+*/
+
+
+/*
+Returns the mean of the values.
+If there are no values, it throws DivisionByZeroException().
+*/
+WideFraction mean(const FractionColumns& values, unsigned threads = 0);
+
+/*
+Returns the variance of the values: the mean of the squared deviations from
+their mean if 'sample' is 'false', and the unbiased sample variance (the sum
+divided by the count minus 1) otherwise.
+If there are no values (or a single value, for the sample variance), it throws
+DivisionByZeroException().
+*/
+WideFraction variance(const FractionColumns& values, bool sample = false, unsigned threads = 0);
+
+/*
+Returns the value of the given rank (0-based) in the sorted order of the
+values - e.g. rank 0 is the minimum.
+It partitions a copy of the values (like std::nth_element), in linear time.
+If the rank isn't less than the number of values, it throws
+std::invalid_argument.
+*/
+Fraction select(const FractionColumns& values, std::size_t rank);
+
+/*
+Returns the quantiles of the values at the given probabilities (in [0, 1]).
+
+The quantile at p is interpolated between the two values around the position
+(count-1)*p of the sorted values - so the quantile at 1/2 is the median, and
+the quantiles at 0 and 1 are the minimum and the maximum.
+All the values the quantiles need are selected with a single partitioning of a
+copy of the values, in O(count*log(probabilities)) time.
+
+If there are no values, or a probability isn't in [0, 1], it throws
+std::invalid_argument.
+*/
+std::vector<WideFraction> quantiles(const FractionColumns& values, const std::vector<Fraction>& probabilities);
+
+//Returns the median of the values (the mean of the two middle values, for an
+//even count). If there are no values, it throws std::invalid_argument.
+WideFraction median(const FractionColumns& values);
+
+/*
+Returns the 'k' largest values, from the largest (or all of them, if there are
+fewer). Equal values are returned in an unspecified order.
+
+Every parallel chunk keeps its k largest values in a bounded heap - a value
+smaller than the top of a full heap costs a single comparison - and then the
+heaps of the chunks are merged.
+*/
+std::vector<Fraction> topK(const FractionColumns& values, std::size_t k, unsigned threads = 0);
+
+} //namespace fraction {
+
+#endif
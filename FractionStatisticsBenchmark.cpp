@@ -0,0 +1,92 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of the statistics of FractionStatistics.hpp.
+*
+* It computes the median, the quartiles and the top 100 of the same random
+* columns with the statistics, and by sorting a vector of Fractions with
+* operator< (the usual way), and prints the time of each. It also prints the
+* time of the exact mean and variance.
+*/
+
+#include "Benchmark.hpp"
+#include "FractionStatistics.hpp"
+#include <algorithm> //for std::sort
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of values in the columns.
+static const std::size_t VALUES = 1 << 22;
+
+//The number of values of the top-k.
+static const std::size_t TOP_K = 100;
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> numerator_distribution(-1000000, 1000000);
+	//Small denominators, so the exact sums (over their lcm) fit in 128 bits.
+	std::uniform_int_distribution<int> denominator_distribution(1, 16);
+
+	fraction::FractionColumns columns;
+	columns.reserve(VALUES);
+	for (std::size_t i = 0; i < VALUES; ++i)
+		columns.pushBack(fraction::Fraction(numerator_distribution(generator), denominator_distribution(generator)));
+
+	std::vector<fraction::Fraction> probabilities;
+	probabilities.push_back(fraction::Fraction(1, 4));
+	probabilities.push_back(fraction::Fraction(1, 2));
+	probabilities.push_back(fraction::Fraction(3, 4));
+
+	std::vector<fraction::WideFraction> quartiles;
+	std::vector<fraction::Fraction> top;
+	double statistics_time = Benchmark::measure(VALUES, [&]() {
+		quartiles = fraction::quantiles(columns, probabilities);
+		top = fraction::topK(columns, TOP_K);
+	});
+
+	std::vector<fraction::Fraction> sorted;
+	double sort_time = Benchmark::measure(VALUES, [&]() {
+		sorted.reserve(VALUES);
+		for (std::size_t i = 0; i < VALUES; ++i)
+			sorted.push_back(columns.at(i));
+		std::sort(sorted.begin(), sorted.end());
+	});
+
+	//The quantile at p interpolates between the sorted values around (VALUES-1)*p.
+	for (std::size_t i = 0; i < probabilities.size(); ++i) {
+		std::size_t position = (VALUES - 1) * probabilities[i].getNumerator();
+		std::size_t low = position / probabilities[i].getDenominator();
+		int remainder = (int)(position % probabilities[i].getDenominator());
+
+		fraction::Fraction expected = sorted[low] +
+			(sorted[low + 1] - sorted[low]) * fraction::Fraction(remainder, probabilities[i].getDenominator());
+		if (!(quartiles[i].toFraction() == expected)) {
+			std::cout << "quartiles differ!" << std::endl;
+			return 1;
+		}
+	}
+	for (std::size_t i = 0; i < TOP_K; ++i) {
+		if (!(top[i] == sorted[VALUES - 1 - i])) {
+			std::cout << "top values differ!" << std::endl;
+			return 1;
+		}
+	}
+
+	fraction::WideFraction mean, variance;
+	double moments_time = Benchmark::measure(VALUES, [&]() {
+		mean = fraction::mean(columns);
+		variance = fraction::variance(columns);
+	});
+
+	std::cout << "quartiles + top " << TOP_K << "\tstatistics " << statistics_time << " ns/value, sort "
+		<< sort_time << " ns/value" << std::endl;
+	std::cout << "mean + variance\t\t" << moments_time << " ns/value (mean " << mean.toString() << ")" << std::endl;
+
+	return 0;
+}
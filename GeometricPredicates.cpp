@@ -0,0 +1,372 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the exact geometric predicates over points with
+* Fraction coordinates
+*/
+
+
+#include "GeometricPredicates.hpp"
+#include "WideArithmetics.hpp"
+#include <cfloat> //for DBL_EPSILON
+#include <cmath> //for std::fabs
+#include <cstdint> //for std::uint64_t
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+/*
+The bounds of the rounding errors of the floating-point determinants, relative
+to their "permanents" (the same sums of products, over the absolute values of
+the coordinates). With u = DBL_EPSILON/2, a coordinate is off by at most u of
+itself after the conversion, a difference of two coordinates by 2u of the sum
+of their magnitudes, and every further operation adds (about) u - which adds
+up to 6.01u for orientation() and 15.02u for inCircle(). The bounds are
+rounded up, also to cover the rounding of the permanents themselves.
+*/
+static const double ORIENTATION_ERROR = 4 * DBL_EPSILON;
+static const double INCIRCLE_ERROR = 10 * DBL_EPSILON;
+
+
+namespace {
+
+/*
+A fixed-width signed integer (in sign-magnitude) of LIMBS 64-bit limbs -
+just what the exact determinants need: constructing from 128 bits, adding,
+subtracting, multiplying and the sign. The results are truncated to LIMBS
+limbs, which is enough for the determinants of 'int' coordinates.
+*/
+class WideInteger
+{
+public:
+	//The number of 64-bit limbs (512 bits).
+	static const int LIMBS = 8;
+
+	//Creates 'value'.
+	explicit WideInteger(int128 value) :
+		m_negative(value < 0)
+	{
+		unsigned __int128 magnitude = this->m_negative ? -(unsigned __int128)value : (unsigned __int128)value;
+		this->m_limbs[0] = (std::uint64_t)magnitude;
+		this->m_limbs[1] = (std::uint64_t)(magnitude >> 64);
+		for (int i = 2; i < LIMBS; ++i)
+			this->m_limbs[i] = 0;
+	}
+
+	//Returns the sign (-1, 0 or 1).
+	int sign() const {
+		for (int i = 0; i < LIMBS; ++i) {
+			if (0 != this->m_limbs[i])
+				return this->m_negative ? -1 : 1;
+		}
+		return 0;
+	}
+
+	//Returns lhs+rhs.
+	friend WideInteger operator+ (const WideInteger& lhs, const WideInteger& rhs) {
+		if (lhs.m_negative == rhs.m_negative) {
+			WideInteger result = lhs;
+			std::uint64_t carry = 0;
+			for (int i = 0; i < LIMBS; ++i) {
+				unsigned __int128 sum = (unsigned __int128)lhs.m_limbs[i] + rhs.m_limbs[i] + carry;
+				result.m_limbs[i] = (std::uint64_t)sum;
+				carry = (std::uint64_t)(sum >> 64);
+			}
+			return result;
+		}
+
+		//The signs differ: subtract the smaller magnitude from the larger.
+		bool lhs_larger = (compareMagnitudes(lhs, rhs) >= 0);
+		const WideInteger& larger = lhs_larger ? lhs : rhs;
+		const WideInteger& smaller = lhs_larger ? rhs : lhs;
+
+		WideInteger result = larger;
+		std::uint64_t borrow = 0;
+		for (int i = 0; i < LIMBS; ++i) {
+			unsigned __int128 difference = (unsigned __int128)larger.m_limbs[i] - smaller.m_limbs[i] - borrow;
+			result.m_limbs[i] = (std::uint64_t)difference;
+			borrow = (std::uint64_t)(difference >> 64) & 1;
+		}
+		return result;
+	}
+
+	//Returns lhs-rhs.
+	friend WideInteger operator- (const WideInteger& lhs, const WideInteger& rhs) {
+		WideInteger negated = rhs;
+		negated.m_negative = !rhs.m_negative;
+		return lhs + negated;
+	}
+
+	//Returns lhs*rhs (schoolbook).
+	friend WideInteger operator* (const WideInteger& lhs, const WideInteger& rhs) {
+		WideInteger result(0);
+		result.m_negative = (lhs.m_negative != rhs.m_negative);
+
+		//The limbs of rhs above its highest non-zero limb are skipped.
+		int rhs_limbs = LIMBS;
+		while (rhs_limbs > 0 && 0 == rhs.m_limbs[rhs_limbs - 1])
+			--rhs_limbs;
+
+		for (int i = 0; i < LIMBS; ++i) {
+			if (0 == lhs.m_limbs[i])
+				continue;
+
+			std::uint64_t carry = 0;
+			int j = 0;
+			for (; j < rhs_limbs && i + j < LIMBS; ++j) {
+				unsigned __int128 product = (unsigned __int128)lhs.m_limbs[i] * rhs.m_limbs[j] +
+					result.m_limbs[i + j] + carry;
+				result.m_limbs[i + j] = (std::uint64_t)product;
+				carry = (std::uint64_t)(product >> 64);
+			}
+			if (i + j < LIMBS)
+				result.m_limbs[i + j] = carry;
+		}
+		return result;
+	}
+
+private:
+	//Whether the integer is negative
+	bool m_negative;
+
+	//The magnitude, from the least significant limb
+	std::uint64_t m_limbs[LIMBS];
+
+	//Returns the sign of |lhs| - |rhs|.
+	static int compareMagnitudes(const WideInteger& lhs, const WideInteger& rhs) {
+		for (int i = LIMBS - 1; i >= 0; --i) {
+			if (lhs.m_limbs[i] != rhs.m_limbs[i])
+				return (lhs.m_limbs[i] > rhs.m_limbs[i]) ? 1 : -1;
+		}
+		return 0;
+	}
+};
+
+} //namespace {
+
+
+//Returns 'frac' as a double (rounded once - the numerator and denominator are
+//exact in a double).
+static double toDouble(const Fraction& frac) {
+	return (double)frac.getNumerator() / (double)frac.getDenominator();
+}
+
+
+//Returns the sign of 'value'.
+static int sign(double value) {
+	return (value > 0) - (value < 0);
+}
+
+
+//Returns a*d - b*c as a WideInteger (the products may need more than 128 bits).
+static WideInteger minor(int128 a, int128 b, int128 c, int128 d) {
+	return WideInteger(a) * WideInteger(d) - WideInteger(b) * WideInteger(c);
+}
+
+
+/***
+*int exactOrientation() - Computes the sign of the orientation exactly
+*
+*Purpose:
+*       Multiplies the row (x, y, 1) of every point x = p/q, y = r/s by q*s,
+*       which gives the integer row (p*s, r*q, q*s) of up to 62 bits, and
+*       computes the determinant by the third column. The 2x2 minors of the
+*       first two columns fit in 125 bits, and the whole determinant in 190.
+*
+*Entry:
+*       const FractionPoint& a, b, c - The points.
+*
+*Exit:
+*       int - The sign of the determinant.
+*
+*Exceptions:
+*
+*******************************************************************************/
+static int exactOrientation(const FractionPoint& a, const FractionPoint& b, const FractionPoint& c) {
+	const FractionPoint* points[3] = { &a, &b, &c };
+	int128 rows[3][3];
+
+	for (int i = 0; i < 3; ++i) {
+		long long p = points[i]->x.getNumerator(), q = points[i]->x.getDenominator();
+		long long r = points[i]->y.getNumerator(), s = points[i]->y.getDenominator();
+		rows[i][0] = p * s;
+		rows[i][1] = r * q;
+		rows[i][2] = q * s;
+	}
+
+	WideInteger determinant =
+		WideInteger(rows[0][2]) * WideInteger(rows[1][0] * rows[2][1] - rows[1][1] * rows[2][0]) -
+		WideInteger(rows[1][2]) * WideInteger(rows[0][0] * rows[2][1] - rows[0][1] * rows[2][0]) +
+		WideInteger(rows[2][2]) * WideInteger(rows[0][0] * rows[1][1] - rows[0][1] * rows[1][0]);
+	return determinant.sign();
+}
+
+
+/***
+*int exactInCircle() - Computes the sign of the in-circle determinant exactly
+*
+*Purpose:
+*       Multiplies the row (x, y, x^2+y^2, 1) of every point x = p/q, y = r/s
+*       by (q*s)^2, which gives the integer row
+*
+*           (p*q*s^2, r*s*q^2, p^2*s^2 + r^2*q^2, q^2*s^2)
+*
+*       of up to 125 bits, and computes the determinant by the Laplace
+*       expansion along the first two rows - the sum of the products of their
+*       2x2 minors (up to 251 bits) with the complementary minors of the last
+*       two rows. The whole determinant fits in 505 bits.
+*
+*Entry:
+*       const FractionPoint& a, b, c, d - The points.
+*
+*Exit:
+*       int - The sign of the determinant.
+*
+*Exceptions:
+*
+*******************************************************************************/
+static int exactInCircle(const FractionPoint& a, const FractionPoint& b, const FractionPoint& c,
+	const FractionPoint& d)
+{
+	const FractionPoint* points[4] = { &a, &b, &c, &d };
+	int128 rows[4][4];
+
+	for (int i = 0; i < 4; ++i) {
+		int128 p = points[i]->x.getNumerator(), q = points[i]->x.getDenominator();
+		int128 r = points[i]->y.getNumerator(), s = points[i]->y.getDenominator();
+		rows[i][0] = p * q * s * s;
+		rows[i][1] = r * s * q * q;
+		rows[i][2] = p * p * s * s + r * r * q * q;
+		rows[i][3] = q * q * s * s;
+	}
+
+	//The pairs of columns, and the sign of the pair (and its complement).
+	static const int PAIRS[6][4] = { { 0, 1, 2, 3 }, { 0, 2, 1, 3 }, { 0, 3, 1, 2 },
+		{ 1, 2, 0, 3 }, { 1, 3, 0, 2 }, { 2, 3, 0, 1 } };
+	static const int SIGNS[6] = { 1, -1, 1, 1, -1, 1 };
+
+	WideInteger determinant(0);
+	for (int i = 0; i < 6; ++i) {
+		const int* columns = PAIRS[i];
+		WideInteger term = minor(rows[0][columns[0]], rows[0][columns[1]], rows[1][columns[0]], rows[1][columns[1]]) *
+			minor(rows[2][columns[2]], rows[2][columns[3]], rows[3][columns[2]], rows[3][columns[3]]);
+		determinant = (SIGNS[i] > 0) ? determinant + term : determinant - term;
+	}
+	return determinant.sign();
+}
+
+
+//(ax-cx)*(by-cy) - (ay-cy)*(bx-cx), with the exact fallback.
+int orientation(const FractionPoint& a, const FractionPoint& b, const FractionPoint& c) {
+	double ax = toDouble(a.x), ay = toDouble(a.y);
+	double bx = toDouble(b.x), by = toDouble(b.y);
+	double cx = toDouble(c.x), cy = toDouble(c.y);
+
+	double determinant = (ax - cx) * (by - cy) - (ay - cy) * (bx - cx);
+	double permanent = (std::fabs(ax) + std::fabs(cx)) * (std::fabs(by) + std::fabs(cy)) +
+		(std::fabs(ay) + std::fabs(cy)) * (std::fabs(bx) + std::fabs(cx));
+
+	if (std::fabs(determinant) > ORIENTATION_ERROR * permanent)
+		return sign(determinant);
+	return exactOrientation(a, b, c);
+}
+
+
+/***
+*int inCircle() - Returns the side of the circle through a, b and c of d
+*
+*Purpose:
+*       Translates d to the origin, which turns the 4x4 determinant into
+*
+*           | adx  ady  adx^2+ady^2 |
+*           | bdx  bdy  bdx^2+bdy^2 |      (adx = ax-dx, and so on)
+*           | cdx  cdy  cdx^2+cdy^2 |
+*
+*       and computes it with 'double's, by its third column. Its permanent
+*       has the magnitudes of the coordinates (|ax|+|dx| for adx, and so on)
+*       in place of the differences. If the determinant isn't further from 0
+*       than INCIRCLE_ERROR times the permanent, it's computed exactly.
+*
+*Entry:
+*       const FractionPoint& a, b, c, d - The points.
+*
+*Exit:
+*       int - The sign of the determinant.
+*
+*Exceptions:
+*
+*******************************************************************************/
+int inCircle(const FractionPoint& a, const FractionPoint& b, const FractionPoint& c, const FractionPoint& d) {
+	double ax = toDouble(a.x), ay = toDouble(a.y);
+	double bx = toDouble(b.x), by = toDouble(b.y);
+	double cx = toDouble(c.x), cy = toDouble(c.y);
+	double dx = toDouble(d.x), dy = toDouble(d.y);
+
+	double adx = ax - dx, ady = ay - dy;
+	double bdx = bx - dx, bdy = by - dy;
+	double cdx = cx - dx, cdy = cy - dy;
+
+	double determinant = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) +
+		(bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+		(cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+
+	double adx_magnitude = std::fabs(ax) + std::fabs(dx), ady_magnitude = std::fabs(ay) + std::fabs(dy);
+	double bdx_magnitude = std::fabs(bx) + std::fabs(dx), bdy_magnitude = std::fabs(by) + std::fabs(dy);
+	double cdx_magnitude = std::fabs(cx) + std::fabs(dx), cdy_magnitude = std::fabs(cy) + std::fabs(dy);
+
+	double permanent = (adx_magnitude * adx_magnitude + ady_magnitude * ady_magnitude) *
+			(bdx_magnitude * cdy_magnitude + cdx_magnitude * bdy_magnitude) +
+		(bdx_magnitude * bdx_magnitude + bdy_magnitude * bdy_magnitude) *
+			(cdx_magnitude * ady_magnitude + adx_magnitude * cdy_magnitude) +
+		(cdx_magnitude * cdx_magnitude + cdy_magnitude * cdy_magnitude) *
+			(adx_magnitude * bdy_magnitude + bdx_magnitude * ady_magnitude);
+
+	if (std::fabs(determinant) > INCIRCLE_ERROR * permanent)
+		return sign(determinant);
+	return exactInCircle(a, b, c, d);
+}
+
+
+//Returns 'true' if lhs <= rhs, by cross-multiplying in 64 bits (the
+//denominators are positive).
+static bool lessOrEqual(const Fraction& lhs, const Fraction& rhs) {
+	return (long long)lhs.getNumerator() * rhs.getDenominator() <=
+		(long long)rhs.getNumerator() * lhs.getDenominator();
+}
+
+
+//Returns 'true' if 'point', which is collinear with the segment end1-end2, is
+//on it - i.e. in its bounding box.
+static bool onSegment(const FractionPoint& end1, const FractionPoint& end2, const FractionPoint& point) {
+	bool x_inside = lessOrEqual(end1.x, end2.x) ?
+		(lessOrEqual(end1.x, point.x) && lessOrEqual(point.x, end2.x)) :
+		(lessOrEqual(end2.x, point.x) && lessOrEqual(point.x, end1.x));
+	bool y_inside = lessOrEqual(end1.y, end2.y) ?
+		(lessOrEqual(end1.y, point.y) && lessOrEqual(point.y, end2.y)) :
+		(lessOrEqual(end2.y, point.y) && lessOrEqual(point.y, end1.y));
+	return x_inside && y_inside;
+}
+
+
+//The segments cross iff each one's ends are on different sides of the other's
+//line. Otherwise, they meet only where an end is on the other segment.
+bool segmentsIntersect(const FractionPoint& p1, const FractionPoint& p2,
+	const FractionPoint& q1, const FractionPoint& q2)
+{
+	int p_q1 = orientation(p1, p2, q1), p_q2 = orientation(p1, p2, q2);
+	int q_p1 = orientation(q1, q2, p1), q_p2 = orientation(q1, q2, p2);
+
+	if (p_q1 * p_q2 < 0 && q_p1 * q_p2 < 0)
+		return true;
+
+	return (0 == p_q1 && onSegment(p1, p2, q1)) || (0 == p_q2 && onSegment(p1, p2, q2)) ||
+		(0 == q_p1 && onSegment(q1, q2, p1)) || (0 == q_p2 && onSegment(q1, q2, p2));
+}
+
+} //namespace fraction {
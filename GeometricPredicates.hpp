@@ -0,0 +1,81 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the exact geometric predicates over
+* points with Fraction coordinates
+*/
+
+
+#ifndef GEOMETRICPREDICATES_HPP_
+#define GEOMETRICPREDICATES_HPP_
+
+#include "Fraction.hpp"
+
+
+namespace fraction {
+
+
+//A point in the plane with rational coordinates.
+struct FractionPoint {
+	Fraction x;
+	Fraction y;
+};
+
+
+/*
+These functions are the basic predicates of computational geometry over points
+with Fraction coordinates, and their results are always exact - even for
+collinear or cocircular points, where rounding would decide the answer at
+random.
+
+A predicate is the sign of a determinant in the coordinates. Computing it with
+Fraction's operators costs a gcd per operation, and overflows on all but small
+coordinates. Instead, it's first computed with 'double's (the coordinates are
+converted with a single rounding each), along with a bound on all the rounding
+errors (of the conversions too) that's proportional to the magnitudes of the
+coordinates - if the determinant is further from 0 than the bound, its sign
+is certain. That's the case for all but nearly degenerate inputs, which cost a
+few floating-point operations.
+
+Only when the sign is uncertain, the determinant is computed exactly: the rows
+of the matrix are multiplied by the (positive) denominators of their
+coordinates, which turns it into an integer matrix with the same sign of
+determinant, and that's evaluated with fixed-width integers wide enough for any
+'int' coordinates (up to 512 bits, for inCircle()). No gcd is computed, and
+nothing can overflow.
+*/
+
+
+/*
+Returns 1 if a, b and c are in counterclockwise order, -1 if they're in
+clockwise order, and 0 if they're collinear - the sign of
+
+    | ax  ay  1 |
+    | bx  by  1 |
+    | cx  cy  1 |
+*/
+int orientation(const FractionPoint& a, const FractionPoint& b, const FractionPoint& c);
+
+/*
+Returns 1 if d is inside the circle through a, b and c, -1 if it's outside, and
+0 if it's on the circle - when a, b and c are in counterclockwise order (the
+sign is the opposite when they're clockwise, and if they're collinear it's the
+side of the line). It's the sign of
+
+    | ax  ay  ax^2+ay^2  1 |
+    | bx  by  bx^2+by^2  1 |
+    | cx  cy  cx^2+cy^2  1 |
+    | dx  dy  dx^2+dy^2  1 |
+*/
+int inCircle(const FractionPoint& a, const FractionPoint& b, const FractionPoint& c, const FractionPoint& d);
+
+//Returns 'true' if the closed segments p1-p2 and q1-q2 have a common point
+//(including an endpoint touching the other segment, and collinear overlaps).
+bool segmentsIntersect(const FractionPoint& p1, const FractionPoint& p2,
+	const FractionPoint& q1, const FractionPoint& q2);
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,138 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of the geometric predicates of
+* GeometricPredicates.hpp.
+*
+* It runs orientation() and inCircle() over random points, and over cocircular
+* points - where inCircle()'s floating-point filter can't decide and the exact
+* evaluation runs - and computes the same determinants
+* with Fraction's operators (with the overflow protection), and prints the time
+* per predicate of each, and how many Fraction determinants overflowed.
+*/
+
+#include "Benchmark.hpp"
+#include "GeometricPredicates.hpp"
+#include "NumericException.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdlib> //for std::exit
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of predicates of every kind.
+static const std::size_t PREDICATES = 1 << 18;
+
+
+//Returns the sign of 'frac'.
+static int sign(const fraction::Fraction& frac) {
+	return (frac.getNumerator() > 0) - (frac.getNumerator() < 0);
+}
+
+
+//The orientation determinant with Fraction's operators.
+static int fractionOrientation(const fraction::FractionPoint& a, const fraction::FractionPoint& b,
+	const fraction::FractionPoint& c)
+{
+	return sign((a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x));
+}
+
+
+//The in-circle determinant with Fraction's operators.
+static int fractionInCircle(const fraction::FractionPoint& a, const fraction::FractionPoint& b,
+	const fraction::FractionPoint& c, const fraction::FractionPoint& d)
+{
+	fraction::Fraction adx = a.x - d.x, ady = a.y - d.y;
+	fraction::Fraction bdx = b.x - d.x, bdy = b.y - d.y;
+	fraction::Fraction cdx = c.x - d.x, cdy = c.y - d.y;
+
+	return sign((adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy) +
+		(cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady));
+}
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> numerator_distribution(-10000, 10000);
+	std::uniform_int_distribution<int> denominator_distribution(1, 100);
+	std::uniform_int_distribution<int> parameter_distribution(1, 30);
+
+	//Random points, and cocircular points - rational points
+	//((u^2-t^2)/(u^2+t^2), 2tu/(u^2+t^2)) of unit circles around random
+	//centers.
+	std::vector<fraction::FractionPoint> random_points, degenerate_points;
+	for (std::size_t i = 0; i < 4 * PREDICATES; ++i) {
+		fraction::FractionPoint point = {
+			fraction::Fraction(numerator_distribution(generator), denominator_distribution(generator), true),
+			fraction::Fraction(numerator_distribution(generator), denominator_distribution(generator), true) };
+		random_points.push_back(point);
+	}
+	for (std::size_t i = 0; i < PREDICATES; ++i) {
+		fraction::Fraction center_x(numerator_distribution(generator), denominator_distribution(generator), true);
+		fraction::Fraction center_y(numerator_distribution(generator), denominator_distribution(generator), true);
+		for (int j = 0; j < 4; ++j) {
+			int t = parameter_distribution(generator), u = parameter_distribution(generator);
+			fraction::FractionPoint point = { center_x + fraction::Fraction(u * u - t * t, t * t + u * u),
+				center_y + fraction::Fraction(2 * t * u, t * t + u * u) };
+			degenerate_points.push_back(point);
+		}
+	}
+
+	const std::vector<fraction::FractionPoint>* inputs[2] = { &random_points, &degenerate_points };
+	const char* names[2] = { "random points", "cocircular points" };
+
+	for (int input = 0; input < 2; ++input) {
+		const std::vector<fraction::FractionPoint>& points = *inputs[input];
+		std::vector<int> orientations(PREDICATES), in_circles(PREDICATES);
+
+		double orientation_time = Benchmark::measure(PREDICATES, [&]() {
+			for (std::size_t i = 0; i < PREDICATES; ++i)
+				orientations[i] = fraction::orientation(points[4 * i], points[4 * i + 1], points[4 * i + 2]);
+		});
+		double in_circle_time = Benchmark::measure(PREDICATES, [&]() {
+			for (std::size_t i = 0; i < PREDICATES; ++i)
+				in_circles[i] = fraction::inCircle(points[4 * i], points[4 * i + 1], points[4 * i + 2], points[4 * i + 3]);
+		});
+
+		std::size_t orientation_overflows = 0, in_circle_overflows = 0;
+		double fraction_orientation_time = Benchmark::measure(PREDICATES, [&]() {
+			for (std::size_t i = 0; i < PREDICATES; ++i) {
+				try {
+					if (fractionOrientation(points[4 * i], points[4 * i + 1], points[4 * i + 2]) != orientations[i]) {
+						std::cout << "orientations differ!" << std::endl;
+						std::exit(1);
+					}
+				}
+				catch (NumericException&) {
+					++orientation_overflows;
+				}
+			}
+		});
+		double fraction_in_circle_time = Benchmark::measure(PREDICATES, [&]() {
+			for (std::size_t i = 0; i < PREDICATES; ++i) {
+				try {
+					if (fractionInCircle(points[4 * i], points[4 * i + 1], points[4 * i + 2], points[4 * i + 3]) !=
+						in_circles[i])
+					{
+						std::cout << "in-circle tests differ!" << std::endl;
+						std::exit(1);
+					}
+				}
+				catch (NumericException&) {
+					++in_circle_overflows;
+				}
+			}
+		});
+
+		std::cout << names[input] << ":" << std::endl;
+		std::cout << "\torientation " << orientation_time << " ns/predicate, with Fraction " << fraction_orientation_time
+			<< " ns/predicate (" << orientation_overflows << " of " << PREDICATES << " overflowed)" << std::endl;
+		std::cout << "\tinCircle " << in_circle_time << " ns/predicate, with Fraction " << fraction_in_circle_time
+			<< " ns/predicate (" << in_circle_overflows << " of " << PREDICATES << " overflowed)" << std::endl;
+	}
+
+	return 0;
+}
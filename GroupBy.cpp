@@ -0,0 +1,347 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the group-by aggregation over FractionColumns
+*/
+
+
+#include "GroupBy.hpp"
+#include "FractionAccumulator.hpp"
+#include "Parallel.hpp"
+#include <algorithm> //for std::min, std::max, std::sort
+#include <cstdint> //for std::uint64_t
+#include <stdexcept> //for std::invalid_argument
+
+
+namespace fraction {
+
+
+//The minimal number of rows in a chunk that's aggregated by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 14;
+
+//The initial number of slots of a table (a power of 2).
+static const std::size_t MIN_TABLE_BITS = 4;
+
+
+//The aggregates of a group while it's being built. A slot whose sum has a
+//count of 0 is empty.
+struct GroupSlot {
+	std::uint64_t key;
+	FractionAccumulator sum;
+	int min_numerator;
+	int min_denominator;
+	int max_numerator;
+	int max_denominator;
+};
+
+
+//Mixes the bits of a key (with the finalizer of SplitMix64), so that both the
+//low bits (the partition) and the high bits (the slot) of the hash depend on
+//all of the key.
+static std::uint64_t hashKey(std::uint64_t key) {
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+	return key;
+}
+
+
+//n1/d1 < n2/d2, by cross-multiplying in 64 bits (the denominators are
+//positive).
+static bool lessThan(long long n1, long long d1, long long n2, long long d2) {
+	return n1 * d2 < n2 * d1;
+}
+
+
+/*
+A flat hash table of groups: an array of slots (a power of 2 of them) with
+linear probing, which is kept at most half full. The slot of a key is taken
+from the high bits of its hash.
+*/
+class GroupTable
+{
+public:
+	//-- constructors/destructor --//
+
+	//Creates an empty table.
+	GroupTable() :
+		m_slots((std::size_t)1 << MIN_TABLE_BITS),
+		m_size(0),
+		m_shift(64 - (int)MIN_TABLE_BITS)
+	{
+	}
+
+
+	//-- public methods --//
+
+	//Adds numerator/denominator to the group of 'key'.
+	void add(std::uint64_t key, std::uint64_t hash, int numerator, int denominator) {
+		GroupSlot& slot = this->find(key, hash);
+
+		if (0 == slot.sum.getCount()) {
+			slot.min_numerator = slot.max_numerator = numerator;
+			slot.min_denominator = slot.max_denominator = denominator;
+		}
+		else if (lessThan(numerator, denominator, slot.min_numerator, slot.min_denominator)) {
+			slot.min_numerator = numerator;
+			slot.min_denominator = denominator;
+		}
+		else if (lessThan(slot.max_numerator, slot.max_denominator, numerator, denominator)) {
+			slot.max_numerator = numerator;
+			slot.max_denominator = denominator;
+		}
+
+		slot.sum.add(numerator, denominator);
+	}
+
+	//Adds the aggregates of 'other' (of another table) to its group.
+	void merge(const GroupSlot& other) {
+		GroupSlot& slot = this->find(other.key, hashKey(other.key));
+
+		if (0 == slot.sum.getCount()) {
+			slot = other;
+			return;
+		}
+
+		if (lessThan(other.min_numerator, other.min_denominator, slot.min_numerator, slot.min_denominator)) {
+			slot.min_numerator = other.min_numerator;
+			slot.min_denominator = other.min_denominator;
+		}
+		if (lessThan(slot.max_numerator, slot.max_denominator, other.max_numerator, other.max_denominator)) {
+			slot.max_numerator = other.max_numerator;
+			slot.max_denominator = other.max_denominator;
+		}
+
+		slot.sum.merge(other.sum);
+	}
+
+	//Returns the slots (the empty ones included).
+	const std::vector<GroupSlot>& slots() const {
+		return this->m_slots;
+	}
+
+	//Returns the number of groups.
+	std::size_t size() const {
+		return this->m_size;
+	}
+
+private:
+	//-- private data members --//
+
+	//The slots
+	std::vector<GroupSlot> m_slots;
+
+	//The number of groups
+	std::size_t m_size;
+
+	//64 minus the bit length of the number of slots
+	int m_shift;
+
+
+	//-- private methods --//
+
+	/*
+	Returns the slot of 'key'. If it isn't in the table, it's given an empty
+	slot (which the caller fills right away), and the table is grown first if
+	it would become more than half full.
+	*/
+	GroupSlot& find(std::uint64_t key, std::uint64_t hash) {
+		std::size_t mask = this->m_slots.size() - 1;
+		std::size_t index = (std::size_t)(hash >> this->m_shift);
+
+		while (true) {
+			GroupSlot& slot = this->m_slots[index];
+
+			if (0 == slot.sum.getCount()) {
+				if (2 * (this->m_size + 1) > this->m_slots.size()) {
+					this->grow();
+					return this->find(key, hash);
+				}
+
+				slot.key = key;
+				++this->m_size;
+				return slot;
+			}
+
+			if (slot.key == key)
+				return slot;
+
+			index = (index + 1) & mask;
+		}
+	}
+
+	//Doubles the number of slots, and moves the groups to their new slots.
+	void grow() {
+		std::vector<GroupSlot> old_slots(this->m_slots.size() * 2);
+		old_slots.swap(this->m_slots);
+		--this->m_shift;
+
+		std::size_t mask = this->m_slots.size() - 1;
+		for (std::size_t i = 0; i < old_slots.size(); ++i) {
+			if (0 == old_slots[i].sum.getCount())
+				continue;
+
+			std::size_t index = (std::size_t)(hashKey(old_slots[i].key) >> this->m_shift);
+			while (0 != this->m_slots[index].sum.getCount())
+				index = (index + 1) & mask;
+			this->m_slots[index] = old_slots[i];
+		}
+	}
+
+}; //class GroupTable {
+
+
+/***
+*std::vector<GroupSlot> aggregate() - Aggregates the rows by their packed keys
+*
+*Purpose:
+*       The rows are split into chunks (a few per thread, as long as the
+*       chunks aren't too small), and the rows of every chunk are split by the
+*       low bits of the hashes of their keys into 'partitions' tables of the
+*       chunk. Then the tables of every partition (in all the chunks) are
+*       merged into the table of the partition in the first chunk, in
+*       parallel - the partitions have disjoint keys, so no group is merged by
+*       two threads.
+*
+*       With a single chunk there's a single partition, and nothing to merge.
+*
+*Entry:
+*       std::size_t                count - The number of rows.
+*       KeyAt                      keyAt - Called as keyAt(i), and returns the
+*                                          key of row i as an std::uint64_t.
+*       const FractionColumns&    values - The values.
+*       unsigned                 threads - The number of threads.
+*
+*Exit:
+*       std::vector<GroupSlot> - The groups, in no particular order.
+*
+*Exceptions:
+*       DivisionByZeroException() - If a denominator is 0.
+*       NumericOverflowException() - If the sum of a group doesn't fit in 128
+*                                    bits.
+*
+*******************************************************************************/
+template <typename KeyAt>
+static std::vector<GroupSlot> aggregate(std::size_t count, KeyAt keyAt, const FractionColumns& values,
+	unsigned threads)
+{
+	const int* numerators = values.numerators();
+	const int* denominators = values.denominators();
+
+	unsigned thread_count = Parallel::threadCount(threads);
+	std::size_t chunks = (1 == thread_count) ? 1 : std::max<std::size_t>(1,
+		std::min<std::size_t>(thread_count * 4, count / MIN_CHUNK_SIZE));
+
+	std::size_t partitions = 1;
+	while (chunks > 1 && partitions < thread_count)
+		partitions *= 2;
+
+	std::vector<GroupTable> tables(chunks * partitions);
+
+	Parallel::forEach(chunks, threads, [&](std::size_t chunk) {
+		GroupTable* chunk_tables = &tables[chunk * partitions];
+		std::size_t end = count * (chunk + 1) / chunks;
+
+		for (std::size_t i = count * chunk / chunks; i < end; ++i) {
+			std::uint64_t key = keyAt(i);
+			std::uint64_t hash = hashKey(key);
+			chunk_tables[hash & (partitions - 1)].add(key, hash, numerators[i], denominators[i]);
+		}
+	});
+
+	Parallel::forEach(partitions, threads, [&](std::size_t partition) {
+		GroupTable& target = tables[partition];
+
+		for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+			const std::vector<GroupSlot>& slots = tables[chunk * partitions + partition].slots();
+			for (std::size_t i = 0; i < slots.size(); ++i) {
+				if (0 != slots[i].sum.getCount())
+					target.merge(slots[i]);
+			}
+		}
+	});
+
+	std::vector<GroupSlot> groups;
+	for (std::size_t partition = 0; partition < partitions; ++partition) {
+		const std::vector<GroupSlot>& slots = tables[partition].slots();
+		for (std::size_t i = 0; i < slots.size(); ++i) {
+			if (0 != slots[i].sum.getCount())
+				groups.push_back(slots[i]);
+		}
+	}
+
+	return groups;
+}
+
+
+//Fills the aggregates of 'group' (all but the key).
+template <typename Key>
+static void fillAggregate(GroupSlot& group, GroupAggregate<Key>& result) {
+	group.sum.reduce();
+
+	result.count = group.sum.getCount();
+	result.sum.numerator = group.sum.getNumerator();
+	result.sum.denominator = group.sum.getDenominator();
+	result.min = Fraction(group.min_numerator, group.min_denominator);
+	result.max = Fraction(group.max_numerator, group.max_denominator);
+}
+
+
+//The keys are reinterpreted as unsigned.
+std::vector<GroupAggregate<long long> > groupBy(const std::vector<long long>& keys, const FractionColumns& values,
+	unsigned threads)
+{
+	if (keys.size() != values.size())
+		throw std::invalid_argument("groupBy(): The keys and the values don't have the same size");
+
+	const long long* key_data = keys.data();
+	std::vector<GroupSlot> groups = aggregate(keys.size(), [key_data](std::size_t i) {
+		return (std::uint64_t)key_data[i];
+	}, values, threads);
+
+	std::vector<GroupAggregate<long long> > results(groups.size());
+	for (std::size_t i = 0; i < groups.size(); ++i) {
+		results[i].key = (long long)groups[i].key;
+		fillAggregate(groups[i], results[i]);
+	}
+
+	std::sort(results.begin(), results.end(),
+		[](const GroupAggregate<long long>& lhs, const GroupAggregate<long long>& rhs) {
+			return lhs.key < rhs.key;
+		});
+	return results;
+}
+
+
+//A (reduced) fraction key is packed into 64 bits - its numerator in the high
+//half and its denominator in the low half - so equal keys have equal packings.
+std::vector<GroupAggregate<Fraction> > groupBy(const FractionColumns& keys, const FractionColumns& values,
+	unsigned threads)
+{
+	if (keys.size() != values.size())
+		throw std::invalid_argument("groupBy(): The keys and the values don't have the same size");
+
+	const int* key_numerators = keys.numerators();
+	const int* key_denominators = keys.denominators();
+	std::vector<GroupSlot> groups = aggregate(keys.size(), [key_numerators, key_denominators](std::size_t i) {
+		return ((std::uint64_t)(unsigned)key_numerators[i] << 32) | (unsigned)key_denominators[i];
+	}, values, threads);
+
+	std::sort(groups.begin(), groups.end(), [](const GroupSlot& lhs, const GroupSlot& rhs) {
+		return lessThan((int)(lhs.key >> 32), (int)(unsigned)lhs.key, (int)(rhs.key >> 32), (int)(unsigned)rhs.key);
+	});
+
+	std::vector<GroupAggregate<Fraction> > results(groups.size());
+	for (std::size_t i = 0; i < groups.size(); ++i) {
+		results[i].key = Fraction((int)(groups[i].key >> 32), (int)(unsigned)groups[i].key);
+		fillAggregate(groups[i], results[i]);
+	}
+
+	return results;
+}
+
+} //namespace fraction {
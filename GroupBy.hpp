@@ -0,0 +1,78 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declarations of the group-by aggregation over
+* FractionColumns
+*/
+
+
+#ifndef GROUPBY_HPP_
+#define GROUPBY_HPP_
+
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include "WideArithmetics.hpp"
+#include "WideFraction.hpp"
+#include <cstddef> //for std::size_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+The aggregates of the values of one group - the rows that share a key.
+*/
+template <typename Key>
+struct GroupAggregate {
+	Key key;
+	std::size_t count;
+	WideFraction sum;
+	Fraction min;
+	Fraction max;
+
+	//Returns sum/count.
+	WideFraction mean() const {
+		return this->sum * WideFraction::reduced(1, (WideArithmetics::int128)this->count);
+	}
+};
+
+
+/*
+These functions group the rows of 'values' by their keys (keys[i] is the key of
+values[i]), and return the count, sum, minimum and maximum (and so the mean)
+of the values of every group - sorted by the key.
+
+The groups are kept in flat hash tables (open addressing, with the aggregates
+stored in the table itself), so adding a row is a hash and a probe of a
+contiguous array - no allocation per group, and no pointer chasing. The sum of
+every group is a FractionAccumulator, which is reduced only when it grows (so
+rows with the same denominator are just added).
+
+The aggregation is done in parallel on 'threads' threads (0 means the number of
+hardware threads): every chunk of rows is split into partitions by the hash of
+its keys, into tables of its own, and then the tables of every partition are
+merged on their own thread - so no table is shared between threads.
+
+The values are expected to be reduced, with positive denominators (see
+FractionColumns.hpp).
+
+If the keys and the values don't have the same size, they throw
+std::invalid_argument. If the sum of a group doesn't fit in 128 bits, they
+throw NumericOverflowException().
+*/
+
+
+//Groups by integer keys.
+std::vector<GroupAggregate<long long> > groupBy(const std::vector<long long>& keys, const FractionColumns& values,
+	unsigned threads = 0);
+
+//Groups by fraction keys (which are equal iff they're the same value).
+std::vector<GroupAggregate<Fraction> > groupBy(const FractionColumns& keys, const FractionColumns& values,
+	unsigned threads = 0);
+
+} //namespace fraction {
+
+#endif
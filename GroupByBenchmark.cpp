@@ -0,0 +1,83 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of groupBy() against aggregating into maps.
+*
+* It sums random payments in cents (as reduced fractions) by random account
+* numbers with groupBy(), and with an std::map and an std::unordered_map from
+* the account to a Fraction with operator+= (the usual way), checks that the
+* sums are the same, and prints the time of each.
+*/
+
+#include "Benchmark.hpp"
+#include "GroupBy.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+
+//The number of rows.
+static const std::size_t ROWS = 1 << 22;
+
+//The number of accounts.
+static const long long ACCOUNTS = 10000;
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<long long> account_distribution(1, ACCOUNTS);
+	std::uniform_int_distribution<int> cents_distribution(-100000, 100000);
+
+	std::vector<long long> accounts(ROWS);
+	fraction::FractionColumns payments;
+	payments.reserve(ROWS);
+	for (std::size_t i = 0; i < ROWS; ++i) {
+		accounts[i] = account_distribution(generator) * 7919;
+		payments.pushBack(fraction::Fraction(cents_distribution(generator), 100));
+	}
+
+	std::vector<fraction::GroupAggregate<long long> > groups;
+	double group_time = Benchmark::measure(ROWS, [&]() {
+		groups = fraction::groupBy(accounts, payments, 1);
+	});
+	double parallel_time = Benchmark::measure(ROWS, [&]() {
+		groups = fraction::groupBy(accounts, payments);
+	});
+
+	std::map<long long, fraction::Fraction> ordered;
+	double map_time = Benchmark::measure(ROWS, [&]() {
+		for (std::size_t i = 0; i < ROWS; ++i)
+			ordered[accounts[i]] += payments.at(i);
+	});
+
+	std::unordered_map<long long, fraction::Fraction> unordered;
+	double unordered_time = Benchmark::measure(ROWS, [&]() {
+		for (std::size_t i = 0; i < ROWS; ++i)
+			unordered[accounts[i]] += payments.at(i);
+	});
+
+	if (groups.size() != ordered.size()) {
+		std::cout << "groups differ!" << std::endl;
+		return 1;
+	}
+	std::size_t index = 0;
+	for (std::map<long long, fraction::Fraction>::const_iterator it = ordered.begin(); it != ordered.end(); ++it, ++index) {
+		if (groups[index].key != it->first || !(groups[index].sum.toFraction() == it->second) ||
+			!(unordered[it->first] == it->second))
+		{
+			std::cout << "sums differ!" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << groups.size() << " groups of " << ROWS << " rows" << std::endl;
+	std::cout << "groupBy " << group_time << " ns/row (" << parallel_time << " on all threads), std::map "
+		<< map_time << " ns/row, std::unordered_map " << unordered_time << " ns/row" << std::endl;
+
+	return 0;
+}
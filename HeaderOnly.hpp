@@ -0,0 +1,34 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the macros of the header-only build mode
+*/
+
+#ifndef HEADERONLY_HPP_
+#define HEADERONLY_HPP_
+
+
+/*
+If FRACTION_HEADER_ONLY is defined, the headers of the core of the library
+(Fraction, Utilities, NumericException and SmallValueTables) include their
+.cpp files, and the definitions there are marked 'inline'. That way every
+translation unit sees the bodies of the operators and helpers it calls, and
+the compiler can inline them without link-time optimization.
+
+Otherwise the .cpp files are compiled separately, as usual.
+
+FRACTION_INLINE marks the definitions of functions declared in a header, and
+FRACTION_STATIC marks the definitions of the helpers that are local to a .cpp
+file (which must not be 'static' once the file is included by a header).
+*/
+#ifdef FRACTION_HEADER_ONLY
+#define FRACTION_INLINE inline
+#define FRACTION_STATIC inline
+#else
+#define FRACTION_INLINE
+#define FRACTION_STATIC static
+#endif
+
+#endif
@@ -0,0 +1,486 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement all the methods of the MultiModular class.
+*/
+
+
+#include "MultiModular.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+#include "Parallel.hpp"
+#include "WideArithmetics.hpp"
+#include <algorithm> //for std::min, std::max, std::swap
+#include <climits> //for INT_MIN, INT_MAX
+#include <stdexcept> //for std::invalid_argument
+
+
+namespace fraction {
+
+
+//The largest primes below 2^62. The first RECONSTRUCTION_PRIMES of them are
+//the ones the result is recovered from, and the rest are the check primes.
+static const std::uint64_t PRIMES[] = {
+	0x3fffffffffffffc7ULL, 0x3fffffffffffffa9ULL, 0x3fffffffffffff8bULL, 0x3fffffffffffff71ULL,
+	0x3fffffffffffff67ULL, 0x3fffffffffffff59ULL, 0x3fffffffffffff55ULL, 0x3fffffffffffff3dULL
+};
+
+//The minimal number of values in a chunk that's computed by a single task.
+static const std::size_t MIN_CHUNK_SIZE = 1 << 14;
+
+
+//Returns the inverse of 'num' modulo 'modulus' (both co-prime, 0 < num < modulus).
+static std::uint64_t modularInverse(std::uint64_t num, std::uint64_t modulus) {
+	long long r0 = (long long)modulus, r1 = (long long)num;
+	long long t0 = 0, t1 = 1;
+
+	while (0 != r1) {
+		long long q = r0 / r1;
+		long long r = r0 - q * r1;
+		r0 = r1;
+		r1 = r;
+		long long t = t0 - q * t1;
+		t0 = t1;
+		t1 = t;
+	}
+
+	return (t0 < 0) ? (std::uint64_t)(t0 + (long long)modulus) : (std::uint64_t)t0;
+}
+
+
+/*
+The arithmetic modulo a single odd prime p < 2^62.
+
+The values are kept in Montgomery form (a value a is stored as a*2^64 mod p),
+so a multiplication is a 64x64->128 bit multiplication followed by two more
+multiplications and a shift, instead of a 128-bit division.
+*/
+struct Modulus {
+
+	//Computes the constants of the Montgomery form modulo 'prime'.
+	explicit Modulus(std::uint64_t prime) :
+		p(prime)
+	{
+		//Newton's iteration doubles the number of correct low bits of
+		//prime^-1 mod 2^64, starting from 3 (since prime*prime = 1 mod 8).
+		std::uint64_t inverse = prime;
+		for (int i = 0; i < 5; ++i)
+			inverse *= 2 - prime * inverse;
+		this->neg_inverse = 0 - inverse;
+
+		this->r2 = (std::uint64_t)(((unsigned __int128)0 - prime) % prime);
+	}
+
+	//Returns t*2^-64 mod p, for t < p*2^64.
+	std::uint64_t reduce(unsigned __int128 t) const {
+		std::uint64_t m = (std::uint64_t)t * this->neg_inverse;
+		std::uint64_t u = (std::uint64_t)((t + (unsigned __int128)m * this->p) >> 64);
+		return (u >= this->p) ? u - this->p : u;
+	}
+
+	std::uint64_t multiply(std::uint64_t a, std::uint64_t b) const {
+		return this->reduce((unsigned __int128)a * b);
+	}
+
+	std::uint64_t add(std::uint64_t a, std::uint64_t b) const {
+		std::uint64_t sum = a + b;
+		return (sum >= this->p) ? sum - this->p : sum;
+	}
+
+	std::uint64_t subtract(std::uint64_t a, std::uint64_t b) const {
+		return (a >= b) ? a - b : a + this->p - b;
+	}
+
+	//Returns 'num' in Montgomery form.
+	std::uint64_t fromInt(int num) const {
+		std::uint64_t residue = (num < 0) ? this->p - (std::uint64_t)(-(long long)num) : (std::uint64_t)num;
+		return this->multiply(residue, this->r2);
+	}
+
+	//Returns the residue that 'a' (in Montgomery form) represents.
+	std::uint64_t toResidue(std::uint64_t a) const {
+		return this->reduce(a);
+	}
+
+	//Returns the inverse of 'a' (non-zero, in Montgomery form) in Montgomery form.
+	std::uint64_t inverse(std::uint64_t a) const {
+		return this->multiply(modularInverse(this->toResidue(a), this->p), this->r2);
+	}
+
+	//The prime
+	std::uint64_t p;
+
+	//-p^-1 mod 2^64
+	std::uint64_t neg_inverse;
+
+	//2^128 mod p (converts a residue to Montgomery form)
+	std::uint64_t r2;
+};
+
+
+/***
+*MultiModular::MultiModular() - The constructor
+*
+*Purpose:
+*       Stores the number of threads, and clamps the number of check primes to
+*       [0, MAX_CHECK_PRIMES].
+*
+*Entry:
+*       unsigned       threads - The number of threads used (0 means the
+*                                number of hardware threads).
+*       int        checkPrimes - The number of primes the result is verified
+*                                with.
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+MultiModular::MultiModular(unsigned threads, int checkPrimes) :
+	m_threads(threads),
+	m_check_primes(std::min(std::max(checkPrimes, 0), (int)MAX_CHECK_PRIMES))
+{
+}
+
+
+/***
+*std::vector<std::uint64_t> MultiModular::runChunked() - Runs a kernel on parallel
+*                                                        chunks modulo every prime
+*
+*Purpose:
+*       Splits the 'count' values into chunks (one per thread, as long as the
+*       chunks aren't too small), and runs 'kernel' on every chunk modulo every
+*       prime as a separate task.
+*       Every task stores a partial result numerator/denominator (in Montgomery
+*       form), and the partial results of every prime are then combined - by
+*       multiplying them, or by adding them - into a single residue.
+*
+*Entry:
+*       std::size_t           count - The number of values.
+*       bool         multiplicative - 'true' if the partial results are
+*                                     multiplied, else they are added.
+*       Kernel               kernel - Called as kernel(modulus, begin, end,
+*                                     numerator, denominator).
+*
+*Exit:
+*       std::vector<std::uint64_t> - The residue of the result modulo every
+*                                    prime.
+*
+*Exceptions:
+*       DivisionByZeroException() - if a denominator is 0
+*
+*******************************************************************************/
+template <typename Kernel>
+std::vector<std::uint64_t> MultiModular::runChunked(std::size_t count, bool multiplicative,
+	Kernel kernel) const
+{
+	std::size_t primes = (std::size_t)this->getPrimeCount();
+	std::size_t chunks = std::max<std::size_t>(1,
+		std::min<std::size_t>(Parallel::threadCount(this->m_threads), count / MIN_CHUNK_SIZE));
+
+	std::vector<Modulus> moduli;
+	for (std::size_t i = 0; i < primes; ++i)
+		moduli.push_back(Modulus(PRIMES[i]));
+
+	std::vector<std::uint64_t> numerators(primes * chunks), denominators(primes * chunks);
+	Parallel::forEach(primes * chunks, this->m_threads, [&](std::size_t task) {
+		std::size_t chunk = task % chunks;
+		std::size_t begin = count * chunk / chunks;
+		std::size_t end = count * (chunk + 1) / chunks;
+		kernel(moduli[task / chunks], begin, end, numerators[task], denominators[task]);
+	});
+
+	std::vector<std::uint64_t> residues(primes);
+	for (std::size_t i = 0; i < primes; ++i) {
+		const Modulus& modulus = moduli[i];
+		std::uint64_t numerator = numerators[i * chunks];
+		std::uint64_t denominator = denominators[i * chunks];
+
+		for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+			std::uint64_t n = numerators[i * chunks + chunk];
+			std::uint64_t d = denominators[i * chunks + chunk];
+			numerator = multiplicative ? modulus.multiply(numerator, n) :
+				modulus.add(modulus.multiply(numerator, d), modulus.multiply(n, denominator));
+			denominator = modulus.multiply(denominator, d);
+		}
+
+		//Every denominator is smaller than the prime, so the product is 0
+		//only if one of them is 0.
+		if (0 == denominator)
+			throw DivisionByZeroException();
+
+		residues[i] = modulus.toResidue(modulus.multiply(numerator, modulus.inverse(denominator)));
+	}
+
+	return residues;
+}
+
+
+/***
+*Fraction MultiModular::sum() - Returns the sum of the fractions
+*
+*Purpose:
+*       Modulo every prime, the sum is kept as numerator/denominator, so no
+*       value has to be inverted until the end:
+*       N/D + n/d = (N*d + n*D) / (D*d).
+*
+*Entry:
+*       const FractionColumns& values - The fractions to sum.
+*
+*Exit:
+*       Fraction - The sum.
+*
+*Exceptions:
+*       DivisionByZeroException() - if a denominator is 0
+*       NumericOverflowException() - if the sum doesn't fit in a Fraction
+*
+*******************************************************************************/
+Fraction MultiModular::sum(const FractionColumns& values) const {
+	const int* nums = values.numerators();
+	const int* dens = values.denominators();
+
+	return this->reconstruct(this->runChunked(values.size(), false,
+		[nums, dens](const Modulus& modulus, std::size_t begin, std::size_t end,
+			std::uint64_t& numerator, std::uint64_t& denominator)
+	{
+		std::uint64_t sum_num = 0;
+		std::uint64_t sum_den = modulus.fromInt(1);
+
+		for (std::size_t i = begin; i < end; ++i) {
+			std::uint64_t n = modulus.fromInt(nums[i]);
+			std::uint64_t d = modulus.fromInt(dens[i]);
+			sum_num = modulus.add(modulus.multiply(sum_num, d), modulus.multiply(n, sum_den));
+			sum_den = modulus.multiply(sum_den, d);
+		}
+
+		numerator = sum_num;
+		denominator = sum_den;
+	}));
+}
+
+
+//Multiplies the numerators and the denominators separately.
+Fraction MultiModular::product(const FractionColumns& values) const {
+	const int* nums = values.numerators();
+	const int* dens = values.denominators();
+
+	return this->reconstruct(this->runChunked(values.size(), true,
+		[nums, dens](const Modulus& modulus, std::size_t begin, std::size_t end,
+			std::uint64_t& numerator, std::uint64_t& denominator)
+	{
+		std::uint64_t product_num = modulus.fromInt(1);
+		std::uint64_t product_den = modulus.fromInt(1);
+
+		for (std::size_t i = begin; i < end; ++i) {
+			product_num = modulus.multiply(product_num, modulus.fromInt(nums[i]));
+			product_den = modulus.multiply(product_den, modulus.fromInt(dens[i]));
+		}
+
+		numerator = product_num;
+		denominator = product_den;
+	}));
+}
+
+
+//The same as sum(), where every term is (lhs_n*rhs_n) / (lhs_d*rhs_d).
+Fraction MultiModular::dot(const FractionColumns& lhs, const FractionColumns& rhs) const {
+	if (lhs.size() != rhs.size())
+		throw std::invalid_argument("MultiModular::dot(): the columns have different sizes");
+
+	const int* lhs_nums = lhs.numerators();
+	const int* lhs_dens = lhs.denominators();
+	const int* rhs_nums = rhs.numerators();
+	const int* rhs_dens = rhs.denominators();
+
+	return this->reconstruct(this->runChunked(lhs.size(), false,
+		[=](const Modulus& modulus, std::size_t begin, std::size_t end,
+			std::uint64_t& numerator, std::uint64_t& denominator)
+	{
+		std::uint64_t sum_num = 0;
+		std::uint64_t sum_den = modulus.fromInt(1);
+
+		for (std::size_t i = begin; i < end; ++i) {
+			std::uint64_t n = modulus.multiply(modulus.fromInt(lhs_nums[i]), modulus.fromInt(rhs_nums[i]));
+			std::uint64_t d = modulus.multiply(modulus.fromInt(lhs_dens[i]), modulus.fromInt(rhs_dens[i]));
+			sum_num = modulus.add(modulus.multiply(sum_num, d), modulus.multiply(n, sum_den));
+			sum_den = modulus.multiply(sum_den, d);
+		}
+
+		numerator = sum_num;
+		denominator = sum_den;
+	}));
+}
+
+
+/***
+*Fraction MultiModular::determinant() - Returns the determinant of a matrix
+*
+*Purpose:
+*       Modulo every prime (as a separate parallel task):
+*       1. Converts the entries to residues. Instead of inverting every
+*          denominator, all of them are inverted at once (Montgomery's trick):
+*          the prefix products are inverted with a single inversion, and the
+*          inverse of every denominator is peeled off going backwards.
+*       2. Computes the determinant by Gaussian elimination. Modulo a prime
+*          every non-zero value is invertible, so the elimination is exact.
+*
+*Entry:
+*       const FractionColumns& matrix - The matrix, row after row.
+*       std::size_t             order - The number of rows (and columns).
+*
+*Exit:
+*       Fraction - The determinant (1 for a 0x0 matrix).
+*
+*Exceptions:
+*       std::invalid_argument - if 'matrix' doesn't have order*order fractions
+*       DivisionByZeroException() - if a denominator is 0
+*       NumericOverflowException() - if the determinant doesn't fit in a Fraction
+*
+*******************************************************************************/
+Fraction MultiModular::determinant(const FractionColumns& matrix, std::size_t order) const {
+	if (matrix.size() != order * order)
+		throw std::invalid_argument("MultiModular::determinant(): the matrix is not order x order");
+
+	const int* nums = matrix.numerators();
+	const int* dens = matrix.denominators();
+	std::size_t entries = matrix.size();
+
+	for (std::size_t i = 0; i < entries; ++i) {
+		if (0 == dens[i])
+			throw DivisionByZeroException();
+	}
+
+	std::size_t primes = (std::size_t)this->getPrimeCount();
+	std::vector<std::uint64_t> residues(primes);
+
+	Parallel::forEach(primes, this->m_threads, [&](std::size_t prime) {
+		Modulus modulus(PRIMES[prime]);
+
+		//prefix[i] is the product of the first i denominators.
+		std::vector<std::uint64_t> prefix(entries + 1);
+		prefix[0] = modulus.fromInt(1);
+		for (std::size_t i = 0; i < entries; ++i)
+			prefix[i + 1] = modulus.multiply(prefix[i], modulus.fromInt(dens[i]));
+
+		std::vector<std::uint64_t> values(entries);
+		std::uint64_t inverse = modulus.inverse(prefix[entries]);
+		for (std::size_t i = entries; i-- > 0; ) {
+			values[i] = modulus.multiply(modulus.fromInt(nums[i]), modulus.multiply(inverse, prefix[i]));
+			inverse = modulus.multiply(inverse, modulus.fromInt(dens[i]));
+		}
+
+		std::uint64_t result = modulus.fromInt(1);
+		for (std::size_t column = 0; column < order; ++column) {
+			std::size_t pivot = column;
+			while (pivot < order && 0 == values[pivot * order + column])
+				++pivot;
+
+			if (pivot == order) {
+				result = 0;
+				break;
+			}
+
+			if (pivot != column) {
+				for (std::size_t k = column; k < order; ++k)
+					std::swap(values[pivot * order + k], values[column * order + k]);
+				result = modulus.subtract(0, result);
+			}
+
+			const std::uint64_t* pivot_row = &values[column * order];
+			result = modulus.multiply(result, pivot_row[column]);
+			std::uint64_t pivot_inverse = modulus.inverse(pivot_row[column]);
+
+			for (std::size_t row = column + 1; row < order; ++row) {
+				std::uint64_t* current = &values[row * order];
+				if (0 == current[column])
+					continue;
+
+				std::uint64_t factor = modulus.multiply(current[column], pivot_inverse);
+				for (std::size_t k = column; k < order; ++k)
+					current[k] = modulus.subtract(current[k], modulus.multiply(factor, pivot_row[k]));
+			}
+		}
+
+		residues[prime] = modulus.toResidue(result);
+	});
+
+	return this->reconstruct(residues);
+}
+
+
+/***
+*Fraction MultiModular::reconstruct() - Recovers a fraction from its residues
+*
+*Purpose:
+*       1. Combines the residues modulo the first two primes p1, p2 into the
+*          residue x modulo M = p1*p2 (the Chinese remainder theorem).
+*       2. Finds n/d with |n| <= 2^31, 0 < d < 2^31 and n = x*d (mod M)
+*          (rational reconstruction): the extended Euclidean algorithm on
+*          (M, x) is stopped at the first remainder that's at most 2^31, which
+*          is n, and its coefficient of x is d (they must be co-prime).
+*          Since M > 2 * 2^31 * 2^31, there's at most one such fraction, so if
+*          the exact result fits in a Fraction, this is it.
+*       3. Verifies that n = residue*d modulo every check prime.
+*
+*Entry:
+*       const std::vector<std::uint64_t>& residues - The residue of the result
+*                                                   modulo every prime.
+*
+*Exit:
+*       Fraction - The result.
+*
+*Exceptions:
+*       NumericOverflowException() - if no fraction that fits in a Fraction
+*                                    matches the residues
+*
+*******************************************************************************/
+Fraction MultiModular::reconstruct(const std::vector<std::uint64_t>& residues) const {
+	typedef unsigned __int128 uint128;
+
+	std::uint64_t p1 = PRIMES[0], p2 = PRIMES[1];
+	std::uint64_t r1 = residues[0], r2 = residues[1];
+
+	//x = r1 + p1 * ((r2 - r1) * p1^-1 mod p2)
+	std::uint64_t difference = (r2 >= r1 % p2) ? r2 - r1 % p2 : r2 + p2 - r1 % p2;
+	std::uint64_t lift = (std::uint64_t)((uint128)difference * modularInverse(p1 % p2, p2) % p2);
+	uint128 modulus = (uint128)p1 * p2;
+	uint128 x = r1 + (uint128)p1 * lift;
+
+	const uint128 numerator_bound = (uint128)1 << 31;
+	uint128 rem0 = modulus, rem1 = x;
+	__int128 coef0 = 0, coef1 = 1;
+	while (rem1 > numerator_bound) {
+		uint128 q = rem0 / rem1;
+		uint128 rem = rem0 - q * rem1;
+		rem0 = rem1;
+		rem1 = rem;
+		__int128 coef = coef0 - (__int128)q * coef1;
+		coef0 = coef1;
+		coef1 = coef;
+	}
+
+	long long numerator = (long long)rem1;
+	__int128 denominator = coef1;
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	//A remainder and its coefficient with a common factor aren't a solution.
+	if (denominator > INT_MAX || numerator > INT_MAX || numerator < INT_MIN ||
+		1 != WideArithmetics::gcd(numerator, denominator))
+		throw NumericOverflowException();
+
+	for (std::size_t i = RECONSTRUCTION_PRIMES; i < residues.size(); ++i) {
+		std::uint64_t p = PRIMES[i];
+		std::uint64_t expected = (numerator < 0) ? p - (std::uint64_t)(-numerator) : (std::uint64_t)numerator;
+		if ((std::uint64_t)((uint128)residues[i] * (std::uint64_t)denominator % p) != expected)
+			throw NumericOverflowException();
+	}
+
+	return Fraction((int)numerator, (int)denominator);
+}
+
+} //namespace fraction {
@@ -0,0 +1,129 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the MultiModular class
+*/
+
+
+#ifndef MULTIMODULAR_HPP_
+#define MULTIMODULAR_HPP_
+
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class computes exact results of long computations over fractions (sums,
+products, dot products and determinants), whose intermediate numerators and
+denominators are far too large for an 'int' - or even for 128 bits - as long
+as the final result fits in a Fraction.
+
+Instead of computing over the rationals, the computation is done modulo a few
+62-bit primes, where every value is a single 64-bit residue and nothing can
+overflow. The computations modulo the different primes are independent, so
+they run in parallel. The result is then recovered from its residues with the
+Chinese remainder theorem and rational reconstruction.
+
+Two primes are enough to recover any Fraction. The residues modulo the other
+("check") primes are used to verify the recovered fraction: if it doesn't
+match them, the exact result doesn't fit in a Fraction (it needs more primes
+than a Fraction can be recovered from), and NumericOverflowException() is
+thrown. A result that doesn't fit in a Fraction is accepted by mistake only if
+it happens to match all the check primes, with a probability of about 2^-62
+per check prime.
+
+All the methods throw DivisionByZeroException() if a denominator is 0.
+*/
+class MultiModular
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	'threads' is the number of threads used (0 means the number of hardware
+	threads).
+	'checkPrimes' is the number of primes the result is verified with (clamped
+	to [0, MAX_CHECK_PRIMES]).
+	*/
+	explicit MultiModular(unsigned threads = 0, int checkPrimes = DEFAULT_CHECK_PRIMES);
+
+
+	//-- public methods --//
+
+	//Returns the sum of the fractions in 'values'.
+	Fraction sum(const FractionColumns& values) const;
+
+	//Returns the product of the fractions in 'values'.
+	Fraction product(const FractionColumns& values) const;
+
+	/*
+	Returns the sum of lhs[i]*rhs[i].
+	If the columns don't have the same size, it throws std::invalid_argument.
+	*/
+	Fraction dot(const FractionColumns& lhs, const FractionColumns& rhs) const;
+
+	/*
+	Returns the determinant of the order x order matrix stored in 'matrix' row
+	after row.
+	If 'matrix' doesn't have order*order fractions, it throws
+	std::invalid_argument.
+	*/
+	Fraction determinant(const FractionColumns& matrix, std::size_t order) const;
+
+	//Returns the number of primes the computations are done modulo.
+	int getPrimeCount() const {
+		return RECONSTRUCTION_PRIMES + this->m_check_primes;
+	}
+
+	//The default number of check primes.
+	static const int DEFAULT_CHECK_PRIMES = 1;
+
+	//The maximal number of check primes.
+	static const int MAX_CHECK_PRIMES = 6;
+
+private:
+	//-- private data members --//
+
+	//The number of primes the result is recovered from.
+	static const int RECONSTRUCTION_PRIMES = 2;
+
+	//The number of threads (0 means the number of hardware threads)
+	unsigned m_threads;
+
+	//The number of primes the result is verified with
+	int m_check_primes;
+
+
+	//-- private methods --//
+
+	/*
+	Recovers the fraction whose residues modulo the primes are 'residues', and
+	verifies it with the check primes.
+	*/
+	Fraction reconstruct(const std::vector<std::uint64_t>& residues) const;
+
+	/*
+	Runs 'kernel' - which computes the partial result of a range of values -
+	on parallel chunks of 'count' values modulo every prime, and returns the
+	residues of the combined results.
+	The partial results are fractions, which are combined by multiplying them if
+	'multiplicative' is 'true', and by adding them otherwise.
+	*/
+	template <typename Kernel>
+	std::vector<std::uint64_t> runChunked(std::size_t count, bool multiplicative, Kernel kernel) const;
+
+}; //class MultiModular {
+
+} //namespace fraction {
+
+#endif
@@ -6,6 +6,9 @@
 * In this we have the implementation of the NumericException's destructor
 */
 
+#ifndef NUMERICEXCEPTION_CPP_
+#define NUMERICEXCEPTION_CPP_
+
 #include "NumericException.hpp"
 
 
@@ -25,4 +28,6 @@
 *Exceptions:
 *
 *******************************************************************************/
-NumericException::~NumericException() { }
\ No newline at end of file
+FRACTION_INLINE NumericException::~NumericException() { }
+
+#endif
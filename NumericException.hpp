@@ -9,6 +9,7 @@
 #ifndef NUMERICEXCEPTION_HPP_
 #define NUMERICEXCEPTION_HPP_
 
+#include "HeaderOnly.hpp"
 #include <exception>
 #include <string>
 
@@ -38,4 +39,8 @@ protected:
 	std::string m_err_msg;
 };
 
-#endif
\ No newline at end of file
+#ifdef FRACTION_HEADER_ONLY
+#include "NumericException.cpp"
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration and implementation of the Parallel
+* namespace
+*/
+
+
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <atomic>
+#include <cstddef> //for std::size_t
+#include <exception> //for std::exception_ptr
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*
+This namespace holds the small thread helpers the bulk APIs of the library are
+built on.
+*/
+namespace Parallel {
+
+	//Returns 'requested' if it's not 0, else the number of hardware threads
+	//(at least 1).
+	inline unsigned threadCount(unsigned requested) {
+		if (0 != requested)
+			return requested;
+
+		unsigned hardware = std::thread::hardware_concurrency();
+		return (0 == hardware) ? 1 : hardware;
+	}
+
+	/*
+	Calls task(i) for every i in [0, count), on at most 'threads' threads
+	(0 means the number of hardware threads). The calling thread is one of them.
+
+	The tasks are handed out one at a time, so tasks of different lengths are
+	balanced between the threads.
+
+	If a task throws, the remaining tasks are skipped, and after all the
+	threads finished, the first exception is rethrown.
+	*/
+	template <typename Task>
+	void forEach(std::size_t count, unsigned threads, Task task) {
+		threads = threadCount(threads);
+		if (threads > count)
+			threads = (unsigned)count;
+
+		std::atomic<std::size_t> next(0);
+		std::exception_ptr error;
+		std::mutex error_lock;
+
+		auto worker = [&]() {
+			while (true) {
+				std::size_t index = next.fetch_add(1);
+				if (index >= count)
+					return;
+
+				try {
+					task(index);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> guard(error_lock);
+					if (!error)
+						error = std::current_exception();
+					next.store(count);
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+		for (unsigned i = 1; i < threads; ++i)
+			workers.push_back(std::thread(worker));
+		worker();
+		for (std::size_t i = 0; i < workers.size(); ++i)
+			workers[i].join();
+
+		if (error)
+			std::rethrow_exception(error);
+	}
+}
+
+#endif
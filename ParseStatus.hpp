@@ -0,0 +1,27 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the ParseStatus enum
+*/
+
+
+#ifndef PARSESTATUS_HPP_
+#define PARSESTATUS_HPP_
+
+
+namespace fraction {
+
+
+//The result of parsing a single fraction.
+enum class ParseStatus {
+	Ok,             //The fraction was parsed
+	Malformed,      //The text is not a fraction in the expected format
+	Overflow,       //The numerator or denominator doesn't fit in an 'int'
+	DivisionByZero  //The denominator is 0
+};
+
+} //namespace fraction {
+
+#endif
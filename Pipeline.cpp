@@ -0,0 +1,534 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the Pipeline class and the built-in stages.
+*/
+
+
+#include "Pipeline.hpp"
+#include "FractionKernels.hpp" //for filter()
+#include "FractionLoader.hpp" //for parseFraction()
+#include "SafeArithmetics.hpp" //for SafeArithmetics::maskWords()
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdint> //for std::uint64_t
+#include <cstring> //for std::memchr, std::memmove
+#include <exception> //for std::exception_ptr
+#include <memory> //for std::shared_ptr, std::unique_ptr
+#include <mutex>
+#include <stdexcept> //for std::invalid_argument
+#include <string>
+#include <system_error>
+#include <thread>
+#include <pthread.h> //for pthread_setaffinity_np()
+#include <sched.h> //for cpu_set_t
+
+
+namespace fraction {
+
+
+//The number of times a waiting thread spins before it starts yielding.
+static const unsigned SPIN_LIMIT = 256;
+
+//The size of the read buffer of parseStage().
+static const std::size_t READ_BUFFER_SIZE = 1 << 16;
+
+
+//The queue that connects two stages. A null batch marks the end of the
+//stream.
+typedef SpscQueue<FractionColumns*> BatchQueue;
+
+
+//The state the threads of a running pipeline share.
+struct PipelineState {
+
+	PipelineState() :
+		stop(false)
+	{
+	}
+
+	//Set when a stage threw, so the others stop
+	std::atomic<bool> stop;
+
+	//The first exception a stage threw
+	std::exception_ptr error;
+
+	//Guards 'error'
+	std::mutex error_lock;
+};
+
+
+//Waits a little before the next attempt of a full or empty queue: spins for
+//the first attempts, and then yields the CPU.
+static void backoff(unsigned& attempts) {
+	if (attempts < SPIN_LIMIT) {
+		++attempts;
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+	}
+	else {
+		std::this_thread::yield();
+	}
+}
+
+
+//Pushes 'batch' to 'queue', waiting while it's full.
+//Returns 'false' if the pipeline was stopped before that.
+static bool push(BatchQueue& queue, FractionColumns* batch, const PipelineState& state) {
+	unsigned attempts = 0;
+	while (!queue.tryPush(batch)) {
+		if (state.stop.load(std::memory_order_relaxed))
+			return false;
+		backoff(attempts);
+	}
+	return true;
+}
+
+
+//Pops a batch from 'queue' into 'batch', waiting while it's empty.
+//Returns 'false' if the pipeline was stopped before that.
+static bool pop(BatchQueue& queue, FractionColumns*& batch, const PipelineState& state) {
+	unsigned attempts = 0;
+	while (!queue.tryPop(batch)) {
+		if (state.stop.load(std::memory_order_relaxed))
+			return false;
+		backoff(attempts);
+	}
+	return true;
+}
+
+
+//Pins the calling thread to 'cpu' (unless it's Pipeline::ANY_CPU).
+//If it can't, it throws std::system_error.
+static void pinToCpu(int cpu) {
+	if (Pipeline::ANY_CPU == cpu)
+		return;
+
+#ifdef __linux__
+	if (cpu < 0 || cpu >= CPU_SETSIZE)
+		throw std::system_error(EINVAL, std::generic_category(), "CPU " + std::to_string(cpu));
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+
+	int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	if (0 != error)
+		throw std::system_error(error, std::generic_category(), "CPU " + std::to_string(cpu));
+#else
+	throw std::system_error(ENOTSUP, std::generic_category(), "CPU " + std::to_string(cpu));
+#endif
+}
+
+
+//Runs body() on the calling thread pinned to 'cpu'. If anything throws, the
+//exception is recorded (if it's the first one) and the pipeline is stopped.
+template <typename Body>
+static void runStage(int cpu, PipelineState& state, Body body) {
+	try {
+		pinToCpu(cpu);
+		body();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> guard(state.error_lock);
+		if (!state.error)
+			state.error = std::current_exception();
+		state.stop.store(true);
+	}
+}
+
+
+//The constructor.
+Pipeline::Pipeline(std::size_t batches) :
+	m_batches((0 == batches) ? 1 : batches),
+	m_source_cpu(ANY_CPU),
+	m_sink_cpu(ANY_CPU)
+{
+}
+
+
+//Setter for the source
+void Pipeline::setSource(Source source, int cpu) {
+	this->m_source = source;
+	this->m_source_cpu = cpu;
+}
+
+
+//Appends the stage.
+void Pipeline::addStage(Stage stage, int cpu) {
+	this->m_stages.push_back(stage);
+	this->m_stage_cpus.push_back(cpu);
+}
+
+
+//Setter for the sink
+void Pipeline::setSink(Sink sink, int cpu) {
+	this->m_sink = sink;
+	this->m_sink_cpu = cpu;
+}
+
+
+/***
+*void Pipeline::run() - Runs the pipeline
+*
+*Purpose:
+*       There's a queue before every stage and before the sink, and a queue of
+*       free batches from the sink back to the source, which starts with all
+*       the batches. Every queue can hold all the batches and the end marker,
+*       so a push never waits - only a pop does, which is how the backpressure
+*       works.
+*
+*       Every thread runs on its own:
+*       - The source pops a free batch, fills it, and pushes it to the first
+*         queue. At the end of the stream, it pushes the end marker.
+*       - Every stage pops a batch, transforms it, and pushes it to the next
+*         queue. The end marker is passed on, after which the stage returns.
+*       - The sink pops a batch, consumes it (unless it's empty), and pushes it
+*         back to the source.
+*
+*       Every thread checks the stop flag whenever it waits, and before every
+*       batch, so when a stage throws, all the threads return soon after.
+*
+*Entry:
+*
+*Exit:
+*
+*Exceptions:
+*       std::invalid_argument - If there's no source or no sink.
+*       std::system_error     - If a thread can't be created or pinned.
+*       Any exception thrown by a stage.
+*
+*******************************************************************************/
+void Pipeline::run() {
+	if (!this->m_source || !this->m_sink)
+		throw std::invalid_argument("Pipeline::run(): the pipeline has no source or no sink");
+
+	std::vector<FractionColumns> batches(this->m_batches);
+
+	std::vector<std::unique_ptr<BatchQueue>> queues;
+	for (std::size_t i = 0; i <= this->m_stages.size(); ++i)
+		queues.push_back(std::unique_ptr<BatchQueue>(new BatchQueue(this->m_batches + 1)));
+
+	BatchQueue free_batches(this->m_batches);
+	for (std::size_t i = 0; i < batches.size(); ++i)
+		free_batches.tryPush(&batches[i]);
+
+	PipelineState state;
+	std::vector<std::thread> threads;
+
+	try {
+		threads.push_back(std::thread([&]() {
+			runStage(this->m_source_cpu, state, [&]() {
+				BatchQueue& output = *queues.front();
+				FractionColumns* batch = nullptr;
+
+				while (!state.stop.load(std::memory_order_relaxed)) {
+					if (nullptr == batch && !pop(free_batches, batch, state))
+						return;
+
+					batch->clear();
+					bool more = this->m_source(*batch);
+
+					if (!batch->empty()) {
+						if (!push(output, batch, state))
+							return;
+						batch = nullptr;
+					}
+
+					if (!more) {
+						push(output, nullptr, state);
+						return;
+					}
+				}
+			});
+		}));
+
+		for (std::size_t i = 0; i < this->m_stages.size(); ++i) {
+			threads.push_back(std::thread([&, i]() {
+				runStage(this->m_stage_cpus[i], state, [&]() {
+					BatchQueue& input = *queues[i];
+					BatchQueue& output = *queues[i + 1];
+
+					while (!state.stop.load(std::memory_order_relaxed)) {
+						FractionColumns* batch;
+						if (!pop(input, batch, state))
+							return;
+
+						if (nullptr != batch)
+							this->m_stages[i](*batch);
+
+						if (!push(output, batch, state) || nullptr == batch)
+							return;
+					}
+				});
+			}));
+		}
+
+		threads.push_back(std::thread([&]() {
+			runStage(this->m_sink_cpu, state, [&]() {
+				BatchQueue& input = *queues.back();
+
+				while (!state.stop.load(std::memory_order_relaxed)) {
+					FractionColumns* batch;
+					if (!pop(input, batch, state) || nullptr == batch)
+						return;
+
+					if (!batch->empty())
+						this->m_sink(*batch);
+
+					if (!push(free_batches, batch, state))
+						return;
+				}
+			});
+		}));
+	}
+	catch (...) {
+		state.stop.store(true);
+		for (std::size_t i = 0; i < threads.size(); ++i)
+			threads[i].join();
+		throw;
+	}
+
+	for (std::size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+
+	if (state.error)
+		std::rethrow_exception(state.error);
+}
+
+
+//The state of parseStage(): the read buffer, with the part of it that wasn't
+//parsed yet in [begin, end).
+struct LineReader {
+
+	std::istream* input;
+	std::size_t batch_size;
+	std::size_t* malformed;
+
+	std::vector<char> buffer;
+	std::size_t begin;
+	std::size_t end;
+	bool eof;
+};
+
+
+//Parses the line [begin, end) (without the '\n') into 'batch'.
+static void parseLine(LineReader& reader, const char* begin, const char* end, FractionColumns& batch) {
+	if (begin != end && '\r' == end[-1])
+		--end;
+
+	int numerator, denominator;
+	if (ParseStatus::Ok == parseFraction(begin, end, numerator, denominator))
+		batch.pushBack(numerator, denominator);
+	else if (nullptr != reader.malformed)
+		++*reader.malformed;
+}
+
+
+/***
+*Pipeline::Source parseStage() - Returns a source that parses an istream
+*
+*Purpose:
+*       The input is read in blocks into a buffer, and the complete lines in
+*       the buffer are parsed in place (lines are found with memchr()). When no
+*       complete line is left, the incomplete one is moved to the beginning of
+*       the buffer, and the rest of the buffer is refilled - the buffer only
+*       grows for a line longer than it.
+*
+*       The state is shared by the copies of the returned function, since
+*       std::function copies it.
+*
+*Entry:
+*       std::istream&    input - The input.
+*       std::size_t  batchSize - The maximal number of fractions in a batch.
+*       std::size_t* malformed - Would hold the number of skipped lines (if
+*                                not null).
+*
+*Exit:
+*       Pipeline::Source - The source.
+*
+*Exceptions:
+*
+*******************************************************************************/
+Pipeline::Source parseStage(std::istream& input, std::size_t batchSize, std::size_t* malformed) {
+	std::shared_ptr<LineReader> reader = std::make_shared<LineReader>();
+	reader->input = &input;
+	reader->batch_size = (0 == batchSize) ? 1 : batchSize;
+	reader->malformed = malformed;
+	reader->buffer.resize(READ_BUFFER_SIZE);
+	reader->begin = reader->end = 0;
+	reader->eof = false;
+
+	if (nullptr != malformed)
+		*malformed = 0;
+
+	return [reader](FractionColumns& batch) {
+		LineReader& state = *reader;
+
+		while (batch.size() < state.batch_size) {
+			const char* data = state.buffer.data();
+			const char* newline = (const char*)std::memchr(data + state.begin, '\n', state.end - state.begin);
+
+			if (nullptr != newline) {
+				parseLine(state, data + state.begin, newline, batch);
+				state.begin = newline + 1 - data;
+				continue;
+			}
+
+			if (state.eof) {
+				if (state.begin != state.end)
+					parseLine(state, data + state.begin, data + state.end, batch);
+				state.begin = state.end;
+				return false;
+			}
+
+			std::memmove(state.buffer.data(), data + state.begin, state.end - state.begin);
+			state.end -= state.begin;
+			state.begin = 0;
+			if (state.end == state.buffer.size())
+				state.buffer.resize(state.buffer.size() * 2);
+
+			state.input->read(state.buffer.data() + state.end, state.buffer.size() - state.end);
+			state.end += (std::size_t)state.input->gcount();
+			if (!*state.input)
+				state.eof = true;
+		}
+
+		return true;
+	};
+}
+
+
+//Calls apply(x) on every fraction x of 'batch' (as a Fraction with overflow
+//protection), and stores the result back.
+template <typename Apply>
+static void applyToBatch(FractionColumns& batch, Apply apply) {
+	int* numerators = batch.numerators();
+	int* denominators = batch.denominators();
+
+	for (std::size_t i = 0; i < batch.size(); ++i) {
+		Fraction value(numerators[i], denominators[i], true);
+		apply(value);
+		numerators[i] = value.getNumerator();
+		denominators[i] = value.getDenominator();
+	}
+}
+
+
+//The operation is dispatched once per batch, not once per fraction.
+Pipeline::Stage arithmeticStage(Operation operation, const Fraction& operand) {
+	Fraction protected_operand(operand.getNumerator(), operand.getDenominator(), true);
+
+	return [operation, protected_operand](FractionColumns& batch) {
+		switch (operation) {
+		case Operation::Add:
+			applyToBatch(batch, [&](Fraction& value) { value += protected_operand; });
+			break;
+		case Operation::Subtract:
+			applyToBatch(batch, [&](Fraction& value) { value -= protected_operand; });
+			break;
+		case Operation::Multiply:
+			applyToBatch(batch, [&](Fraction& value) { value *= protected_operand; });
+			break;
+		case Operation::Divide:
+			applyToBatch(batch, [&](Fraction& value) { value /= protected_operand; });
+			break;
+		}
+	};
+}
+
+
+//Selects the fractions with filter() (on the stage's thread), and then moves
+//the selected ones to the front of the batch, in order.
+Pipeline::Stage filterStage(Comparison comparison, const Fraction& value) {
+	std::vector<std::uint64_t> mask;
+
+	return [comparison, value, mask](FractionColumns& batch) mutable {
+		mask.resize(SafeArithmetics::maskWords(batch.size()));
+		filter(batch, comparison, value, mask.data(), 1);
+
+		int* numerators = batch.numerators();
+		int* denominators = batch.denominators();
+		std::size_t selected = 0;
+
+		for (std::size_t word_index = 0; word_index < mask.size(); ++word_index) {
+			std::uint64_t word = mask[word_index];
+			while (0 != word) {
+				std::size_t i = word_index * 64 + __builtin_ctzll(word);
+				numerators[selected] = numerators[i];
+				denominators[selected] = denominators[i];
+				++selected;
+				word &= word - 1;
+			}
+		}
+
+		batch.resize(selected);
+	};
+}
+
+
+//Appends the decimal digits of 'number' to 'buffer'.
+static void appendInteger(std::string& buffer, int number) {
+	char digits[12];
+	char* end = digits + sizeof(digits);
+	char* begin = end;
+
+	//The magnitude is computed in 'unsigned', so INT_MIN doesn't overflow.
+	unsigned magnitude = (number < 0) ? 0u - (unsigned)number : (unsigned)number;
+	do {
+		*--begin = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (0 != magnitude);
+
+	if (number < 0)
+		*--begin = '-';
+
+	buffer.append(begin, end);
+}
+
+
+//Formats every batch like operator<< ("0" for 0, only the numerator for a
+//denominator of 1), into a buffer that's reused between the batches.
+Pipeline::Sink formatStage(std::ostream& output) {
+	std::ostream* stream = &output;
+	std::string buffer;
+
+	return [stream, buffer](const FractionColumns& batch) mutable {
+		const int* numerators = batch.numerators();
+		const int* denominators = batch.denominators();
+
+		buffer.clear();
+		for (std::size_t i = 0; i < batch.size(); ++i) {
+			if (0 == numerators[i]) {
+				buffer.push_back('0');
+			}
+			else {
+				appendInteger(buffer, numerators[i]);
+				if (1 != denominators[i]) {
+					buffer.push_back('/');
+					appendInteger(buffer, denominators[i]);
+				}
+			}
+			buffer.push_back('\n');
+		}
+
+		stream->write(buffer.data(), buffer.size());
+	};
+}
+
+
+//Formats every batch with toDecimals() (on the sink's thread).
+Pipeline::Sink decimalFormatStage(std::ostream& output, int precision, RoundingMode mode) {
+	std::ostream* stream = &output;
+
+	return [stream, precision, mode](const FractionColumns& batch) {
+		std::string text = toDecimals(batch, precision, mode, 1);
+		stream->write(text.data(), text.size());
+	};
+}
+
+} //namespace fraction {
@@ -0,0 +1,192 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the Pipeline class, and of the
+* built-in stages
+*/
+
+
+#ifndef PIPELINE_HPP_
+#define PIPELINE_HPP_
+
+#include "Comparison.hpp"
+#include "DecimalConversion.hpp" //for RoundingMode
+#include "Fraction.hpp"
+#include "FractionColumns.hpp"
+#include <cstddef> //for std::size_t
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class runs the stages of a stream processing job - e.g. parsing,
+computing and formatting - on their own threads, so they work on different
+parts of the stream at the same time.
+
+The stream flows through the stages in batches of fractions (FractionColumns):
+- The source fills batches (e.g. by parsing the input).
+- Every stage transforms every batch in place (it may change its size).
+- The sink consumes the batches (e.g. by formatting them to the output).
+The batches keep the order of the stream.
+
+Consecutive stages are connected by lock-free single-producer
+single-consumer queues (SpscQueue), and the consumed batches are sent back to
+the source by another one, so a fixed number of batches circulates and
+nothing is allocated per batch once their columns have grown. That's also the
+backpressure: when the slowest stage falls behind, the batches pile up in its
+queue, and the source waits for a free batch instead of reading ahead.
+
+A waiting thread spins for a short while and then yields, so a pipeline with
+more stages than cores still makes progress.
+
+Every stage can be pinned to a CPU (Linux only), so the stages don't migrate
+between cores and the batches they pass stay in the shared caches.
+
+If a stage throws, the other stages are stopped, and run() rethrows the first
+exception after all the threads finished.
+*/
+class Pipeline
+{
+public:
+	//-- types --//
+
+	/*
+	Fills the (empty) batch with the next part of the stream.
+	Returns 'false' when the stream ended (a non-empty last batch is still
+	processed).
+	*/
+	typedef std::function<bool(FractionColumns& batch)> Source;
+
+	//Transforms the batch in place.
+	typedef std::function<void(FractionColumns& batch)> Stage;
+
+	//Consumes the batch.
+	typedef std::function<void(const FractionColumns& batch)> Sink;
+
+
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+
+	'batches' (at least 1) is the number of batches that circulate, i.e. the
+	bound on the batches that were read but not consumed yet.
+	*/
+	explicit Pipeline(std::size_t batches = DEFAULT_BATCHES);
+
+
+	//-- public methods --//
+
+	//Sets the source, which runs on a thread pinned to 'cpu' (or on any CPU,
+	//for ANY_CPU).
+	void setSource(Source source, int cpu = ANY_CPU);
+
+	//Appends a stage after the previous ones, which runs on a thread pinned to
+	//'cpu' (or on any CPU, for ANY_CPU).
+	void addStage(Stage stage, int cpu = ANY_CPU);
+
+	//Sets the sink, which runs on a thread pinned to 'cpu' (or on any CPU, for
+	//ANY_CPU).
+	void setSink(Sink sink, int cpu = ANY_CPU);
+
+	/*
+	Runs the pipeline until the source ends and all its batches are consumed.
+
+	If there's no source or no sink, it throws std::invalid_argument.
+	If a thread can't be pinned to its CPU, it throws std::system_error.
+	Any exception thrown by a stage is rethrown.
+	*/
+	void run();
+
+	//Means a stage isn't pinned to a CPU.
+	static const int ANY_CPU = -1;
+
+	//The default number of batches.
+	static const std::size_t DEFAULT_BATCHES = 8;
+
+private:
+	//-- private data members --//
+
+	//The number of batches that circulate
+	std::size_t m_batches;
+
+	//The source, and its CPU
+	Source m_source;
+	int m_source_cpu;
+
+	//The stages, and their CPUs
+	std::vector<Stage> m_stages;
+	std::vector<int> m_stage_cpus;
+
+	//The sink, and its CPU
+	Sink m_sink;
+	int m_sink_cpu;
+
+}; //class Pipeline {
+
+
+/*
+The built-in stages.
+They wrap the parser, the kernels and the formatters of the library, and are
+passed to the pipeline like any other stage.
+*/
+
+
+//The default number of fractions in a batch of parseStage().
+static const std::size_t DEFAULT_BATCH_SIZE = 1 << 14;
+
+/*
+Returns a source that reads 'input' (which must outlive the pipeline), one
+fraction per line, into batches of up to 'batchSize' fractions.
+
+The lines are parsed with parseFraction(), in the formats operator>> accepts
+and as decimals, and the ones that can't be parsed are skipped (as operator>>
+does). If 'malformed' isn't null, the number of skipped lines is stored in it
+(which is final once run() returned).
+*/
+Pipeline::Source parseStage(std::istream& input, std::size_t batchSize = DEFAULT_BATCH_SIZE,
+	std::size_t* malformed = nullptr);
+
+
+//The operations of arithmeticStage().
+enum class Operation {
+	Add,
+	Subtract,
+	Multiply,
+	Divide
+};
+
+/*
+Returns a stage that replaces every fraction x of the batch with 'x operation
+operand', computed with the arithmetic operators of Fraction with overflow
+protection - so an overflow throws NumericOverflowException() (and a division
+by 0 throws DivisionByZeroException()), which stops the pipeline.
+*/
+Pipeline::Stage arithmeticStage(Operation operation, const Fraction& operand);
+
+//Returns a stage that keeps only the fractions x of the batch for which
+//'x comparison value' holds (selected with filter()).
+Pipeline::Stage filterStage(Comparison comparison, const Fraction& value);
+
+/*
+Returns a sink that writes the fractions to 'output' (which must outlive the
+pipeline), one per line, in the format of operator<<.
+Every batch is formatted into a buffer, which is written with a single call.
+*/
+Pipeline::Sink formatStage(std::ostream& output);
+
+//Returns a sink that writes the fractions to 'output' (which must outlive the
+//pipeline) as decimals, one per line, formatted with toDecimals().
+Pipeline::Sink decimalFormatStage(std::ostream& output, int precision,
+	RoundingMode mode = RoundingMode::HalfEven);
+
+} //namespace fraction {
+
+#endif
@@ -3,37 +3,100 @@
 **/
 
 /*
-* In this file we have the declaration of the SafeArithmetics namespace
+* In this file we have the declaration of the SafeArithmetics namespace, and
+* the implementation of its scalar functions
 */
 
 #ifndef SAFEARITHMETICS_HPP_
 #define SAFEARITHMETICS_HPP_
 
+#include "NumericOverflowException.hpp"
+#include <climits> //for INT_MIN
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+
 
 /*
 This namespace holds functions return the value they suppose to (e.g. add()
 returns the sum), but first check if the operation would cause an integer overflow.
 If an integer overflow would occur, it throws NumericOverflowException().
+
+The scalar functions are called on every protected operation of Fraction, so
+they are defined here (to be inlined), and they check for an overflow with the
+compiler's overflow builtins - which compile to the operation itself followed
+by a single test of the CPU's overflow flag, instead of the divisions and sign
+branches a portable check needs.
+
+The batch functions don't throw - they compute a whole array, and return which
+elements overflowed in a bitmask, so a caller can check a whole block at once.
 */
 namespace SafeArithmetics {
-	
+
 	/*
 	Returns num1+num2, or throws NumericOverflowException() if the sum would
 	overflow.
 	*/
-	int add(int num1, int num2);
+	inline int add(int num1, int num2) {
+		int result;
+		if (__builtin_add_overflow(num1, num2, &result))
+			throw NumericOverflowException();
+		return result;
+	}
 
 	/*
 	Returns num1*num2, or throws NumericOverflowException() if the multiplication
 	would overflow.
 	*/
-	int multiply(int num1, int num2);
+	inline int multiply(int num1, int num2) {
+		int result;
+		if (__builtin_mul_overflow(num1, num2, &result))
+			throw NumericOverflowException();
+		return result;
+	}
 
 	/*
 	Returns num1/num2, or throws NumericOverflowException() if the division would
-	overflow
+	overflow.
+	A division can overflow only if the numerator is INT_MIN, and the
+	denominator is -1.
 	*/
-	int divide(int num1, int num2);
+	inline int divide(int num1, int num2) {
+		if ((INT_MIN == num1) & (-1 == num2))
+			throw NumericOverflowException();
+		return num1 / num2;
+	}
+
+
+	//Batch functions
+
+
+	//Returns the number of 64-bit words in the overflow mask of 'count' elements.
+	inline std::size_t maskWords(std::size_t count) {
+		return (count + 63) / 64;
+	}
+
+	/*
+	Sets result[i] = lhs[i]+rhs[i] for every i in [0, count).
+
+	Bit (i % 64) of overflowMask[i / 64] is set iff the i-th sum overflowed (in
+	which case result[i] holds the wrapped sum). 'overflowMask' must have
+	maskWords(count) words.
+
+	Returns 'true' if any of the sums overflowed.
+
+	These loops are compiled for the target of the build. SimdKernels.hpp has
+	the same loops for every SimdLevel.
+	*/
+	bool add(const int* lhs, const int* rhs, int* result, std::size_t count,
+		std::uint64_t* overflowMask);
+
+	//The same as the batch add(), for lhs[i]-rhs[i].
+	bool subtract(const int* lhs, const int* rhs, int* result, std::size_t count,
+		std::uint64_t* overflowMask);
+
+	//The same as the batch add(), for lhs[i]*rhs[i].
+	bool multiply(const int* lhs, const int* rhs, int* result, std::size_t count,
+		std::uint64_t* overflowMask);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,52 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the ScanOverflowException class
+*/
+
+
+#ifndef SCANOVERFLOWEXCEPTION_HPP_
+#define SCANOVERFLOWEXCEPTION_HPP_
+
+#include "NumericOverflowException.hpp"
+#include <cstddef> //for std::size_t
+#include <string>
+
+
+/*
+This class represents an exception class that should be thrown whenever an
+output of a scan (a prefix sum) overflows.
+It holds the index of the first output that overflowed.
+*/
+class ScanOverflowException : public NumericOverflowException
+{
+public:
+	//-- constructors/destructor --//
+
+	/* constructor */
+
+	//Sets the error message to "numeric overflow detected at index <index>".
+	explicit ScanOverflowException(std::size_t index) :
+		m_index(index)
+	{
+		this->m_err_msg = "numeric overflow detected at index " + std::to_string(index);
+	}
+
+
+	//-- public methods --//
+
+	//Getter for the index of the output that overflowed
+	std::size_t getIndex() const {
+		return this->m_index;
+	}
+
+private:
+	//-- private data members --//
+
+	//The index of the output that overflowed
+	std::size_t m_index;
+};
+
+#endif
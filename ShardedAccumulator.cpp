@@ -0,0 +1,276 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the ShardedAccumulator class
+*/
+
+#include "ShardedAccumulator.hpp"
+#include "DivisionByZeroException.hpp"
+#include "WideArithmetics.hpp"
+#include <thread>
+#ifdef __linux__
+#include <sched.h> //for sched_getcpu()
+#endif
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//The number of threads that asked for a shard so far.
+static std::atomic<std::size_t> g_thread_count(0);
+
+
+//Returns the number of the calling thread, which is assigned on its first call
+//(so the threads of a process are numbered 0, 1, 2, ...).
+static std::size_t threadNumber() {
+	static thread_local std::size_t number = g_thread_count.fetch_add(1, std::memory_order_relaxed);
+	return number;
+}
+
+
+//The number of times a waiting thread spins before it starts yielding (the
+//holder of a shard may have been preempted).
+static const unsigned SPIN_LIMIT = 256;
+
+
+//Waits a little before the next attempt to read or hold a shard: spins for
+//the first attempts, and then yields the CPU.
+static void backoff(unsigned& attempts) {
+	if (attempts < SPIN_LIMIT) {
+		++attempts;
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+	}
+	else {
+		std::this_thread::yield();
+	}
+}
+
+
+//Rounds the number of shards up to a power of 2.
+ShardedAccumulator::ShardedAccumulator(std::size_t shards, ShardSelection selection) :
+	m_selection(selection)
+{
+	if (0 == shards) {
+		shards = std::thread::hardware_concurrency();
+		if (0 == shards)
+			shards = 1;
+	}
+
+	std::size_t size = 1;
+	while (size < shards)
+		size *= 2;
+
+	this->m_shards.reset(new Shard[size]);
+	this->m_mask = size - 1;
+}
+
+
+// += operators
+
+
+//Adds the numerator and denominator of 'frac'.
+ShardedAccumulator& ShardedAccumulator::operator+= (const Fraction& frac) { //acc+=frac
+	this->add(frac.getNumerator(), frac.getDenominator());
+	return *this;
+}
+
+
+//An integer is the fraction number/1.
+ShardedAccumulator& ShardedAccumulator::operator+= (int number) { //acc+=number
+	this->add(number, 1);
+	return *this;
+}
+
+
+/***
+*void ShardedAccumulator::add() - Adds a fraction to the calling thread's shard
+*
+*Purpose:
+*       Holds the shard, adds the fraction to its accumulator, and publishes
+*       the new sum when it releases it.
+*
+*       If the addition throws, the accumulator is left unchanged (see
+*       FractionAccumulator), and the shard is released before the exception
+*       propagates.
+*
+*Entry:
+*       int   numerator - The numerator of the added fraction
+*       int denominator - The denominator of the added fraction
+*
+*Exit:
+*
+*Exceptions:
+*       DivisionByZeroException()  - If the denominator is 0.
+*       NumericOverflowException() - If the reduced sum of the shard doesn't
+*                                    fit in 128 bits.
+*
+*******************************************************************************/
+void ShardedAccumulator::add(int numerator, int denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	Shard& shard = this->currentShard();
+	lock(shard);
+
+	try {
+		shard.sum.add(numerator, denominator);
+	}
+	catch (...) {
+		unlock(shard);
+		throw;
+	}
+
+	unlock(shard);
+}
+
+
+/***
+*FractionAccumulator ShardedAccumulator::snapshot() - Returns the combined sum
+*
+*Purpose:
+*       Exact: holds all the shards (in order - writers hold only one shard,
+*       so this can't deadlock), merges their accumulators, and releases them.
+*
+*       Relaxed: for every shard, reads the sequence, the published sum and
+*       the sequence again, and retries if the sequence was odd or changed -
+*       so the copy is a sum the shard actually had. The copies are then
+*       merged.
+*
+*Entry:
+*       ReadMode mode - How the shards are read.
+*
+*Exit:
+*       FractionAccumulator - The sum and count of all the shards.
+*
+*Exceptions:
+*       NumericOverflowException() - If the reduced total doesn't fit in 128
+*                                    bits.
+*
+*******************************************************************************/
+FractionAccumulator ShardedAccumulator::snapshot(ReadMode mode) const {
+	FractionAccumulator total;
+	std::size_t shards = this->m_mask + 1;
+
+	if (ReadMode::Exact == mode) {
+		for (std::size_t i = 0; i < shards; ++i)
+			lock(this->m_shards[i]);
+
+		try {
+			for (std::size_t i = 0; i < shards; ++i)
+				total.merge(this->m_shards[i].sum);
+		}
+		catch (...) {
+			for (std::size_t i = 0; i < shards; ++i)
+				unlock(this->m_shards[i]);
+			throw;
+		}
+
+		for (std::size_t i = 0; i < shards; ++i)
+			unlock(this->m_shards[i]);
+		return total;
+	}
+
+	for (std::size_t i = 0; i < shards; ++i) {
+		const Shard& shard = this->m_shards[i];
+		std::uint64_t numerator_low, numerator_high, denominator_low, denominator_high, count;
+		unsigned attempts = 0;
+
+		while (true) {
+			unsigned before = shard.sequence.load(std::memory_order_acquire);
+			if (before & 1) {
+				backoff(attempts);
+				continue;
+			}
+
+			numerator_low = shard.numerator_low.load(std::memory_order_relaxed);
+			numerator_high = shard.numerator_high.load(std::memory_order_relaxed);
+			denominator_low = shard.denominator_low.load(std::memory_order_relaxed);
+			denominator_high = shard.denominator_high.load(std::memory_order_relaxed);
+			count = shard.count.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (shard.sequence.load(std::memory_order_relaxed) == before)
+				break;
+		}
+
+		int128 numerator = (int128)(((unsigned __int128)numerator_high << 64) | numerator_low);
+		int128 denominator = (int128)(((unsigned __int128)denominator_high << 64) | denominator_low);
+		total.merge(numerator, denominator, (std::size_t)count);
+	}
+
+	return total;
+}
+
+
+//Holds all the shards, and resets their accumulators.
+void ShardedAccumulator::reset() {
+	std::size_t shards = this->m_mask + 1;
+
+	for (std::size_t i = 0; i < shards; ++i)
+		lock(this->m_shards[i]);
+
+	for (std::size_t i = 0; i < shards; ++i) {
+		this->m_shards[i].sum.reset();
+		unlock(this->m_shards[i]);
+	}
+}
+
+
+//PerThread: the thread number modulo the number of shards.
+//PerCpu: the CPU number modulo the number of shards, if it's known.
+ShardedAccumulator::Shard& ShardedAccumulator::currentShard() const {
+#ifdef __linux__
+	if (ShardSelection::PerCpu == this->m_selection) {
+		int cpu = sched_getcpu();
+		if (cpu >= 0)
+			return this->m_shards[(std::size_t)cpu & this->m_mask];
+	}
+#endif
+
+	return this->m_shards[threadNumber() & this->m_mask];
+}
+
+
+//Spins until the sequence is even and we made it odd. The acquire keeps the
+//accesses to the shard after it, and the release fence keeps the published
+//words from being written before the sequence is odd (so a Relaxed read that
+//sees a new word also sees the new sequence).
+void ShardedAccumulator::lock(Shard& shard) {
+	unsigned sequence = shard.sequence.load(std::memory_order_relaxed);
+	unsigned attempts = 0;
+
+	while ((sequence & 1) ||
+		!shard.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+			std::memory_order_relaxed))
+	{
+		backoff(attempts);
+		sequence = shard.sequence.load(std::memory_order_relaxed);
+	}
+
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+
+//Copies the sum to the published words, and makes the sequence even. The
+//release keeps the accesses to the shard before it.
+void ShardedAccumulator::unlock(Shard& shard) {
+	unsigned __int128 numerator = (unsigned __int128)shard.sum.getNumerator();
+	unsigned __int128 denominator = (unsigned __int128)shard.sum.getDenominator();
+
+	shard.numerator_low.store((std::uint64_t)numerator, std::memory_order_relaxed);
+	shard.numerator_high.store((std::uint64_t)(numerator >> 64), std::memory_order_relaxed);
+	shard.denominator_low.store((std::uint64_t)denominator, std::memory_order_relaxed);
+	shard.denominator_high.store((std::uint64_t)(denominator >> 64), std::memory_order_relaxed);
+	shard.count.store(shard.sum.getCount(), std::memory_order_relaxed);
+
+	shard.sequence.store(shard.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+} //namespace fraction {
@@ -0,0 +1,96 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a contention benchmark of ShardedAccumulator against a
+* Fraction protected by a mutex and against AtomicFraction.
+*
+* For 1, 2, 4, ..., 64 threads, every thread adds 1/2 to the same logical
+* total a fixed number of times, and the benchmark prints the time per addition
+* of every approach. The sharded accumulator has a shard per thread, and a
+* reader thread takes Relaxed snapshots while the writers run.
+*
+* The last approach is the bound of the sharded one: every thread adds to its
+* own FractionAccumulator with no synchronization at all, and they're merged
+* when the threads end - so the difference is the cost of the sequence locks.
+*/
+
+#include "AtomicFraction.hpp"
+#include "Benchmark.hpp"
+#include "Fraction.hpp"
+#include "FractionAccumulator.hpp"
+#include "ShardedAccumulator.hpp"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+
+//The number of additions every thread does.
+static const int ADDITIONS = 100000;
+
+//The maximal number of threads.
+static const unsigned MAX_THREADS = 64;
+
+
+int main() {
+	const fraction::Fraction half(1, 2);
+
+	std::cout << "threads\tmutex ns/op\tatomic ns/op\tsharded ns/op\trelaxed reads\tunsynchronized ns/op" << std::endl;
+
+	for (unsigned threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		std::mutex lock;
+		fraction::Fraction locked_total;
+		double mutex_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			for (int i = 0; i < ADDITIONS; ++i) {
+				std::lock_guard<std::mutex> guard(lock);
+				locked_total += half;
+			}
+		});
+
+		fraction::AtomicFraction atomic_total;
+		double atomic_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			for (int i = 0; i < ADDITIONS; ++i)
+				atomic_total.fetchAdd(half);
+		});
+
+		fraction::ShardedAccumulator sharded_total(threads);
+		std::atomic<bool> done(false);
+		std::size_t reads = 0;
+		std::thread reader([&]() {
+			while (!done.load()) {
+				sharded_total.read(fraction::ReadMode::Relaxed);
+				++reads;
+			}
+		});
+		double sharded_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			for (int i = 0; i < ADDITIONS; ++i)
+				sharded_total += half;
+		});
+		done.store(true);
+		reader.join();
+
+		std::mutex merge_lock;
+		fraction::FractionAccumulator unsynchronized_total;
+		double unsynchronized_ns = Benchmark::measureThreads(threads, threads * ADDITIONS, [&]() {
+			fraction::FractionAccumulator partial;
+			for (int i = 0; i < ADDITIONS; ++i)
+				partial += half;
+
+			std::lock_guard<std::mutex> guard(merge_lock);
+			unsynchronized_total.merge(partial);
+		});
+
+		//All the totals must be threads*ADDITIONS/2.
+		if (!(locked_total == atomic_total.load()) || !(locked_total == sharded_total.read()) ||
+			!(locked_total == unsynchronized_total.result()))
+		{
+			std::cout << "totals differ!" << std::endl;
+			return 1;
+		}
+
+		std::cout << threads << "\t" << mutex_ns << "\t\t" << atomic_ns << "\t\t"
+			<< sharded_ns << "\t\t" << reads << "\t\t" << unsynchronized_ns << std::endl;
+	}
+}
@@ -0,0 +1,77 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we compile the kernels of SimdKernelsBody.hpp for every
+* SimdLevel, and select the table of the running machine
+*/
+
+#include "SimdKernels.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::int64_t, std::uint64_t
+
+
+namespace fraction {
+
+
+namespace generic {
+#include "SimdKernelsBody.hpp"
+}
+
+//Every '#pragma GCC target' applies to the functions defined until the
+//matching pop_options.
+#if defined(__x86_64__) || defined(__i386__)
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+namespace sse42 {
+#include "SimdKernelsBody.hpp"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+#include "SimdKernelsBody.hpp"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw")
+namespace avx512 {
+#include "SimdKernelsBody.hpp"
+}
+#pragma GCC pop_options
+
+#endif
+
+
+//Other targets have only the generic kernels.
+const SimdKernels& simdKernels(SimdLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+	switch (level) {
+	case SimdLevel::Sse42:
+		return sse42::KERNELS;
+	case SimdLevel::Avx2:
+		return avx2::KERNELS;
+	case SimdLevel::Avx512:
+		return avx512::KERNELS;
+	case SimdLevel::Generic:
+		break;
+	}
+#else
+	(void)level;
+#endif
+
+	return generic::KERNELS;
+}
+
+
+//The table is looked up once.
+const SimdKernels& simdKernels() {
+	static const SimdKernels& kernels = simdKernels(simdLevel());
+	return kernels;
+}
+
+} //namespace fraction {
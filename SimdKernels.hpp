@@ -0,0 +1,73 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the table of the vectorized kernels
+*/
+
+
+#ifndef SIMDKERNELS_HPP_
+#define SIMDKERNELS_HPP_
+
+#include "Comparison.hpp"
+#include "CpuDispatch.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint64_t
+
+
+namespace fraction {
+
+
+/*
+The inner loops of the kernels of FractionKernels.hpp, and the batch functions
+of SafeArithmetics - the loops the compiler vectorizes.
+
+They're compiled once for every SimdLevel (from the same source - see
+SimdKernelsBody.hpp), and their callers call them through the table of the
+level simdLevel() selects. So a single build uses the widest vectors
+of the machine it runs on, and still runs on machines without them.
+
+The loops work on blocks of 64 values, and the filter loops write a mask word
+per block (see FractionKernels.hpp), so 'begin' must be a multiple of 64.
+*/
+struct SimdKernels {
+
+	//The batch add(), subtract() and multiply() of SafeArithmetics (which
+	//itself only has the portable loops), for FixedDenominatorArray.
+	bool (*add)(const int* lhs, const int* rhs, int* result, std::size_t count, std::uint64_t* overflowMask);
+	bool (*subtract)(const int* lhs, const int* rhs, int* result, std::size_t count, std::uint64_t* overflowMask);
+	bool (*multiply)(const int* lhs, const int* rhs, int* result, std::size_t count, std::uint64_t* overflowMask);
+
+	//Sets the mask words of the values [begin, end) for which
+	//'n/d comparison vn/vd' holds, and returns the number of selected values.
+	std::size_t (*filter)(const int* numerators, const int* denominators, std::size_t begin, std::size_t end,
+		Comparison comparison, long long vn, long long vd, std::uint64_t* mask);
+
+	//The same for ln/ld <= n/d < hn/hd.
+	std::size_t (*filterRange)(const int* numerators, const int* denominators, std::size_t begin,
+		std::size_t end, long long ln, long long ld, long long hn, long long hd, std::uint64_t* mask);
+
+	//Sets the buckets of the values [begin, end) by comparing every one of the
+	//'count' boundaries against blocks of values (for a few boundaries).
+	void (*bucketizeLinear)(const int* numerators, const int* denominators, std::size_t begin,
+		std::size_t end, const long long* boundaryNumerators, const long long* boundaryDenominators,
+		std::size_t count, int* buckets);
+
+	//The same, by binary searching groups of values (for many boundaries -
+	//'count' must be at least 1).
+	void (*bucketizeSearch)(const int* numerators, const int* denominators, std::size_t begin,
+		std::size_t end, const long long* boundaryNumerators, const long long* boundaryDenominators,
+		std::size_t count, int* buckets);
+};
+
+
+//Returns the kernels of simdLevel() (selected on the first call).
+const SimdKernels& simdKernels();
+
+//Returns the kernels of 'level' (which the CPU must support).
+const SimdKernels& simdKernels(SimdLevel level);
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,247 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the bodies of the vectorized kernels.
+*
+* It has no include guard: SimdKernels.cpp includes it once per SimdLevel,
+* each time in its own namespace and with its own '#pragma GCC target' - so
+* every function (and lambda) here is compiled for that level. It includes no
+* headers, since the standard headers must not be compiled for a level.
+*/
+
+
+//The number of values in a block of bucketizeLinear().
+static const std::size_t BUCKET_BLOCK_SIZE = 256;
+
+//The number of values bucketizeSearch() binary searches together.
+static const std::size_t SEARCH_GROUP_SIZE = 8;
+
+
+/***
+*bool batchOperation() - The loop of the batch functions of SafeArithmetics
+*
+*Purpose:
+*       Computes operation(lhs[i], rhs[i]) for every element, in blocks of 64.
+*
+*       Every operation is computed in 64 bits, where it can't overflow, and
+*       the element overflowed iff the wide result differs from the result
+*       truncated to 32 bits. The loop body has no branches, so the compiler
+*       can vectorize it: the first loop writes the results and one flag byte
+*       per element, and the second packs the 64 flags into one word.
+*
+*Entry:
+*       const int*                lhs - The left operands.
+*       const int*                rhs - The right operands.
+*       int*                   result - Would hold the results.
+*       std::size_t             count - The number of elements.
+*       std::uint64_t*   overflowMask - Would hold the overflow bits.
+*       Operation           operation - The operation on 'std::int64_t's.
+*
+*Exit:
+*       bool - 'true' if any of the operations overflowed.
+*
+*Exceptions:
+*
+*******************************************************************************/
+template <typename Operation>
+static bool batchOperation(const int* lhs, const int* rhs, int* result, std::size_t count,
+	std::uint64_t* overflowMask, Operation operation)
+{
+	std::uint64_t any_overflow = 0;
+
+	for (std::size_t block = 0; block < count; block += 64) {
+		std::size_t block_size = (count - block < 64) ? count - block : 64;
+
+		unsigned char overflowed[64];
+		for (std::size_t i = 0; i < block_size; ++i) {
+			std::int64_t wide = operation((std::int64_t)lhs[block + i], (std::int64_t)rhs[block + i]);
+			result[block + i] = (int)wide;
+			overflowed[i] = (wide != (std::int64_t)(int)wide);
+		}
+
+		std::uint64_t mask = 0;
+		for (std::size_t i = 0; i < block_size; ++i)
+			mask |= (std::uint64_t)overflowed[i] << i;
+
+		overflowMask[block / 64] = mask;
+		any_overflow |= mask;
+	}
+
+	return 0 != any_overflow;
+}
+
+
+//lhs[i]+rhs[i]
+static bool add(const int* lhs, const int* rhs, int* result, std::size_t count, std::uint64_t* overflowMask) {
+	return batchOperation(lhs, rhs, result, count, overflowMask,
+		[](std::int64_t num1, std::int64_t num2) { return num1 + num2; });
+}
+
+
+//lhs[i]-rhs[i]
+static bool subtract(const int* lhs, const int* rhs, int* result, std::size_t count, std::uint64_t* overflowMask) {
+	return batchOperation(lhs, rhs, result, count, overflowMask,
+		[](std::int64_t num1, std::int64_t num2) { return num1 - num2; });
+}
+
+
+//lhs[i]*rhs[i]
+static bool multiply(const int* lhs, const int* rhs, int* result, std::size_t count, std::uint64_t* overflowMask) {
+	return batchOperation(lhs, rhs, result, count, overflowMask,
+		[](std::int64_t num1, std::int64_t num2) { return num1 * num2; });
+}
+
+
+/***
+*std::size_t filterBlocks() - Sets the mask bits of the values that satisfy
+*                             a predicate
+*
+*Purpose:
+*       For every block of 64 values, the predicate is evaluated into an array
+*       of flags (a loop with no branches, which the compiler vectorizes), and
+*       the flags are then packed into the mask word of the block.
+*
+*Entry:
+*       const int*     numerators - The numerators of the values.
+*       const int*   denominators - The denominators of the values.
+*       std::size_t         begin - The first value (a multiple of 64).
+*       std::size_t           end - The end of the values.
+*       std::uint64_t*       mask - Would hold the selection.
+*       Predicate       predicate - Called as predicate(numerator,
+*                                   denominator), both 'long long'.
+*
+*Exit:
+*       std::size_t - The number of selected values.
+*
+*Exceptions:
+*
+*******************************************************************************/
+template <typename Predicate>
+static std::size_t filterBlocks(const int* numerators, const int* denominators, std::size_t begin,
+	std::size_t end, std::uint64_t* mask, Predicate predicate)
+{
+	std::size_t selected = 0;
+
+	for (std::size_t block = begin; block < end; block += 64) {
+		std::size_t block_size = (end - block < 64) ? end - block : 64;
+		const int* block_numerators = numerators + block;
+		const int* block_denominators = denominators + block;
+
+		unsigned char flags[64];
+		for (std::size_t i = 0; i < block_size; ++i)
+			flags[i] = predicate((long long)block_numerators[i], (long long)block_denominators[i]);
+
+		std::uint64_t word = 0;
+		for (std::size_t i = 0; i < block_size; ++i)
+			word |= (std::uint64_t)flags[i] << i;
+
+		mask[block / 64] = word;
+		selected += __builtin_popcountll(word);
+	}
+
+	return selected;
+}
+
+
+//Cross-multiplies every value n/d with vn/vd, and compares n*vd with vn*d.
+static std::size_t filter(const int* numerators, const int* denominators, std::size_t begin, std::size_t end,
+	Comparison comparison, long long vn, long long vd, std::uint64_t* mask)
+{
+	switch (comparison) {
+	case Comparison::Less:
+		return filterBlocks(numerators, denominators, begin, end, mask,
+			[vn, vd](long long n, long long d) { return n * vd < vn * d; });
+	case Comparison::LessEqual:
+		return filterBlocks(numerators, denominators, begin, end, mask,
+			[vn, vd](long long n, long long d) { return n * vd <= vn * d; });
+	case Comparison::Greater:
+		return filterBlocks(numerators, denominators, begin, end, mask,
+			[vn, vd](long long n, long long d) { return n * vd > vn * d; });
+	case Comparison::GreaterEqual:
+		return filterBlocks(numerators, denominators, begin, end, mask,
+			[vn, vd](long long n, long long d) { return n * vd >= vn * d; });
+	case Comparison::Equal:
+		return filterBlocks(numerators, denominators, begin, end, mask,
+			[vn, vd](long long n, long long d) { return n * vd == vn * d; });
+	case Comparison::NotEqual:
+		return filterBlocks(numerators, denominators, begin, end, mask,
+			[vn, vd](long long n, long long d) { return n * vd != vn * d; });
+	}
+	return 0;
+}
+
+
+//Both comparisons are evaluated without short-circuiting, so the loop has no
+//branches.
+static std::size_t filterRange(const int* numerators, const int* denominators, std::size_t begin,
+	std::size_t end, long long ln, long long ld, long long hn, long long hd, std::uint64_t* mask)
+{
+	return filterBlocks(numerators, denominators, begin, end, mask, [=](long long n, long long d) {
+		return (ln * d <= n * ld) & (n * hd < hn * d);
+	});
+}
+
+
+//Every boundary is compared against all the values of a block, and the
+//results are added to their buckets.
+static void bucketizeLinear(const int* numerators, const int* denominators, std::size_t begin,
+	std::size_t end, const long long* boundaryNumerators, const long long* boundaryDenominators,
+	std::size_t count, int* buckets)
+{
+	for (std::size_t block = begin; block < end; block += BUCKET_BLOCK_SIZE) {
+		std::size_t block_end = (end - block < BUCKET_BLOCK_SIZE) ? end : block + BUCKET_BLOCK_SIZE;
+
+		for (std::size_t i = block; i < block_end; ++i)
+			buckets[i] = 0;
+
+		for (std::size_t k = 0; k < count; ++k) {
+			long long bn = boundaryNumerators[k], bd = boundaryDenominators[k];
+			for (std::size_t i = block; i < block_end; ++i)
+				buckets[i] += (bn * denominators[i] <= (long long)numerators[i] * bd);
+		}
+	}
+}
+
+
+//The search halves the range the same way for every value, whatever the
+//comparisons are (only its base moves), so SEARCH_GROUP_SIZE values are
+//searched together in lockstep, and the next base is selected without a
+//branch.
+static void bucketizeSearch(const int* numerators, const int* denominators, std::size_t begin,
+	std::size_t end, const long long* boundaryNumerators, const long long* boundaryDenominators,
+	std::size_t count, int* buckets)
+{
+	const long long* bn = boundaryNumerators;
+	const long long* bd = boundaryDenominators;
+
+	for (std::size_t group = begin; group < end; group += SEARCH_GROUP_SIZE) {
+		std::size_t group_size = (end - group < SEARCH_GROUP_SIZE) ? end - group : SEARCH_GROUP_SIZE;
+		long long n[SEARCH_GROUP_SIZE], d[SEARCH_GROUP_SIZE];
+		std::size_t base[SEARCH_GROUP_SIZE];
+		for (std::size_t j = 0; j < SEARCH_GROUP_SIZE; ++j) {
+			std::size_t i = group + ((j < group_size) ? j : 0);
+			n[j] = numerators[i];
+			d[j] = denominators[i];
+			base[j] = 0;
+		}
+
+		for (std::size_t length = count; length > 1; length -= length / 2) {
+			std::size_t half = length / 2;
+			for (std::size_t j = 0; j < SEARCH_GROUP_SIZE; ++j) {
+				std::size_t probe = base[j] + half;
+				base[j] = (bn[probe] * d[j] <= n[j] * bd[probe]) ? probe : base[j];
+			}
+		}
+
+		for (std::size_t j = 0; j < group_size; ++j)
+			buckets[group + j] = (int)(base[j] + (bn[base[j]] * d[j] <= n[j] * bd[base[j]]));
+	}
+}
+
+
+//The table of this level.
+static const SimdKernels KERNELS = {
+	add, subtract, multiply, filter, filterRange, bucketizeLinear, bucketizeSearch
+};
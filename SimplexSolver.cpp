@@ -0,0 +1,538 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the SimplexSolver class
+*/
+
+
+#include "SimplexSolver.hpp"
+#include "NumericOverflowException.hpp"
+#include "Parallel.hpp"
+#include <algorithm> //for std::fill
+#include <stdexcept> //for std::invalid_argument
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//A row of the tableau is divided by the gcd of its coefficients once one of
+//them grows past this number of bits - so the products of a pivot (and their
+//difference) fit in 128 bits while the rows are smaller.
+static const int REDUCE_THRESHOLD = 60;
+
+//After this number of degenerate pivots in a row, the pivots are chosen by
+//Bland's rule (until the objective improves).
+static const unsigned DEGENERATE_PIVOTS = 4;
+
+
+//Returns the least common multiple of 'num1' (positive) and 'num2' (positive),
+//or throws NumericOverflowException() if it doesn't fit.
+static int128 lcm(int128 num1, int128 num2) {
+	return WideArithmetics::multiply(num1 / WideArithmetics::gcd(num1, num2), num2);
+}
+
+
+//Divides the 'count' coefficients of 'row' by their gcd, if one of them grew
+//past REDUCE_THRESHOLD bits. The signs don't change.
+static void reduceRow(int128* row, std::size_t count) {
+	bool large = false;
+	for (std::size_t i = 0; i < count && !large; ++i)
+		large = WideArithmetics::bitLength(row[i]) > REDUCE_THRESHOLD;
+	if (!large)
+		return;
+
+	int128 divisor = 0;
+	for (std::size_t i = 0; i < count && 1 != divisor; ++i)
+		divisor = WideArithmetics::gcd(divisor, row[i]);
+	if (divisor > 1) {
+		for (std::size_t i = 0; i < count; ++i)
+			row[i] /= divisor;
+	}
+}
+
+
+/*
+The simplex tableau of a LinearProgram, in the standard form: every constraint
+is an equation with a non-negative right-hand side, over the variables of the
+program followed by a slack variable for every <= constraint, a surplus
+variable for every >= constraint, and an artificial variable for every >= and
+== constraint.
+
+Every row is stored as its integer coefficients followed by its right-hand side,
+and has a basic variable, whose coefficient is positive - the denominator of
+the row. The basic variable of a row has a coefficient of 0 in the other rows,
+so when the other variables are 0, it's the right-hand side divided by the
+denominator.
+
+The objective row is stored the same way, followed by its own denominator: its
+coefficients are -(the reduced costs) times the denominator, and its right-hand
+side is the value of the objective times the denominator.
+*/
+class Tableau
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	Creates the tableau of 'program', with the artificial variables basic. The
+	rows are multiplied by the lcm of their denominators, and negated if their
+	bound is negative.
+	If a scaled coefficient doesn't fit in 128 bits, it throws
+	NumericOverflowException().
+	*/
+	explicit Tableau(const LinearProgram& program);
+
+
+	//-- public methods --//
+
+	//Runs the first phase (maximizes minus the sum of the artificial
+	//variables). Returns 'false' if the program is infeasible.
+	bool phaseOne();
+
+	//Runs the second phase (maximizes the objective of 'program') from the
+	//feasible basis of the first one. Returns 'false' if it's unbounded.
+	bool phaseTwo(const LinearProgram& program);
+
+	//Fills the value and the solution of 'result' from the optimal basis.
+	void fillResult(SimplexResult& result) const;
+
+private:
+	//-- private methods --//
+
+	//Returns the coefficients of row 'row'.
+	int128* row(std::size_t row) {
+		return &this->m_rows[row * this->width()];
+	}
+
+	//Returns the number of values stored for a row (the coefficients and the
+	//right-hand side).
+	std::size_t width() const {
+		return this->m_columns + 1;
+	}
+
+	//Zeroes the coefficients of the basic variables in the objective row.
+	void eliminateBasis();
+
+	//Makes the objective optimal, with the variables before 'columns' allowed
+	//to enter the basis. Returns 'false' if it's unbounded.
+	bool optimize(std::size_t columns);
+
+	//Pivots on row 'pivot_row' and column 'column' (whose coefficient in the
+	//row is positive).
+	void pivot(std::size_t pivot_row, std::size_t column);
+
+	//Replaces row 'target' (of 'count' values) with pivot*target-factor*source
+	//(over the first 'count' values of 'source').
+	void combine(int128* target, std::size_t count, int128 pivot, int128 factor, const int128* source);
+
+
+	//-- private data members --//
+
+	//The number of variables of the program
+	std::size_t m_variables;
+
+	//The index of the first artificial variable
+	std::size_t m_artificial;
+
+	//The number of variables in the standard form (with the artificial ones)
+	std::size_t m_columns;
+
+	//The rows, one after the other
+	std::vector<int128> m_rows;
+
+	//The basic variable of every row
+	std::vector<std::size_t> m_basis;
+
+	//The objective row (the coefficients, the right-hand side and the
+	//denominator)
+	std::vector<int128> m_objective;
+
+}; //class Tableau {
+
+
+//The scaled (integer) coefficients of a row are computed first, since the
+//number of the slack and artificial variables is known only after the bounds
+//are normalized.
+Tableau::Tableau(const LinearProgram& program) :
+	m_variables(program.objective.size()),
+	m_artificial(0),
+	m_columns(0)
+{
+	std::size_t rows = program.constraints.size();
+	std::vector<int128> scaled(rows * (this->m_variables + 1));
+	std::vector<ConstraintRelation> relations(program.relations);
+	std::size_t slacks = 0, artificials = 0;
+
+	for (std::size_t i = 0; i < rows; ++i) {
+		const std::vector<Fraction>& constraint = program.constraints[i];
+		int128* scaled_row = &scaled[i * (this->m_variables + 1)];
+
+		int128 multiple = program.bounds[i].getDenominator();
+		for (std::size_t j = 0; j < this->m_variables; ++j)
+			multiple = lcm(multiple, constraint[j].getDenominator());
+
+		int128 sign = (program.bounds[i].getNumerator() < 0) ? -1 : 1;
+		for (std::size_t j = 0; j < this->m_variables; ++j) {
+			scaled_row[j] = WideArithmetics::multiply(sign * constraint[j].getNumerator(),
+				multiple / constraint[j].getDenominator());
+		}
+		scaled_row[this->m_variables] = WideArithmetics::multiply(sign * program.bounds[i].getNumerator(),
+			multiple / program.bounds[i].getDenominator());
+
+		if (sign < 0 && ConstraintRelation::Equal != relations[i]) {
+			relations[i] = (ConstraintRelation::LessEqual == relations[i]) ? ConstraintRelation::GreaterEqual :
+				ConstraintRelation::LessEqual;
+		}
+		slacks += (ConstraintRelation::Equal != relations[i]) ? 1 : 0;
+		artificials += (ConstraintRelation::LessEqual != relations[i]) ? 1 : 0;
+	}
+
+	this->m_artificial = this->m_variables + slacks;
+	this->m_columns = this->m_artificial + artificials;
+	this->m_rows.assign(rows * this->width(), 0);
+	this->m_basis.resize(rows);
+	this->m_objective.assign(this->width() + 1, 0);
+
+	std::size_t slack = this->m_variables, artificial = this->m_artificial;
+	for (std::size_t i = 0; i < rows; ++i) {
+		int128* tableau_row = this->row(i);
+		const int128* scaled_row = &scaled[i * (this->m_variables + 1)];
+
+		for (std::size_t j = 0; j < this->m_variables; ++j)
+			tableau_row[j] = scaled_row[j];
+		tableau_row[this->m_columns] = scaled_row[this->m_variables];
+
+		if (ConstraintRelation::LessEqual == relations[i]) {
+			tableau_row[slack] = 1;
+			this->m_basis[i] = slack++;
+		}
+		else {
+			if (ConstraintRelation::GreaterEqual == relations[i])
+				tableau_row[slack++] = -1;
+			tableau_row[artificial] = 1;
+			this->m_basis[i] = artificial++;
+		}
+	}
+}
+
+
+/***
+*bool Tableau::phaseOne() - Finds a feasible basis
+*
+*Purpose:
+*       Maximizes minus the sum of the artificial variables. If the maximum
+*       isn't 0, no solution has all of them 0, so the program is infeasible.
+*
+*       Otherwise the artificial variables that are still basic (with a value
+*       of 0) are replaced: a row of such a variable is pivoted on a variable
+*       that isn't artificial, if it has one with a nonzero coefficient (the
+*       row is negated first if the coefficient is negative, which keeps its
+*       right-hand side 0), and else the row is a combination of the others,
+*       and is removed.
+*
+*Entry:
+*       None.
+*
+*Exit:
+*       bool - 'false' if the program is infeasible.
+*
+*Exceptions:
+*       NumericOverflowException() - If a coefficient doesn't fit in 128 bits.
+*
+*******************************************************************************/
+bool Tableau::phaseOne() {
+	std::fill(this->m_objective.begin(), this->m_objective.end(), 0);
+	for (std::size_t j = this->m_artificial; j < this->m_columns; ++j)
+		this->m_objective[j] = 1;
+	this->m_objective[this->m_columns + 1] = 1;
+
+	this->eliminateBasis();
+	this->optimize(this->m_columns);
+
+	if (0 != this->m_objective[this->m_columns])
+		return false;
+
+	for (std::size_t i = 0; i < this->m_basis.size();) {
+		if (this->m_basis[i] < this->m_artificial) {
+			++i;
+			continue;
+		}
+
+		int128* current = this->row(i);
+		std::size_t column = 0;
+		while (column < this->m_artificial && 0 == current[column])
+			++column;
+
+		if (column == this->m_artificial) {
+			this->m_rows.erase(this->m_rows.begin() + i * this->width(), this->m_rows.begin() + (i + 1) * this->width());
+			this->m_basis.erase(this->m_basis.begin() + i);
+			continue;
+		}
+
+		if (current[column] < 0) {
+			for (std::size_t j = 0; j < this->width(); ++j)
+				current[j] = -current[j];
+		}
+		this->pivot(i, column);
+		++i;
+	}
+
+	return true;
+}
+
+
+/***
+*bool Tableau::phaseTwo() - Maximizes the objective of the program
+*
+*Purpose:
+*       The objective row is set to the objective of 'program' (multiplied by
+*       the lcm of its denominators), the basic variables are eliminated from
+*       it, and it's optimized with the artificial variables (which are all
+*       nonbasic and 0) kept out of the basis.
+*
+*Entry:
+*       const LinearProgram& program - The program of the tableau.
+*
+*Exit:
+*       bool - 'false' if the objective is unbounded.
+*
+*Exceptions:
+*       NumericOverflowException() - If a coefficient doesn't fit in 128 bits.
+*
+*******************************************************************************/
+bool Tableau::phaseTwo(const LinearProgram& program) {
+	int128 multiple = 1;
+	for (std::size_t j = 0; j < this->m_variables; ++j)
+		multiple = lcm(multiple, program.objective[j].getDenominator());
+
+	std::fill(this->m_objective.begin(), this->m_objective.end(), 0);
+	for (std::size_t j = 0; j < this->m_variables; ++j) {
+		this->m_objective[j] = WideArithmetics::multiply(-(int128)program.objective[j].getNumerator(),
+			multiple / program.objective[j].getDenominator());
+	}
+	this->m_objective[this->m_columns + 1] = multiple;
+
+	this->eliminateBasis();
+	return this->optimize(this->m_artificial);
+}
+
+
+//The values of the variables of the program that are basic are the
+//right-hand sides of their rows divided by the denominators, and the others
+//are 0.
+void Tableau::fillResult(SimplexResult& result) const {
+	result.value = WideFraction::reduced(this->m_objective[this->m_columns], this->m_objective[this->m_columns + 1]);
+	result.solution.assign(this->m_variables, WideFraction{ 0, 1 });
+
+	for (std::size_t i = 0; i < this->m_basis.size(); ++i) {
+		if (this->m_basis[i] < this->m_variables) {
+			const int128* current = &this->m_rows[i * this->width()];
+			result.solution[this->m_basis[i]] = WideFraction::reduced(current[this->m_columns],
+				current[this->m_basis[i]]);
+		}
+	}
+}
+
+
+//The objective row becomes denominator*objective-coefficient*row for every
+//row whose basic variable has a nonzero coefficient in it.
+void Tableau::eliminateBasis() {
+	for (std::size_t i = 0; i < this->m_basis.size(); ++i) {
+		int128 coefficient = this->m_objective[this->m_basis[i]];
+		if (0 == coefficient)
+			continue;
+
+		const int128* current = this->row(i);
+		int128 denominator = current[this->m_basis[i]];
+		this->combine(this->m_objective.data(), this->width(), denominator, coefficient, current);
+		this->m_objective[this->m_columns + 1] = WideArithmetics::multiply(this->m_objective[this->m_columns + 1],
+			denominator);
+		reduceRow(this->m_objective.data(), this->m_objective.size());
+	}
+}
+
+
+/***
+*bool Tableau::optimize() - Makes the objective optimal
+*
+*Purpose:
+*       Pivots until no variable improves the objective. The rows all share
+*       the objective's denominator, so comparisons don't need any division:
+*
+*       The entering variable is, by Dantzig's rule, the one with the most
+*       negative coefficient in the objective row. If none is negative, the
+*       basis is optimal.
+*
+*       The leaving row is the one whose basic variable reaches 0 first as
+*       the entering one grows - the smallest right-hand side divided by the
+*       coefficient, over the rows where the coefficient is positive (compared
+*       by cross-multiplying). If there's none, the objective is unbounded.
+*       Ties are broken by the smallest coefficient, since it's the pivot,
+*       which every other row with a nonzero coefficient is multiplied by.
+*
+*       A pivot whose row has a right-hand side of 0 is degenerate - it
+*       changes the basis but not the solution, and Dantzig's rule might
+*       return to an earlier basis. So after DEGENERATE_PIVOTS of them in a
+*       row, both choices follow Bland's rule (the first variable with a
+*       negative coefficient, and among the tied rows the one with the first
+*       basic variable), which can't cycle, until a pivot improves the
+*       objective again.
+*
+*Entry:
+*       std::size_t columns - The variables before this one may enter the
+*                             basis.
+*
+*Exit:
+*       bool - 'false' if the objective is unbounded.
+*
+*Exceptions:
+*       NumericOverflowException() - If a coefficient doesn't fit in 128 bits.
+*
+*******************************************************************************/
+bool Tableau::optimize(std::size_t columns) {
+	unsigned degenerate = 0;
+
+	while (true) {
+		bool bland = degenerate >= DEGENERATE_PIVOTS;
+
+		std::size_t column = columns;
+		for (std::size_t j = 0; j < columns; ++j) {
+			if (this->m_objective[j] < 0 && (column == columns || this->m_objective[j] < this->m_objective[column])) {
+				column = j;
+				if (bland)
+					break;
+			}
+		}
+		if (column == columns)
+			return true;
+
+		std::size_t pivot_row = this->m_basis.size();
+		for (std::size_t i = 0; i < this->m_basis.size(); ++i) {
+			const int128* current = this->row(i);
+			if (current[column] <= 0)
+				continue;
+
+			if (pivot_row == this->m_basis.size()) {
+				pivot_row = i;
+				continue;
+			}
+
+			const int128* best = this->row(pivot_row);
+			int128 lhs = WideArithmetics::multiply(current[this->m_columns], best[column]);
+			int128 rhs = WideArithmetics::multiply(best[this->m_columns], current[column]);
+			if (lhs < rhs || (lhs == rhs && (bland ? this->m_basis[i] < this->m_basis[pivot_row] :
+				current[column] < best[column])))
+			{
+				pivot_row = i;
+			}
+		}
+		if (pivot_row == this->m_basis.size())
+			return false;
+
+		degenerate = (0 == this->row(pivot_row)[this->m_columns]) ? degenerate + 1 : 0;
+		this->pivot(pivot_row, column);
+	}
+}
+
+
+/***
+*void Tableau::pivot() - Makes a variable basic in a row
+*
+*Purpose:
+*       The pivot row keeps its coefficients, and its coefficient of the new
+*       basic variable becomes its denominator. Every other row with a nonzero
+*       coefficient c of the variable (the objective row included) becomes
+*       pivot*row-c*pivot_row, which zeroes it - and its basic variable's
+*       coefficient (its denominator) is multiplied by the pivot, since it's 0
+*       in the pivot row. The rows with a coefficient of 0 don't change.
+*
+*       The changed rows are divided by the gcd of their coefficients once
+*       they grow too large.
+*
+*Entry:
+*       std::size_t pivot_row - The row.
+*       std::size_t    column - The variable.
+*
+*Exit:
+*       None.
+*
+*Exceptions:
+*       NumericOverflowException() - If a coefficient doesn't fit in 128 bits.
+*
+*******************************************************************************/
+void Tableau::pivot(std::size_t pivot_row, std::size_t column) {
+	const int128* source = this->row(pivot_row);
+	int128 pivot = source[column];
+
+	for (std::size_t i = 0; i < this->m_basis.size(); ++i) {
+		int128* current = this->row(i);
+		if (i == pivot_row || 0 == current[column])
+			continue;
+
+		this->combine(current, this->width(), pivot, current[column], source);
+		reduceRow(current, this->width());
+	}
+
+	this->combine(this->m_objective.data(), this->width(), pivot, this->m_objective[column], source);
+	this->m_objective[this->m_columns + 1] = WideArithmetics::multiply(this->m_objective[this->m_columns + 1], pivot);
+	reduceRow(this->m_objective.data(), this->m_objective.size());
+
+	this->m_basis[pivot_row] = column;
+}
+
+
+//The factor is read before the loop, since it's one of the target's values.
+void Tableau::combine(int128* target, std::size_t count, int128 pivot, int128 factor, const int128* source) {
+	for (std::size_t j = 0; j < count; ++j)
+		target[j] = WideArithmetics::add(WideArithmetics::multiply(pivot, target[j]),
+			WideArithmetics::multiply(-factor, source[j]));
+}
+
+
+//An overflow of the tableau isn't an error of the program, so it's reported
+//in the status.
+SimplexResult SimplexSolver::solve(const LinearProgram& program) const {
+	std::size_t rows = program.constraints.size();
+	if (program.relations.size() != rows || program.bounds.size() != rows)
+		throw std::invalid_argument("SimplexSolver::solve(): The constraints, relations and bounds don't have the same size");
+	for (std::size_t i = 0; i < rows; ++i) {
+		if (program.constraints[i].size() != program.objective.size())
+			throw std::invalid_argument("SimplexSolver::solve(): A constraint doesn't have a coefficient for every variable");
+	}
+
+	SimplexResult result = { SimplexStatus::Optimal, WideFraction{ 0, 1 }, std::vector<WideFraction>() };
+	try {
+		Tableau tableau(program);
+		if (!tableau.phaseOne())
+			result.status = SimplexStatus::Infeasible;
+		else if (!tableau.phaseTwo(program))
+			result.status = SimplexStatus::Unbounded;
+		else
+			tableau.fillResult(result);
+	}
+	catch (NumericOverflowException&) {
+		result.status = SimplexStatus::NeedsWiderArithmetic;
+		result.solution.clear();
+	}
+
+	return result;
+}
+
+
+//Every program is a task of its own.
+std::vector<SimplexResult> SimplexSolver::solveAll(const std::vector<LinearProgram>& programs) const {
+	std::vector<SimplexResult> results(programs.size());
+
+	Parallel::forEach(programs.size(), this->m_threads, [&](std::size_t i) {
+		results[i] = this->solve(programs[i]);
+	});
+
+	return results;
+}
+
+} //namespace fraction {
@@ -0,0 +1,127 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the SimplexSolver class
+*/
+
+
+#ifndef SIMPLEXSOLVER_HPP_
+#define SIMPLEXSOLVER_HPP_
+
+#include "Fraction.hpp"
+#include "WideFraction.hpp"
+#include <vector>
+
+
+namespace fraction {
+
+
+//The relation of a constraint of a LinearProgram.
+enum class ConstraintRelation {
+	LessEqual,    //row * x <= bound
+	Equal,        //row * x == bound
+	GreaterEqual  //row * x >= bound
+};
+
+
+/*
+A linear program: maximize objective * x subject to
+constraints[i] * x (relations[i]) bounds[i] for every i, and x >= 0.
+*/
+struct LinearProgram {
+	std::vector<Fraction> objective;
+	std::vector<std::vector<Fraction> > constraints;
+	std::vector<ConstraintRelation> relations;
+	std::vector<Fraction> bounds;
+};
+
+
+//How solving a LinearProgram ended.
+enum class SimplexStatus {
+	Optimal,              //An optimal solution was found
+	Infeasible,           //No x satisfies the constraints
+	Unbounded,            //The objective is unbounded from above
+	NeedsWiderArithmetic  //A coefficient of the tableau outgrew 128 bits
+};
+
+
+//The result of solving a LinearProgram. The value and the solution are set
+//only when the status is SimplexStatus::Optimal.
+struct SimplexResult {
+	SimplexStatus status;
+	WideFraction value;
+	std::vector<WideFraction> solution;
+};
+
+
+/*
+This class solves small linear programs exactly, with the two-phase simplex
+method (the first phase finds a feasible basis, with artificial variables for
+the equality and >= constraints).
+
+The tableau is kept fraction-free: every row is an equation with integer
+(128-bit) coefficients, whose coefficient of its basic variable is the shared
+denominator of the row - so a pivot updates a row with two multiplications
+and a subtraction per entry, with no gcd, where Fraction's operators would
+reduce every entry twice. Each row is divided by the gcd of its coefficients
+only once they grow past 60 bits, so the rows stay as small as their values
+allow.
+
+The pivots are chosen by Dantzig's rule (the most improving column), with the
+rows that tie in the ratio test broken by the smallest pivot - which is the
+factor every other row is multiplied by, so it limits the growth of the
+coefficients. After a few degenerate pivots in a row (which don't improve the
+objective) the solver switches to Bland's rule (the first improving column,
+and the tied row with the first basic variable), which can't cycle, until the
+objective improves again.
+
+If a coefficient doesn't fit in 128 bits (with the rows reduced), the result
+has the status SimplexStatus::NeedsWiderArithmetic, so the program can be
+solved with big integers instead.
+
+Many independent programs are solved in parallel with solveAll(), on 'threads'
+threads.
+*/
+class SimplexSolver
+{
+public:
+	//-- constructors/destructor --//
+
+	/*
+	The constructor.
+	'threads' is the number of threads used by solveAll() (0 means the number
+	of hardware threads).
+	*/
+	explicit SimplexSolver(unsigned threads = 0) :
+		m_threads(threads)
+	{
+	}
+
+
+	//-- public methods --//
+
+	/*
+	Solves 'program'.
+	If its constraints, relations and bounds don't have the same number of
+	elements, or a constraint doesn't have a coefficient for every variable of
+	the objective, it throws std::invalid_argument.
+	*/
+	SimplexResult solve(const LinearProgram& program) const;
+
+	//Solves every program of 'programs' (in parallel), and returns the results
+	//in the same order. It throws like solve().
+	std::vector<SimplexResult> solveAll(const std::vector<LinearProgram>& programs) const;
+
+private:
+	//-- private data members --//
+
+	//The number of threads (0 means the number of hardware threads)
+	unsigned m_threads;
+
+}; //class SimplexSolver {
+
+} //namespace fraction {
+
+#endif
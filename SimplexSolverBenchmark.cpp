@@ -0,0 +1,172 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of SimplexSolver against a textbook simplex
+* over Fractions.
+*
+* It solves many random small programs (maximize objective * x subject to <=
+* constraints with non-negative bounds, so x = 0 is feasible) with
+* SimplexSolver on a single thread and with solveAll() on all the hardware
+* threads, and with a dense tableau of Fractions (with the overflow protection,
+* pivoted by Dantzig's rule), checks that the optimal values are the same, and
+* prints the time per program of each, and how many programs overflowed.
+*/
+
+#include "Benchmark.hpp"
+#include "SimplexSolver.hpp"
+#include "NumericException.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdlib> //for std::exit
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+//The number of programs.
+static const std::size_t PROGRAMS = 1 << 14;
+
+//The number of variables and constraints of a program.
+static const std::size_t VARIABLES = 6;
+static const std::size_t CONSTRAINTS = 6;
+
+
+/*
+Solves 'program' (whose constraints are all <= with non-negative bounds) with a
+dense tableau of Fractions, by Dantzig's rule with ties broken by Bland's rule.
+Returns 'false' if it's unbounded, and else sets 'value' to the optimum.
+*/
+static bool fractionSimplex(const fraction::LinearProgram& program, fraction::Fraction& value) {
+	std::size_t rows = program.constraints.size(), width = VARIABLES + rows + 1;
+	std::vector<std::vector<fraction::Fraction> > tableau(rows + 1,
+		std::vector<fraction::Fraction>(width, fraction::Fraction(0, 1, true)));
+	std::vector<std::size_t> basis(rows);
+
+	for (std::size_t i = 0; i < rows; ++i) {
+		for (std::size_t j = 0; j < VARIABLES; ++j)
+			tableau[i][j] = program.constraints[i][j];
+		tableau[i][VARIABLES + i] = fraction::Fraction(1, 1, true);
+		tableau[i][width - 1] = program.bounds[i];
+		basis[i] = VARIABLES + i;
+	}
+	for (std::size_t j = 0; j < VARIABLES; ++j)
+		tableau[rows][j] = fraction::Fraction(0, 1, true) - program.objective[j];
+
+	while (true) {
+		std::size_t column = width - 1;
+		for (std::size_t j = 0; j + 1 < width; ++j) {
+			if (tableau[rows][j] < fraction::Fraction(0, 1) && (column == width - 1 || tableau[rows][j] < tableau[rows][column]))
+				column = j;
+		}
+		if (column == width - 1) {
+			value = tableau[rows][width - 1];
+			return true;
+		}
+
+		std::size_t pivot_row = rows;
+		fraction::Fraction best_ratio(0, 1, true);
+		for (std::size_t i = 0; i < rows; ++i) {
+			if (!(fraction::Fraction(0, 1) < tableau[i][column]))
+				continue;
+			fraction::Fraction ratio = tableau[i][width - 1] / tableau[i][column];
+			if (pivot_row == rows || ratio < best_ratio || (ratio == best_ratio && basis[i] < basis[pivot_row])) {
+				pivot_row = i;
+				best_ratio = ratio;
+			}
+		}
+		if (pivot_row == rows)
+			return false;
+
+		fraction::Fraction pivot = tableau[pivot_row][column];
+		for (std::size_t j = 0; j < width; ++j)
+			tableau[pivot_row][j] /= pivot;
+		for (std::size_t i = 0; i <= rows; ++i) {
+			fraction::Fraction factor = tableau[i][column];
+			if (i == pivot_row || factor == fraction::Fraction(0, 1))
+				continue;
+			for (std::size_t j = 0; j < width; ++j)
+				tableau[i][j] -= factor * tableau[pivot_row][j];
+		}
+		basis[pivot_row] = column;
+	}
+}
+
+
+int main() {
+	std::mt19937 generator(2024);
+	std::uniform_int_distribution<int> coefficient_distribution(-50, 50);
+	std::uniform_int_distribution<int> bound_distribution(0, 1000);
+	std::uniform_int_distribution<int> denominator_distribution(1, 12);
+
+	std::vector<fraction::LinearProgram> programs(PROGRAMS);
+	for (std::size_t p = 0; p < PROGRAMS; ++p) {
+		fraction::LinearProgram& program = programs[p];
+		for (std::size_t j = 0; j < VARIABLES; ++j) {
+			program.objective.push_back(fraction::Fraction(coefficient_distribution(generator),
+				denominator_distribution(generator), true));
+		}
+		for (std::size_t i = 0; i < CONSTRAINTS; ++i) {
+			std::vector<fraction::Fraction> constraint;
+			for (std::size_t j = 0; j < VARIABLES; ++j) {
+				constraint.push_back(fraction::Fraction(coefficient_distribution(generator),
+					denominator_distribution(generator), true));
+			}
+			program.constraints.push_back(constraint);
+			program.relations.push_back(fraction::ConstraintRelation::LessEqual);
+			program.bounds.push_back(fraction::Fraction(bound_distribution(generator), denominator_distribution(generator),
+				true));
+		}
+	}
+
+	fraction::SimplexSolver solver(1);
+	std::vector<fraction::SimplexResult> results(PROGRAMS);
+	double solver_time = Benchmark::measure(PROGRAMS, [&]() {
+		for (std::size_t p = 0; p < PROGRAMS; ++p)
+			results[p] = solver.solve(programs[p]);
+	});
+
+	std::vector<fraction::SimplexResult> parallel_results;
+	double parallel_time = Benchmark::measure(PROGRAMS, [&]() {
+		parallel_results = fraction::SimplexSolver().solveAll(programs);
+	});
+
+	std::size_t wider = 0, overflows = 0;
+	double fraction_time = Benchmark::measure(PROGRAMS, [&]() {
+		for (std::size_t p = 0; p < PROGRAMS; ++p) {
+			if (fraction::SimplexStatus::NeedsWiderArithmetic == results[p].status) {
+				++wider;
+				continue;
+			}
+
+			try {
+				fraction::Fraction value(0, 1, true);
+				bool bounded = fractionSimplex(programs[p], value);
+				if (bounded != (fraction::SimplexStatus::Optimal == results[p].status) ||
+					(bounded && !(results[p].value.fitsFraction() && results[p].value.toFraction() == value)))
+				{
+					std::cout << "results differ!" << std::endl;
+					std::exit(1);
+				}
+			}
+			catch (NumericException&) {
+				++overflows;
+			}
+		}
+	});
+
+	for (std::size_t p = 0; p < PROGRAMS; ++p) {
+		if (!(parallel_results[p].status == results[p].status && parallel_results[p].value == results[p].value)) {
+			std::cout << "parallel results differ!" << std::endl;
+			std::exit(1);
+		}
+	}
+
+	std::cout << "SimplexSolver " << solver_time << " ns/program (" << wider << " of " << PROGRAMS
+		<< " needed wider arithmetic)" << std::endl;
+	std::cout << "SimplexSolver::solveAll() " << parallel_time << " ns/program" << std::endl;
+	std::cout << "Fraction tableau " << fraction_time << " ns/program (" << overflows << " of "
+		<< PROGRAMS - wider << " overflowed)" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement the SmallValueTables namespace and the GcdTable
+* class.
+*/
+
+#ifndef SMALLVALUETABLES_CPP_
+#define SMALLVALUETABLES_CPP_
+
+#include "SmallValueTables.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint8_t, std::uint64_t
+
+
+/***
+*SmallValueTables::GcdTable::GcdTable() - The constructor
+*
+*Purpose:
+*       Builds the gcd table and the reciprocal table.
+*
+*       The gcd table is filled row by row, and every row from left to right,
+*       so every entry is computed from an entry that's already filled:
+*           gcd(a,0) = a, gcd(0,b) = b
+*           gcd(a,b) = gcd(b, a mod b) if b < a  (row 'b' is before row 'a')
+*           gcd(a,b) = gcd(a, b mod a) if a <= b (column 'b mod a' is before 'b')
+*
+*       The multiplier of 'g' is floor(2^32/g) + 1. For every 'x' divisible by
+*       'g' and less than 2^32:
+*           x*m / 2^32 = x/g + x*e/2^32, where 0 < e <= 1
+*       and x*e/2^32 < 1, so (x*m) >> 32 is exactly x/g.
+*
+*Entry:
+*       int boundBits - The number of bits of the bound (clamped to [1, 8]).
+*
+*Exit:
+*
+*Exceptions:
+*
+*******************************************************************************/
+FRACTION_INLINE SmallValueTables::GcdTable::GcdTable(int boundBits) :
+	m_bound_bits(boundBits < 1 ? 1 : (boundBits > 8 ? 8 : boundBits))
+{
+	std::size_t bound = (std::size_t)1 << this->m_bound_bits;
+
+	this->m_gcd.resize(bound * bound);
+	for (std::size_t a = 0; a < bound; ++a) {
+		for (std::size_t b = 0; b < bound; ++b) {
+			std::uint8_t gcd;
+			if (0 == b)
+				gcd = (std::uint8_t)a;
+			else if (0 == a)
+				gcd = (std::uint8_t)b;
+			else if (b < a)
+				gcd = this->m_gcd[(b << this->m_bound_bits) | (a % b)];
+			else
+				gcd = this->m_gcd[(a << this->m_bound_bits) | (b % a)];
+			this->m_gcd[(a << this->m_bound_bits) | b] = gcd;
+		}
+	}
+
+	this->m_reciprocal.resize(bound);
+	this->m_reciprocal[0] = 0;
+	for (std::size_t g = 1; g < bound; ++g)
+		this->m_reciprocal[g] = (((std::uint64_t)1 << 32) / g) + 1;
+}
+
+
+//The gcd table holds a byte per pair, and the reciprocal table 8 bytes per
+//value.
+FRACTION_INLINE std::size_t SmallValueTables::GcdTable::sizeInBytes() const {
+	return this->m_gcd.size() * sizeof(std::uint8_t) +
+		this->m_reciprocal.size() * sizeof(std::uint64_t);
+}
+
+
+//A function-local static, so it's built on first use (and in a thread-safe
+//way), even if a Fraction is created during static initialization.
+FRACTION_INLINE const SmallValueTables::GcdTable& SmallValueTables::defaultTable() {
+	static const GcdTable table(FRACTION_SMALL_VALUE_BITS);
+	return table;
+}
+
+
+//Reduces with the default table.
+FRACTION_INLINE bool SmallValueTables::reduce(int& numerator, int& denominator) {
+	return defaultTable().reduce(numerator, denominator);
+}
+
+#endif
@@ -0,0 +1,148 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the SmallValueTables namespace and
+* the GcdTable class
+*/
+
+#ifndef SMALLVALUETABLES_HPP_
+#define SMALLVALUETABLES_HPP_
+
+#include "HeaderOnly.hpp"
+#include <cstddef> //for std::size_t
+#include <cstdint> //for std::uint8_t, std::uint64_t
+#include <vector>
+
+
+/*
+The default number of bits of the operands handled by the table of
+SmallValueTables::reduce() - i.e. it handles numerators and denominators whose
+absolute values are less than 2^FRACTION_SMALL_VALUE_BITS.
+
+The table takes 4^bits bytes, plus 8 bytes per value for the multipliers -
+17KB for the default of 7 bits, which fits in the L1 cache next to the data of
+the caller. The bound is at most 8 bits (66KB): a larger table spills out of
+L1 and takes a large part of L2 from the caller, and its lookups miss - with a
+working set of half the L2, a reduction went from about 8ns at 8 bits to 19ns
+at 10 bits and 35ns at 11 bits (Euclid takes 40-50ns on such operands). Run
+'make bench_small_tables' to see the numbers of a given machine.
+*/
+#ifndef FRACTION_SMALL_VALUE_BITS
+#define FRACTION_SMALL_VALUE_BITS 7
+#endif
+
+
+/*
+This namespace holds precomputed tables that replace the Euclidean algorithm
+for small operands.
+
+If FRACTION_SMALL_VALUE_TABLES is defined, Fraction::reduce() and
+Fraction::operator< first try these tables, and fall back to the general code
+only for operands past the bound.
+*/
+namespace SmallValueTables {
+
+	/*
+	This class holds the gcd of every pair of numbers below a bound of 2^bits,
+	and for every such gcd 'g', a multiplier 'm' such that x/g == (x*m) >> 32
+	for every 'x' divisible by 'g' - so reducing a fraction is two table
+	lookups and two multiplications, without any division.
+	*/
+	class GcdTable
+	{
+	public:
+		//-- constructors/destructor --//
+
+		/*
+		The constructor.
+
+		Builds the tables for operands less than 2^boundBits.
+		'boundBits' is clamped to [1, 8], so every gcd fits in a byte (and an
+		8 bits table is 64KB).
+		*/
+		explicit GcdTable(int boundBits);
+
+
+		//-- public methods --//
+
+		/*
+		If both |numerator| and |denominator| are below the bound, divides them
+		by their gcd and returns 'true'.
+		Else, it doesn't change them and returns 'false'.
+		*/
+		bool reduce(int& numerator, int& denominator) const {
+			unsigned abs_numerator = (numerator < 0) ? 0u - (unsigned)numerator : (unsigned)numerator;
+			unsigned abs_denominator = (denominator < 0) ? 0u - (unsigned)denominator : (unsigned)denominator;
+
+			//A single test for both operands.
+			if (0 != ((abs_numerator | abs_denominator) >> this->m_bound_bits))
+				return false;
+
+			unsigned gcd = this->m_gcd[(abs_numerator << this->m_bound_bits) | abs_denominator];
+			std::uint64_t reciprocal = this->m_reciprocal[gcd];
+
+			int reduced_numerator = (int)((abs_numerator * reciprocal) >> 32);
+			int reduced_denominator = (int)((abs_denominator * reciprocal) >> 32);
+
+			numerator = (numerator < 0) ? -reduced_numerator : reduced_numerator;
+			denominator = (denominator < 0) ? -reduced_denominator : reduced_denominator;
+			return true;
+		}
+
+		/*
+		Returns 'true' if the fractions num1/den1 and num2/den2 (with positive
+		denominators) are small enough to be compared by cross-multiplying in
+		an 'int'.
+
+		Adding the bound to the numerators (as unsigned) maps [-bound, bound)
+		to [0, 2*bound) and everything else to large values, so a single test
+		of the OR of the four values checks all of them.
+		*/
+		bool inBound(int num1, int den1, int num2, int den2) const {
+			unsigned bound = 1u << this->m_bound_bits;
+			unsigned all = ((unsigned)num1 + bound) | ((unsigned)num2 + bound) |
+				(unsigned)den1 | (unsigned)den2;
+			return 0 == (all >> (this->m_bound_bits + 1));
+		}
+
+		//Getter for the number of bits of the bound
+		int getBoundBits() const {
+			return this->m_bound_bits;
+		}
+
+		//Returns the memory used by the tables, in bytes.
+		std::size_t sizeInBytes() const;
+
+	private:
+		//-- private data members --//
+
+		//The operands must be less than 2^m_bound_bits
+		int m_bound_bits;
+
+		//gcd(a,b) is at index (a << m_bound_bits) | b
+		std::vector<std::uint8_t> m_gcd;
+
+		//The multiplier that divides by 'g' is at index 'g'.
+		//The multiplier of 0 is 0 (so 0/0 stays 0/0).
+		std::vector<std::uint64_t> m_reciprocal;
+	};
+
+
+	//Returns the table used by Fraction, with a bound of
+	//2^FRACTION_SMALL_VALUE_BITS. It's built on the first call.
+	const GcdTable& defaultTable();
+
+	/*
+	Reduces numerator/denominator with the default table and returns 'true', or
+	returns 'false' (and doesn't change them) if they are past its bound.
+	*/
+	bool reduce(int& numerator, int& denominator);
+}
+
+#ifdef FRACTION_HEADER_ONLY
+#include "SmallValueTables.cpp"
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have a benchmark of SmallValueTables::GcdTable against the
+* Euclidean algorithm, for tables of different sizes.
+*
+* For every table size, it reduces the same random fractions (with operands
+* below the bound of the table) with the table and with Utilities::gcd(), and
+* prints the time per reduction, so the break-even point can be compared with
+* the L1 and L2 cache sizes it prints first.
+*
+* On their own, the reductions have the whole cache to themselves, so the
+* table wins at every size. The "loaded" columns read a cache line of a
+* working set of half the L2 cache with every reduction (as a caller that
+* reduces while it streams its own data does), which evicts the lines of a
+* large table - that's where the break-even point shows.
+*/
+
+#include "Benchmark.hpp"
+#include "SmallValueTables.hpp"
+#include "Utilities.hpp"
+#include <cstddef> //for std::size_t
+#include <iostream>
+#include <random>
+#include <vector>
+#include <unistd.h> //for sysconf()
+
+
+//The number of fractions reduced in every pass, and the number of passes.
+static const std::size_t FRACTIONS = 1 << 20;
+static const int PASSES = 8;
+
+
+//The number of 'int's in a cache line, and the number of lines the working
+//set advances by between two reductions (odd, so every line is visited).
+static const std::size_t LINE_INTS = 64 / sizeof(int);
+static const std::size_t LINE_STRIDE = 37;
+
+
+//Returns the time in nanoseconds per fraction of reducing all the fractions
+//with 'reduce', and adds the results to 'checksum' so they aren't optimized
+//away.
+//If 'workingSet' (whose size is a power of 2) isn't empty, a cache line of it
+//is read with every reduction.
+template <typename Reduce>
+static double timeReductions(const std::vector<int>& numerators, const std::vector<int>& denominators,
+	const std::vector<int>& workingSet, Reduce reduce, long long& checksum)
+{
+	std::size_t mask = workingSet.size() - 1;
+	std::size_t position = 0;
+
+	return Benchmark::measure(PASSES * numerators.size(), [&]() {
+		for (int pass = 0; pass < PASSES; ++pass) {
+			for (std::size_t i = 0; i < numerators.size(); ++i) {
+				int numerator = numerators[i];
+				int denominator = denominators[i];
+				reduce(numerator, denominator);
+				checksum += numerator + denominator;
+
+				if (!workingSet.empty()) {
+					checksum += workingSet[position];
+					position = (position + LINE_STRIDE * LINE_INTS) & mask;
+				}
+			}
+		}
+	});
+}
+
+
+int main() {
+	long l2_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	std::cout << "L1d cache: " << sysconf(_SC_LEVEL1_DCACHE_SIZE) / 1024 << " KB, "
+		<< "L2 cache: " << l2_size / 1024 << " KB" << std::endl;
+	std::cout << "bits\ttable KB\ttable ns\teuclid ns\ttable ns (loaded)\teuclid ns (loaded)" << std::endl;
+
+	//Half the L2 cache (1MB if it's unknown), rounded down to a power of 2.
+	std::size_t working_set_size = 1;
+	std::size_t working_set_bytes = (l2_size > 0) ? (std::size_t)l2_size / 2 : 1 << 20;
+	while (working_set_size * 2 * sizeof(int) <= working_set_bytes)
+		working_set_size *= 2;
+	std::vector<int> working_set(working_set_size, 1), no_working_set;
+
+	std::mt19937 generator(2024);
+	long long checksum = 0;
+
+	for (int bits = 4; bits <= 8; ++bits) {
+		SmallValueTables::GcdTable table(bits);
+
+		std::uniform_int_distribution<int> distribution(1, (1 << bits) - 1);
+		std::vector<int> numerators(FRACTIONS), denominators(FRACTIONS);
+		for (std::size_t i = 0; i < FRACTIONS; ++i) {
+			numerators[i] = distribution(generator);
+			denominators[i] = distribution(generator);
+		}
+
+		auto table_reduce = [&table](int& numerator, int& denominator) {
+			table.reduce(numerator, denominator);
+		};
+		auto euclid_reduce = [](int& numerator, int& denominator) {
+			int gcd = Utilities::gcd(numerator, denominator);
+			numerator /= gcd;
+			denominator /= gcd;
+		};
+
+		double table_ns = timeReductions(numerators, denominators, no_working_set, table_reduce, checksum);
+		double euclid_ns = timeReductions(numerators, denominators, no_working_set, euclid_reduce, checksum);
+		double loaded_table_ns = timeReductions(numerators, denominators, working_set, table_reduce, checksum);
+		double loaded_euclid_ns = timeReductions(numerators, denominators, working_set, euclid_reduce,
+			checksum);
+
+		std::cout << bits << "\t" << table.sizeInBytes() / 1024 << "\t\t" << table_ns << "\t\t"
+			<< euclid_ns << "\t\t" << loaded_table_ns << "\t\t\t" << loaded_euclid_ns << std::endl;
+	}
+
+	std::cout << "(checksum " << checksum << ")" << std::endl;
+}
@@ -0,0 +1,141 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration and implementation of the SpscQueue
+* class
+*/
+
+
+#ifndef SPSCQUEUE_HPP_
+#define SPSCQUEUE_HPP_
+
+#include <atomic>
+#include <cstddef> //for std::size_t
+#include <vector>
+
+
+namespace fraction {
+
+
+/*
+This class represents a bounded, lock-free queue between a single producer
+thread and a single consumer thread (a ring buffer).
+
+The producer only writes the tail and the consumer only writes the head, so
+every operation is a single atomic store (with release semantics) and no
+read-modify-write. Both indices are on their own cache lines, and every side
+keeps a cached copy of the other side's index, so it only reads the other
+side's cache line when the queue looks full (or empty).
+
+The capacity is rounded up to a power of 2.
+
+The queue never blocks: tryPush() and tryPop() fail when the queue is full or
+empty, and the caller decides how to wait (see Pipeline).
+*/
+template <typename T>
+class SpscQueue
+{
+public:
+	//-- constructors/destructor --//
+
+	//Creates an empty queue of at least 'capacity' (at least 1) elements.
+	explicit SpscQueue(std::size_t capacity) :
+		m_head(0),
+		m_cached_tail(0),
+		m_tail(0),
+		m_cached_head(0)
+	{
+		std::size_t size = 1;
+		while (size < capacity)
+			size *= 2;
+
+		this->m_slots.resize(size);
+		this->m_mask = size - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator= (const SpscQueue&) = delete;
+
+
+	//-- public methods --//
+
+	/*
+	Appends 'value' to the queue, and returns 'true'.
+	If the queue is full, it returns 'false' instead.
+	Must be called only by the producer.
+	*/
+	bool tryPush(const T& value) {
+		std::size_t tail = this->m_tail.load(std::memory_order_relaxed);
+
+		if (tail - this->m_cached_head > this->m_mask) {
+			this->m_cached_head = this->m_head.load(std::memory_order_acquire);
+			if (tail - this->m_cached_head > this->m_mask)
+				return false;
+		}
+
+		this->m_slots[tail & this->m_mask] = value;
+		this->m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*
+	Removes the first element of the queue into 'value', and returns 'true'.
+	If the queue is empty, it returns 'false' instead.
+	Must be called only by the consumer.
+	*/
+	bool tryPop(T& value) {
+		std::size_t head = this->m_head.load(std::memory_order_relaxed);
+
+		if (head == this->m_cached_tail) {
+			this->m_cached_tail = this->m_tail.load(std::memory_order_acquire);
+			if (head == this->m_cached_tail)
+				return false;
+		}
+
+		value = this->m_slots[head & this->m_mask];
+		this->m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Returns the number of elements the queue can hold.
+	std::size_t capacity() const {
+		return this->m_mask + 1;
+	}
+
+private:
+	//-- private data members --//
+
+	//The size of a cache line. The members are padded (rather than aligned,
+	//since 'new' doesn't align over-aligned types before C++17) so that the
+	//indices of the two sides are never on the same cache line.
+	static const std::size_t CACHE_LINE_SIZE = 64;
+
+	//The index of the next element to pop (written by the consumer)
+	std::atomic<std::size_t> m_head;
+
+	//The last tail the consumer read
+	std::size_t m_cached_tail;
+
+	char m_head_padding[CACHE_LINE_SIZE];
+
+	//The index of the next element to push (written by the producer)
+	std::atomic<std::size_t> m_tail;
+
+	//The last head the producer read
+	std::size_t m_cached_head;
+
+	char m_tail_padding[CACHE_LINE_SIZE];
+
+	//The slots of the ring buffer
+	std::vector<T> m_slots;
+
+	//The capacity minus 1
+	std::size_t m_mask;
+
+}; //class SpscQueue {
+
+} //namespace fraction {
+
+#endif
@@ -6,6 +6,9 @@
 * In this file we implement all the functions in the Utilities namespace.
 */
 
+#ifndef UTILITIES_CPP_
+#define UTILITIES_CPP_
+
 #include "Utilities.hpp"
 #include "NumericOverflowException.hpp"
 #include <string>
@@ -59,7 +62,7 @@
 *                                    would overflow an 'int'.
 *
 *******************************************************************************/
-bool Utilities::isInteger(const std::string& str, int& number, bool check_for_overflow)
+FRACTION_INLINE bool Utilities::isInteger(const std::string& str, int& number, bool check_for_overflow)
 {
 	//makes sure that the string is not empty, and that there are no 
 	//leading white spaces in 'str'.
@@ -123,6 +126,9 @@ bool Utilities::isInteger(const std::string& str, int& number, bool check_for_ov
 *      Returns the greatest common divisor of 'a' and 'b'.
 *      Simple Euclidean algorithm.
 *
+*      A divisor of -1 returns 1 right away, since INT_MIN % -1 overflows
+*      (and traps on x86).
+*
 *Entry:
 *       int num1 - The first integer
 *       int num2 - The second integer
@@ -133,9 +139,11 @@ bool Utilities::isInteger(const std::string& str, int& number, bool check_for_ov
 *Exceptions:
 *
 *******************************************************************************/
-int Utilities::gcd(int num1, int num2) {
+FRACTION_INLINE int Utilities::gcd(int num1, int num2) {
 	if (0 == num2)
 		return num1;
+	if (-1 == num2)
+		return 1;
 	return gcd(num2, num1 % num2);
 }
 
@@ -158,10 +166,12 @@ int Utilities::gcd(int num1, int num2) {
 *Exceptions:
 *
 *******************************************************************************/
-int Utilities::sign(int num) {
+FRACTION_INLINE int Utilities::sign(int num) {
 	if (num > 0)
 		return 1;
 	else if (num < 0)
 		return -1;
 	return 0;
-}
\ No newline at end of file
+}
+
+#endif
@@ -10,6 +10,7 @@
 #ifndef UTILITIES_HPP_
 #define UTILITIES_HPP_
 
+#include "HeaderOnly.hpp"
 #include <string>
 
 
@@ -37,4 +38,8 @@ namespace Utilities {
 	int sign(int num);
 }
 
-#endif
\ No newline at end of file
+#ifdef FRACTION_HEADER_ONLY
+#include "Utilities.cpp"
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we implement all the functions in the WideArithmetics namespace.
+*/
+
+
+#include "WideArithmetics.hpp"
+#include "NumericOverflowException.hpp"
+#include <climits> //for INT_MIN, INT_MAX
+#include <cstdint> //for std::uint64_t
+#include <string>
+#include <algorithm> //for std::reverse
+
+
+/***
+*int128 WideArithmetics::add() - Returns the sum of num1 and num2, or throws
+*                                NumericOverflowException() if it would overflow.
+*
+*Purpose:
+*       The 128-bit version of SafeArithmetics::add().
+*       The check is done by the compiler's overflow builtin, which compiles
+*       to an add/adc pair followed by a single test of the overflow flag.
+*
+*Entry:
+*       int128 num1 - The left operand of the sum
+*       int128 num2 - The right operand of the sum
+*
+*Exit:
+*       Success - num1+num2.
+*
+*Exceptions:
+*       NumericOverflowException() - if the sum would overflow
+*
+*******************************************************************************/
+WideArithmetics::int128 WideArithmetics::add(int128 num1, int128 num2) {
+	int128 result;
+	if (__builtin_add_overflow(num1, num2, &result))
+		throw NumericOverflowException();
+	return result;
+}
+
+
+/***
+*int128 WideArithmetics::multiply() - Returns the multiplication of num1 and
+*                                     num2, or throws NumericOverflowException()
+*                                     if it would overflow.
+*
+*Purpose:
+*       The 128-bit version of SafeArithmetics::multiply().
+*
+*Entry:
+*       int128 num1 - The left operand of the multiplication
+*       int128 num2 - The right operand of the multiplication
+*
+*Exit:
+*       Success - num1*num2.
+*
+*Exceptions:
+*       NumericOverflowException() - if the multiplication would overflow
+*
+*******************************************************************************/
+WideArithmetics::int128 WideArithmetics::multiply(int128 num1, int128 num2) {
+	int128 result;
+	if (__builtin_mul_overflow(num1, num2, &result))
+		throw NumericOverflowException();
+	return result;
+}
+
+
+/***
+*int128 WideArithmetics::gcd() - Returns the gcd()
+*
+*Purpose:
+*      Returns the (non-negative) greatest common divisor of 'num1' and 'num2'.
+*
+*      The Euclidean algorithm runs on the absolute values.
+*      As soon as both operands fit in 64 bits, we switch to 64-bit
+*      arithmetic, since a 128-bit remainder is a library call and is much
+*      slower than the hardware division.
+*
+*Entry:
+*       int128 num1 - The first integer
+*       int128 num2 - The second integer
+*
+*Exit:
+*       int128      - The greates common divisor of 'num1' and 'num2'.
+*
+*Exceptions:
+*
+*******************************************************************************/
+WideArithmetics::int128 WideArithmetics::gcd(int128 num1, int128 num2) {
+	unsigned __int128 a = (num1 < 0) ? -(unsigned __int128)num1 : (unsigned __int128)num1;
+	unsigned __int128 b = (num2 < 0) ? -(unsigned __int128)num2 : (unsigned __int128)num2;
+
+	while ((a >> 64) != 0 || (b >> 64) != 0) {
+		if (0 == b)
+			return (int128)a;
+		unsigned __int128 r = a % b;
+		a = b;
+		b = r;
+	}
+
+	std::uint64_t a64 = (std::uint64_t)a;
+	std::uint64_t b64 = (std::uint64_t)b;
+	while (0 != b64) {
+		std::uint64_t r = a64 % b64;
+		a64 = b64;
+		b64 = r;
+	}
+	return (int128)a64;
+}
+
+
+/***
+*int WideArithmetics::bitLength() - Returns the bit length of |num|
+*
+*Purpose:
+*      Returns the number of significant bits in the absolute value of 'num'.
+*      Used by the wide types to decide when to reduce.
+*
+*Entry:
+*      int128 num  -  The integer we return its bit length.
+*
+*Exit:
+*       int        - The bit length of |num|, 0 if 'num' is 0.
+*
+*Exceptions:
+*
+*******************************************************************************/
+int WideArithmetics::bitLength(int128 num) {
+	unsigned __int128 magnitude = (num < 0) ? -(unsigned __int128)num : (unsigned __int128)num;
+	std::uint64_t high = (std::uint64_t)(magnitude >> 64);
+	std::uint64_t low = (std::uint64_t)magnitude;
+
+	if (0 != high)
+		return 128 - __builtin_clzll(high);
+	if (0 != low)
+		return 64 - __builtin_clzll(low);
+	return 0;
+}
+
+
+//Returns 'true' if 'num' is in the range [INT_MIN, INT_MAX].
+bool WideArithmetics::fitsInt(int128 num) {
+	return num >= INT_MIN && num <= INT_MAX;
+}
+
+
+//Writes the digits of |num| from the last one, and then reverses them.
+std::string WideArithmetics::toString(int128 num) {
+	unsigned __int128 magnitude = (num < 0) ? -(unsigned __int128)num : (unsigned __int128)num;
+
+	std::string result;
+	do {
+		result.push_back((char)('0' + (int)(magnitude % 10)));
+		magnitude /= 10;
+	} while (0 != magnitude);
+
+	if (num < 0)
+		result.push_back('-');
+
+	std::reverse(result.begin(), result.end());
+	return result;
+}
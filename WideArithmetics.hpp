@@ -0,0 +1,54 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the WideArithmetics namespace
+*/
+
+#ifndef WIDEARITHMETICS_HPP_
+#define WIDEARITHMETICS_HPP_
+
+#include <string>
+
+
+/*
+This namespace holds the 128-bit counterparts of the SafeArithmetics functions,
+along with a few helpers (gcd, bit length) that the wide types of the library
+(e.g. FractionAccumulator) are built on.
+
+Like SafeArithmetics, the arithmetic functions throw NumericOverflowException()
+if the result would not fit in 128 bits.
+*/
+namespace WideArithmetics {
+
+	//A signed 128-bit integer (GCC/Clang extension).
+	typedef __int128 int128;
+
+	/*
+	Returns num1+num2, or throws NumericOverflowException() if the sum would
+	overflow.
+	*/
+	int128 add(int128 num1, int128 num2);
+
+	/*
+	Returns num1*num2, or throws NumericOverflowException() if the multiplication
+	would overflow.
+	*/
+	int128 multiply(int128 num1, int128 num2);
+
+	//Returns the (non-negative) greatest common divisor of both the numbers
+	//from the input.
+	int128 gcd(int128 num1, int128 num2);
+
+	//Returns the number of significant bits in |num| (0 for 0).
+	int bitLength(int128 num);
+
+	//Returns 'true' if 'num' fits in an 'int'.
+	bool fitsInt(int128 num);
+
+	//Returns the decimal representation of 'num' (streams can't print it).
+	std::string toString(int128 num);
+}
+
+#endif
@@ -0,0 +1,134 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the implementation of the WideFraction struct
+*/
+
+
+#include "WideFraction.hpp"
+#include "DivisionByZeroException.hpp"
+#include "NumericOverflowException.hpp"
+
+
+namespace fraction {
+
+
+using WideArithmetics::int128;
+
+
+//Moves the sign to the numerator, and divides both by their gcd.
+//Note that 0 is always 0/1.
+WideFraction WideFraction::reduced(int128 numerator, int128 denominator) {
+	if (0 == denominator)
+		throw DivisionByZeroException();
+
+	WideFraction result;
+
+	if (0 == numerator) {
+		result.numerator = 0;
+		result.denominator = 1;
+		return result;
+	}
+
+	if (denominator < 0) {
+		numerator = -numerator;
+		denominator = -denominator;
+	}
+
+	int128 gcd = WideArithmetics::gcd(numerator, denominator);
+	result.numerator = numerator / gcd;
+	result.denominator = denominator / gcd;
+	return result;
+}
+
+
+//Checks that the value fits, and narrows it.
+Fraction WideFraction::toFraction(bool overflowProtection) const {
+	if (!this->fitsFraction())
+		throw NumericOverflowException();
+
+	return Fraction((int)this->numerator, (int)this->denominator, overflowProtection);
+}
+
+
+//Formats the value like Fraction's operator<<.
+std::string WideFraction::toString() const {
+	if (1 == this->denominator)
+		return WideArithmetics::toString(this->numerator);
+
+	return WideArithmetics::toString(this->numerator) + "/" + WideArithmetics::toString(this->denominator);
+}
+
+
+/***
+*WideFraction operator+() - Adds two WideFractions
+*
+*Purpose:
+*       Computes a/b + c/d like Fraction::operator+=: with g1 = gcd(b,d),
+*
+*           t = a * (d/g1) + c * (b/g1)
+*
+*       and only gcd(t, g1) can divide both t and (b/g1)*d, so with
+*       g2 = gcd(t, g1) the reduced sum is (t/g2) / ((b/g1) * (d/g2)).
+*
+*Entry:
+*       const WideFraction& lhs - a/b
+*       const WideFraction& rhs - c/d
+*
+*Exit:
+*       WideFraction - The reduced sum.
+*
+*Exceptions:
+*       NumericOverflowException() - If an intermediate doesn't fit in 128 bits.
+*
+*******************************************************************************/
+WideFraction operator+ (const WideFraction& lhs, const WideFraction& rhs) { //lhs+rhs
+	int128 gcd1 = WideArithmetics::gcd(lhs.denominator, rhs.denominator);
+	int128 lhs_denominator = lhs.denominator / gcd1;
+
+	int128 t = WideArithmetics::add(WideArithmetics::multiply(lhs.numerator, rhs.denominator / gcd1),
+		WideArithmetics::multiply(rhs.numerator, lhs_denominator));
+	if (0 == t)
+		return WideFraction::reduced(0, 1);
+
+	int128 gcd2 = WideArithmetics::gcd(t, gcd1);
+
+	WideFraction result;
+	result.numerator = t / gcd2;
+	result.denominator = WideArithmetics::multiply(lhs_denominator, rhs.denominator / gcd2);
+	return result;
+}
+
+
+//lhs + (-rhs)
+WideFraction operator- (const WideFraction& lhs, const WideFraction& rhs) { //lhs-rhs
+	WideFraction negated = rhs;
+	negated.numerator = -negated.numerator;
+	return lhs + negated;
+}
+
+
+//(a/b) * (c/d) = ((a/gcd(a,d)) * (c/gcd(c,b))) / ((b/gcd(c,b)) * (d/gcd(a,d)))
+//Both operands are reduced, so after the cross-cancellation the result is too.
+WideFraction operator* (const WideFraction& lhs, const WideFraction& rhs) { //lhs*rhs
+	if (0 == lhs.numerator || 0 == rhs.numerator)
+		return WideFraction::reduced(0, 1);
+
+	int128 gcd1 = WideArithmetics::gcd(lhs.numerator, rhs.denominator);
+	int128 gcd2 = WideArithmetics::gcd(rhs.numerator, lhs.denominator);
+
+	WideFraction result;
+	result.numerator = WideArithmetics::multiply(lhs.numerator / gcd1, rhs.numerator / gcd2);
+	result.denominator = WideArithmetics::multiply(lhs.denominator / gcd2, rhs.denominator / gcd1);
+	return result;
+}
+
+
+//Both are reduced, so they're equal iff their numerators and denominators are.
+bool operator== (const WideFraction& lhs, const WideFraction& rhs) { //lhs==rhs
+	return lhs.numerator == rhs.numerator && lhs.denominator == rhs.denominator;
+}
+
+} //namespace fraction {
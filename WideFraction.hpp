@@ -0,0 +1,67 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have the declaration of the WideFraction struct
+*/
+
+
+#ifndef WIDEFRACTION_HPP_
+#define WIDEFRACTION_HPP_
+
+#include "Fraction.hpp"
+#include "WideArithmetics.hpp"
+#include <string>
+
+
+namespace fraction {
+
+
+/*
+A rational with 128-bit numerator and denominator - the result of the bulk
+computations that may not fit in a Fraction (e.g. the mean of values with many
+different denominators, a quantile between two values, or the sum of a long
+series).
+
+It's always reduced, with a positive denominator.
+
+The arithmetic operators cross-reduce their operands (like Fraction's), and
+throw NumericOverflowException() if an intermediate doesn't fit in 128 bits.
+*/
+struct WideFraction {
+	WideArithmetics::int128 numerator;
+	WideArithmetics::int128 denominator;
+
+	/*
+	Returns numerator/denominator reduced, with a positive denominator.
+	If the denominator is 0, it throws DivisionByZeroException().
+	*/
+	static WideFraction reduced(WideArithmetics::int128 numerator, WideArithmetics::int128 denominator);
+
+	//Returns 'true' if both the numerator and denominator fit in an 'int'.
+	bool fitsFraction() const {
+		return WideArithmetics::fitsInt(this->numerator) && WideArithmetics::fitsInt(this->denominator);
+	}
+
+	/*
+	Returns the value as a Fraction with the given overflow protection.
+	If it doesn't fit (see fitsFraction()), it throws NumericOverflowException().
+	*/
+	Fraction toFraction(bool overflowProtection = false) const;
+
+	//Returns the value as "numerator/denominator" (or as an integer), like
+	//Fraction's operator<<.
+	std::string toString() const;
+};
+
+
+WideFraction operator+ (const WideFraction& lhs, const WideFraction& rhs); //lhs+rhs
+WideFraction operator- (const WideFraction& lhs, const WideFraction& rhs); //lhs-rhs
+WideFraction operator* (const WideFraction& lhs, const WideFraction& rhs); //lhs*rhs
+
+bool operator== (const WideFraction& lhs, const WideFraction& rhs); //lhs==rhs
+
+} //namespace fraction {
+
+#endif
@@ -0,0 +1,408 @@
+/**
+* Author: Lahav Schlesinger
+**/
+
+/*
+* In this file we have fractool - a command line tool that computes the exact
+* count, sum, mean, minimum and maximum of fractions in text files (or stdin),
+* one fraction per line, in a single pass.
+*
+* Usage: fractool [-j threads] [-q] [file...]
+*
+*   -j threads  Splits every file into this many byte ranges, which are read
+*               and aggregated in parallel (stdin is always read by one thread).
+*   -q          Doesn't print the throughput and memory report to stderr.
+*
+* The input is read through a fixed-size buffer per thread, and the lines are
+* parsed in place, so no memory is allocated per line.
+*/
+
+#include "Fraction.hpp"
+#include "FractionAccumulator.hpp"
+#include "FractionLoader.hpp" //for parseFraction()
+#include "NumericException.hpp"
+#include "NumericOverflowException.hpp"
+#include "Parallel.hpp"
+#include "WideArithmetics.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstddef> //for std::size_t
+#include <cstdlib> //for std::atoi
+#include <cstring> //for std::memchr, std::memmove, std::strcmp, std::strerror
+#include <iostream>
+#include <memory> //for std::unique_ptr
+#include <string>
+#include <vector>
+#include <fcntl.h> //for open()
+#include <sys/resource.h> //for getrusage()
+#include <sys/stat.h> //for fstat()
+#include <unistd.h> //for read(), pread(), close()
+
+
+//The size of the read buffer of every thread.
+static const std::size_t BUFFER_SIZE = 1 << 16;
+
+//Files smaller than this are not split between threads.
+static const off_t MIN_RANGE_SIZE = 1 << 20;
+
+
+//The aggregates of a part of the input.
+struct Statistics {
+
+	Statistics() :
+		count(0),
+		sum_overflow(false),
+		has_extremes(false),
+		min_numerator(0), min_denominator(1),
+		max_numerator(0), max_denominator(1),
+		malformed(0),
+		bytes(0)
+	{
+	}
+
+	//The number of values
+	std::size_t count;
+
+	//The sum (valid only if 'sum_overflow' is false)
+	fraction::FractionAccumulator sum;
+
+	//Whether the sum didn't fit in 128 bits
+	bool sum_overflow;
+
+	//Whether a value was seen (so the minimum and maximum are valid)
+	bool has_extremes;
+
+	//The minimum and maximum
+	int min_numerator, min_denominator;
+	int max_numerator, max_denominator;
+
+	//The number of lines that couldn't be parsed
+	std::size_t malformed;
+
+	//The number of bytes in the lines we read
+	unsigned long long bytes;
+};
+
+
+//Returns 'true' if num1/den1 < num2/den2 (the denominators are positive).
+//The cross products are computed in 'long long', so they can't overflow.
+static bool less(int num1, int den1, int num2, int den2) {
+	return (long long)num1 * den2 < (long long)num2 * den1;
+}
+
+
+//Parses the line [begin, end) (without the '\n') and adds it to 'stats'.
+static void processLine(const char* begin, const char* end, Statistics& stats) {
+	stats.bytes += (end - begin) + 1;
+
+	if (begin != end && '\r' == end[-1])
+		--end;
+
+	int numerator, denominator;
+	if (fraction::ParseStatus::Ok != fraction::parseFraction(begin, end, numerator, denominator)) {
+		++stats.malformed;
+		return;
+	}
+
+	++stats.count;
+	if (!stats.sum_overflow) {
+		try {
+			stats.sum.add(numerator, denominator);
+		}
+		catch (NumericOverflowException&) {
+			stats.sum_overflow = true;
+		}
+	}
+
+	if (!stats.has_extremes) {
+		stats.has_extremes = true;
+		stats.min_numerator = stats.max_numerator = numerator;
+		stats.min_denominator = stats.max_denominator = denominator;
+	}
+	else if (less(numerator, denominator, stats.min_numerator, stats.min_denominator)) {
+		stats.min_numerator = numerator;
+		stats.min_denominator = denominator;
+	}
+	else if (less(stats.max_numerator, stats.max_denominator, numerator, denominator)) {
+		stats.max_numerator = numerator;
+		stats.max_denominator = denominator;
+	}
+}
+
+
+//Adds the aggregates of 'other' to 'stats'.
+static void merge(Statistics& stats, const Statistics& other) {
+	stats.count += other.count;
+	stats.sum_overflow = stats.sum_overflow || other.sum_overflow;
+	if (!stats.sum_overflow) {
+		try {
+			stats.sum.merge(other.sum);
+		}
+		catch (NumericOverflowException&) {
+			stats.sum_overflow = true;
+		}
+	}
+	stats.malformed += other.malformed;
+	stats.bytes += other.bytes;
+
+	if (!other.has_extremes)
+		return;
+
+	if (!stats.has_extremes ||
+		less(other.min_numerator, other.min_denominator, stats.min_numerator, stats.min_denominator))
+	{
+		stats.min_numerator = other.min_numerator;
+		stats.min_denominator = other.min_denominator;
+	}
+	if (!stats.has_extremes ||
+		less(stats.max_numerator, stats.max_denominator, other.max_numerator, other.max_denominator))
+	{
+		stats.max_numerator = other.max_numerator;
+		stats.max_denominator = other.max_denominator;
+	}
+	stats.has_extremes = true;
+}
+
+
+/***
+*bool processRange() - Aggregates the lines of a byte range of a file
+*
+*Purpose:
+*       Reads the file through a fixed-size buffer and aggregates every line
+*       that starts in [begin, end).
+*
+*       A line that starts before 'begin' belongs to the previous range, so if
+*       'begin' is not at the beginning of a line, we skip until the next one.
+*       The last line may continue past 'end', and we read it until its end.
+*
+*       After the complete lines in the buffer are processed, the remaining
+*       part of a line is moved to the beginning of the buffer, and the buffer
+*       is filled again. A line longer than the whole buffer is counted as
+*       malformed and skipped.
+*
+*       If 'positional' is false (e.g. stdin), the file is read sequentially
+*       with read(), and 'begin' and 'end' are ignored.
+*
+*Entry:
+*       int                fd - The file.
+*       bool       positional - Whether to read with pread() from [begin, end).
+*       off_t           begin - The beginning of the range.
+*       off_t             end - The end of the range.
+*       Statistics&     stats - The aggregates of the range.
+*
+*Exit:
+*       bool - 'false' if a read failed (and errno is set).
+*
+*Exceptions:
+*
+*******************************************************************************/
+static bool processRange(int fd, bool positional, off_t begin, off_t end, Statistics& stats) {
+	std::unique_ptr<char[]> buffer(new char[BUFFER_SIZE]);
+
+	//The file offset of buffer[0], the number of bytes in the buffer, and the
+	//file offset of the next read.
+	off_t buffer_offset = begin;
+	std::size_t filled = 0;
+	off_t read_offset = begin;
+
+	bool skipping = false;
+	if (positional && begin > 0) {
+		char previous;
+		if (pread(fd, &previous, 1, begin - 1) != 1)
+			return false;
+		skipping = ('\n' != previous);
+	}
+
+	while (true) {
+		ssize_t count = positional ?
+			pread(fd, buffer.get() + filled, BUFFER_SIZE - filled, read_offset) :
+			read(fd, buffer.get() + filled, BUFFER_SIZE - filled);
+
+		if (count < 0) {
+			if (EINTR == errno)
+				continue;
+			return false;
+		}
+
+		read_offset += count;
+		filled += count;
+
+		const char* line = buffer.get();
+		const char* limit = buffer.get() + filled;
+
+		while (true) {
+			if (positional && !skipping && buffer_offset + (line - buffer.get()) >= end)
+				return true;
+
+			const char* newline = (const char*)std::memchr(line, '\n', limit - line);
+			if (!newline)
+				break;
+
+			if (skipping)
+				skipping = false;
+			else
+				processLine(line, newline, stats);
+
+			line = newline + 1;
+		}
+
+		if (0 == count) {
+			//The last line of the file doesn't end with a '\n'.
+			if (line != limit && !skipping)
+				processLine(line, limit, stats);
+			return true;
+		}
+
+		std::size_t remaining = limit - line;
+		if (remaining == BUFFER_SIZE) {
+			if (!skipping)
+				++stats.malformed;
+			skipping = true;
+			remaining = 0;
+			line = limit;
+		}
+
+		std::memmove(buffer.get(), line, remaining);
+		buffer_offset += (line - buffer.get());
+		filled = remaining;
+	}
+}
+
+
+//Aggregates a whole file, split into (at most) 'threads' ranges.
+//If the file is not a large regular file (e.g. a pipe), it's read by one
+//thread.
+//Returns 0, or the errno of the read that failed - which is the errno of the
+//thread that read it, so it's saved with its range.
+static int processFile(int fd, unsigned threads, Statistics& stats) {
+	struct stat status;
+	if (fstat(fd, &status) < 0)
+		return errno;
+
+	if (!S_ISREG(status.st_mode) || threads < 2 || status.st_size < MIN_RANGE_SIZE)
+		return processRange(fd, S_ISREG(status.st_mode), 0, status.st_size, stats) ? 0 : errno;
+
+	off_t size = status.st_size;
+	std::vector<Statistics> ranges(threads);
+	std::vector<int> errors(threads, 0);
+
+	Parallel::forEach(threads, threads, [&](std::size_t i) {
+		off_t begin = (size * (off_t)i) / threads;
+		off_t end = (size * (off_t)(i + 1)) / threads;
+		if (!processRange(fd, true, begin, end, ranges[i]))
+			errors[i] = errno;
+	});
+
+	for (unsigned i = 0; i < threads; ++i) {
+		if (0 != errors[i])
+			return errors[i];
+		merge(stats, ranges[i]);
+	}
+	return 0;
+}
+
+
+//Prints the wide fraction numerator/denominator (with a positive denominator)
+//in the same format as operator<< prints a Fraction.
+static void printWide(const char* name, WideArithmetics::int128 numerator,
+	WideArithmetics::int128 denominator)
+{
+	std::cout << name << ": " << WideArithmetics::toString(numerator);
+	if (0 != numerator && 1 != denominator)
+		std::cout << "/" << WideArithmetics::toString(denominator);
+	std::cout << std::endl;
+}
+
+
+//Prints the exact sum and mean, which don't have to fit in a Fraction - only
+//in 128 bits.
+static void printSumAndMean(Statistics& stats) {
+	if (stats.sum_overflow) {
+		std::cout << "sum: " << NumericOverflowException().what() << std::endl;
+		std::cout << "mean: " << NumericOverflowException().what() << std::endl;
+		return;
+	}
+
+	stats.sum.reduce();
+	WideArithmetics::int128 numerator = stats.sum.getNumerator();
+	WideArithmetics::int128 denominator = stats.sum.getDenominator();
+	printWide("sum", numerator, denominator);
+
+	if (0 == stats.count)
+		return;
+
+	//sum/count, reduced by gcd(numerator, count).
+	WideArithmetics::int128 count = (WideArithmetics::int128)stats.count;
+	WideArithmetics::int128 gcd = WideArithmetics::gcd(numerator, count);
+	try {
+		printWide("mean", numerator / gcd, WideArithmetics::multiply(denominator, count / gcd));
+	}
+	catch (NumericException& err) {
+		std::cout << "mean: " << err.what() << std::endl;
+	}
+}
+
+
+int main(int argc, char* argv[]) {
+	unsigned threads = 1;
+	bool quiet = false;
+	std::vector<std::string> paths;
+
+	for (int i = 1; i < argc; ++i) {
+		if (0 == std::strcmp(argv[i], "-j") && i + 1 < argc) {
+			int requested = std::atoi(argv[++i]);
+			threads = Parallel::threadCount(requested > 0 ? (unsigned)requested : 0);
+		}
+		else if (0 == std::strcmp(argv[i], "-q")) {
+			quiet = true;
+		}
+		else if ('-' == argv[i][0] && '\0' != argv[i][1]) {
+			std::cerr << "usage: " << argv[0] << " [-j threads] [-q] [file...]" << std::endl;
+			return 2;
+		}
+		else {
+			paths.push_back(argv[i]);
+		}
+	}
+	if (paths.empty())
+		paths.push_back("-");
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Statistics stats;
+
+	for (std::size_t i = 0; i < paths.size(); ++i) {
+		bool is_stdin = ("-" == paths[i]);
+		int fd = is_stdin ? STDIN_FILENO : open(paths[i].c_str(), O_RDONLY);
+
+		int error = (fd < 0) ? errno : processFile(fd, threads, stats);
+		if (0 != error) {
+			std::cerr << paths[i] << ": " << std::strerror(error) << std::endl;
+			return 1;
+		}
+		if (!is_stdin)
+			close(fd);
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "count: " << stats.count << std::endl;
+	printSumAndMean(stats);
+	if (stats.has_extremes) {
+		std::cout << "min: " << fraction::Fraction(stats.min_numerator, stats.min_denominator) << std::endl;
+		std::cout << "max: " << fraction::Fraction(stats.max_numerator, stats.max_denominator) << std::endl;
+	}
+	std::cout << "malformed: " << stats.malformed << std::endl;
+
+	if (!quiet) {
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+
+		double megabytes = stats.bytes / (1024.0 * 1024.0);
+		std::cerr << "read " << megabytes << " MB in " << elapsed.count() << " s ("
+			<< megabytes / elapsed.count() << " MB/s, "
+			<< (stats.count + stats.malformed) / elapsed.count() << " lines/s) with "
+			<< threads << " thread(s), peak memory " << usage.ru_maxrss << " KB" << std::endl;
+	}
+
+	return 0;
+}